@@ -145,6 +145,185 @@ template<class T> T fp_max(T a, T b) {
 		return fp_gte(a, b) ? a : b;
 }
 
+/**
+ * Map a float onto an integer with the same order, so that the difference
+ * of two values counts the floats between them. Negative zero is ordered
+ * before positive zero.
+ *   @a: The input, not NaN.
+ *   &returns: The ordinal.
+ */
+template<class T> int64_t fp_ord(T a) {
+	fatal("Unsupported type '%s' for `fp_ord`.", typeid(T).name());
+}
+template<> int64_t fp_ord<float>(float a) {
+	uint32_t u;
+
+	memcpy(&u, &a, 4);
+
+	return (u & 0x80000000) ? (-(int64_t)(u & 0x7FFFFFFF) - 1) : (int64_t)u;
+}
+template<> int64_t fp_ord<double>(double a) {
+	uint64_t u;
+
+	memcpy(&u, &a, 8);
+
+	return (u & 0x8000000000000000) ? (-(int64_t)(u & 0x7FFFFFFFFFFFFFFF) - 1) : (int64_t)u;
+}
+
+
+/*
+ * rounding class
+ *   Switches SSE arithmetic to round upward, with subnormals enabled, for
+ *   the lifetime of the object. The interval kernels carry an interval as
+ *   the pair `-lo, hi`, so that one upward rounding mode rounds both bounds
+ *   outward. Nested instances find the mode already set and leave it alone,
+ *   so a loop can hold one around many interval operations.
+ */
+class FpRound {
+public:
+	FpRound() { csr = _mm_getcsr(); if(csr != Up(csr)) _mm_setcsr(Up(csr)); }
+	~FpRound() { if(csr != Up(csr)) _mm_setcsr(csr); }
+
+	FpRound(FpRound const&) = delete;
+	FpRound& operator=(FpRound const&) = delete;
+
+private:
+	unsigned int csr;
+
+	static unsigned int Up(unsigned int csr) { return (csr & ~0xE040) | 0x4000; }
+};
+
+/**
+ * Pin a vector in a register, so that the arithmetic producing or using it
+ * is not moved across a change of the rounding mode.
+ *   @v: The vector.
+ */
+static inline void fp_pin(__m128 &v) { __asm__ volatile("" : "+x"(v)); }
+static inline void fp_pin(__m128d &v) { __asm__ volatile("" : "+x"(v)); }
+
+/**
+ * Replace NaN lanes with zero. Products of a zero and an infinite bound are
+ * taken as zero, their limit over the interval.
+ *   @v: The vector.
+ *   &returns: The vector without NaNs.
+ */
+static inline __m128 fp_num(__m128 v) { return _mm_andnot_ps(_mm_cmpunord_ps(v, v), v); }
+static inline __m128d fp_num(__m128d v) { return _mm_andnot_pd(_mm_cmpunord_pd(v, v), v); }
+
+/**
+ * Add two intervals, rounding outward.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_iadd(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_iadd`.", typeid(T).name());
+}
+template<> void fp_iadd<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(0.0, 0.0, ahi, -alo), r = _mm_set_ps(0.0, 0.0, bhi, -blo);
+
+	fp_pin(l);
+	__m128 res = _mm_add_ps(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_iadd<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	fp_pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Subtract two intervals, rounding outward. The lower bound is `alo - bhi`
+ * and the upper bound `ahi - blo`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_isub(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_isub`.", typeid(T).name());
+}
+template<> void fp_isub<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(0.0, 0.0, ahi, -alo), r = _mm_set_ps(0.0, 0.0, -blo, bhi);
+
+	fp_pin(l);
+	__m128 res = _mm_add_ps(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_isub<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(-blo, bhi);
+
+	fp_pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Multiply two intervals, rounding outward. The four cross products are
+ * computed with each sign, the negated ones bounding `-lo` and the others
+ * bounding `hi`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_imul(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_imul`.", typeid(T).name());
+}
+template<> void fp_imul<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(-ahi, alo, ahi, -alo), r = _mm_set_ps(-blo, bhi, bhi, -blo);
+
+	fp_pin(l);
+	__m128 up = fp_num(_mm_mul_ps(l, r));
+	__m128 dn = fp_num(_mm_mul_ps(_mm_xor_ps(l, _mm_set1_ps(-0.0)), r));
+	__m128 max = _mm_max_ps(_mm_shuffle_ps(dn, up, _MM_SHUFFLE(1, 0, 1, 0)), _mm_shuffle_ps(dn, up, _MM_SHUFFLE(3, 2, 3, 2)));
+	__m128 res = _mm_max_ps(_mm_shuffle_ps(max, max, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(max, max, _MM_SHUFFLE(3, 1, 3, 1)));
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_imul<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	fp_pin(l);
+	__m128d nl = _mm_xor_pd(l, _mm_set1_pd(-0.0)), sr = _mm_shuffle_pd(r, r, 1);
+	__m128d up = _mm_max_pd(fp_num(_mm_mul_pd(l, r)), fp_num(_mm_mul_pd(nl, sr)));
+	__m128d dn = _mm_max_pd(fp_num(_mm_mul_pd(nl, r)), fp_num(_mm_mul_pd(l, sr)));
+	__m128d res = _mm_max_pd(_mm_unpacklo_pd(dn, up), _mm_unpackhi_pd(dn, up));
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
 
 /**
  * Compute an integer of all ones.
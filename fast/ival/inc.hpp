@@ -3,6 +3,7 @@
 #include <stdarg.h>
 #include <stdlib.h>
 #include <math.h>
+#include <emmintrin.h>
 
 #include <iostream>
 
@@ -44,7 +45,7 @@ using RangeVecI32 = RangeVecInt<uint32_t>;
 /*
  * operation and king enumerators
  */
-enum class Op { Unk, Add, Sub, Mul, Div, And, Or, Xor, FtoI, ItoF, CmpOLT, CmpOGT, CmpOEQ, Select, Insert, Extract, Abs, Sqrt };
+enum class Op { Unk, Add, Sub, Mul, Div, And, Or, Xor, IAdd, ISub, Shl, LShr, Cast, FtoI, ItoF, CmpOLT, CmpOGT, CmpOEQ, Select, Insert, Extract, Abs, Sqrt, Phi, Call, Load, Store };
 enum class Kind { Unk, Int, Flt };
 
 /*
@@ -77,4 +78,6 @@ public:
 #include "fp.hpp"
 #include "ival.hpp"
 #include "range.hpp"
+#include "table.hpp"
 #include "pass.hpp"
+#include "taint.hpp"
@@ -8,6 +8,7 @@ public:
 	int lsb;
 	T lo, hi;
 
+	IvalFlt() { }
 	IvalFlt(T _lo, T _hi) { lo = _lo; hi = _hi; lsb = fp_lsb2(_lo, _hi); };
 	IvalFlt(T _lo, T _hi, int _lsb) { lo = _lo; hi = _hi; lsb = _lsb; };
 	~IvalFlt() { }
@@ -110,38 +111,45 @@ public:
 	}
 
 	/**
-	 * Add two float intervals.
+	 * Add two float intervals, rounding outward.
 	 *   @lhs: The left-hand side.
 	 *   @rhs: The right-hand side.
 	 *   &returns: The result interval.
 	 */
 	static IvalFlt<T> Add(IvalFlt<T> const& lhs, IvalFlt<T> const& rhs) {
-		return IvalFlt(lhs.lo + rhs.lo, lhs.hi + rhs.hi, std::min(lhs.lsb, rhs.lsb));
+		T lo, hi;
+
+		fp_iadd<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
+
+		return IvalFlt(lo, hi, std::min(lhs.lsb, rhs.lsb));
 	}
 
 	/**
-	 * Subtract two float intervals.
+	 * Subtract two float intervals, rounding outward.
 	 *   @lhs: The left-hand side.
 	 *   @rhs: The right-hand side.
 	 *   &returns: The result interval.
 	 */
 	static IvalFlt<T> Sub(IvalFlt<T> const& lhs, IvalFlt<T> const& rhs) {
-		return IvalFlt(lhs.lo - rhs.lo, lhs.hi - rhs.hi, std::min(lhs.lsb, rhs.lsb));
+		T lo, hi;
+
+		fp_isub<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
+
+		return IvalFlt(lo, hi, std::min(lhs.lsb, rhs.lsb));
 	}
 
 	/**
-	 * Multiply two float intervals.
+	 * Multiply two float intervals, rounding outward.
 	 *   @lhs: The left-hand side.
 	 *   @rhs: The right-hand side.
 	 *   &returns: The result interval.
 	 */
 	static IvalFlt<T> Mul(IvalFlt<T> const& lhs, IvalFlt<T> const& rhs) {
-		double a = lhs.lo * rhs.lo;
-		double b = lhs.hi * rhs.lo;
-		double c = lhs.lo * rhs.hi;
-		double d = lhs.hi * rhs.hi;
+		T lo, hi;
+
+		fp_imul<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
 
-		return IvalFlt(std::min({ a, b, c, d }), std::max({ a, b, c, d }), lhs.lsb + rhs.lsb);
+		return IvalFlt(lo, hi, lhs.lsb + rhs.lsb);
 	}
 
 
@@ -154,9 +162,119 @@ public:
 	static bool Overlap(IvalFlt<T> const &lhs, IvalFlt<T> const &rhs) {
 		return lhs.Contains(rhs.lo) || lhs.Contains(rhs.hi) || rhs.Contains(lhs.lo) || rhs.Contains(lhs.hi);
 	}
+
+	/**
+	 * Check if two intervals are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(IvalFlt<T> const &lhs, IvalFlt<T> const &rhs) {
+		return fp_eq<T>(lhs.lo, rhs.lo) && fp_eq<T>(lhs.hi, rhs.hi) && (lhs.lsb == rhs.lsb);
+	}
 };
 
 
+/*
+ * interval float set class
+ *   A bounded set of disjoint intervals, sorted by their lower bound and
+ *   stored inline. Overlapping intervals are merged on insertion. Past the
+ *   capacity, the two neighbours with the fewest floats between them are
+ *   joined, except that gaps whose closure would introduce subnormals are
+ *   joined last.
+ */
+template <class T> class IvalSet {
+public:
+	static const uint32_t Max = 16;
+
+	IvalSet() { cnt = 0; }
+	~IvalSet() { }
+
+	uint32_t size() const { return cnt; }
+	bool empty() const { return cnt == 0; }
+	void clear() { cnt = 0; }
+
+	IvalFlt<T> const* begin() const { return buf; }
+	IvalFlt<T> const* end() const { return buf + cnt; }
+	IvalFlt<T> const& operator[](uint32_t i) const { return buf[i]; }
+
+
+	/**
+	 * Insert an interval, merging it with any interval it overlaps. NaN
+	 * bounds are taken as unbounded.
+	 *   @ival: The interval.
+	 */
+	void Insert(IvalFlt<T> const& ival) {
+		T lo = std::isnan(ival.lo) ? -INFINITY : ival.lo;
+		T hi = std::isnan(ival.hi) ? INFINITY : ival.hi;
+		int lsb = ival.lsb;
+		uint32_t i, j;
+
+		if(!fp_lte<T>(lo, hi))
+			std::swap(lo, hi);
+
+		for(i = 0; (i < cnt) && !fp_gte<T>(buf[i].hi, lo); i++);
+		for(j = i; (j < cnt) && fp_lte<T>(buf[j].lo, hi); j++) {
+			lo = fp_min<T>(lo, buf[j].lo);
+			hi = fp_max<T>(hi, buf[j].hi);
+			lsb = std::min(lsb, buf[j].lsb);
+		}
+
+		if(j == i) {
+			std::copy_backward(buf + i, buf + cnt, buf + cnt + 1);
+			cnt++;
+		}
+		else {
+			std::copy(buf + j, buf + cnt, buf + i + 1);
+			cnt -= j - i - 1;
+		}
+
+		buf[i] = IvalFlt<T>(lo, hi, lsb);
+
+		if(cnt > Max)
+			Reduce(Max);
+	}
+
+	/**
+	 * Reduce the set to a capacity by joining neighbouring intervals.
+	 *   @cap: The capacity, at least one.
+	 */
+	void Reduce(uint32_t cap) {
+		while(cnt > std::max<uint32_t>(cap, 1)) {
+			uint32_t best = 0;
+			bool bsub = true;
+			uint64_t bgap = UINT64_MAX;
+
+			for(uint32_t i = 0; i + 1 < cnt; i++) {
+				bool sub = !buf[i].HasSubnorm() && !buf[i + 1].HasSubnorm() && Join(buf[i], buf[i + 1]).HasSubnorm();
+				uint64_t gap = (uint64_t)fp_ord<T>(buf[i + 1].lo) - (uint64_t)fp_ord<T>(buf[i].hi);
+
+				if((sub < bsub) || ((sub == bsub) && (gap < bgap)))
+					best = i, bsub = sub, bgap = gap;
+			}
+
+			buf[best] = Join(buf[best], buf[best + 1]);
+			std::copy(buf + best + 2, buf + cnt, buf + best + 1);
+			cnt--;
+		}
+	}
+
+
+	/**
+	 * Join two intervals into their hull.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The hull.
+	 */
+	static IvalFlt<T> Join(IvalFlt<T> const& lhs, IvalFlt<T> const& rhs) {
+		return IvalFlt<T>(fp_min<T>(lhs.lo, rhs.lo), fp_max<T>(lhs.hi, rhs.hi), std::min(lhs.lsb, rhs.lsb));
+	}
+
+private:
+	uint32_t cnt;
+	IvalFlt<T> buf[Max + 1];
+};
+
 /*
  * interval integer class
  */
@@ -191,6 +309,20 @@ public:
 		return lo == hi;
 	}
 
+	/**
+	 * Retrieve the mask of the leading bits shared by every value of the
+	 * interval, those above the highest bit where the bounds differ.
+	 *   &returns: The mask.
+	 */
+	T Prefix() const {
+		if(lo == hi)
+			return fp_ones<T>();
+
+		uint32_t top = 64 - __builtin_clzll((uint64_t)(lo ^ hi));
+
+		return (top >= 8 * sizeof(T)) ? 0 : (fp_ones<T>() << top);
+	}
+
 	/**
 	 * Convert an interval to a string.
 	 *   &returns: The string.
@@ -271,6 +403,77 @@ public:
 		return Inside(lhs, rhs.lo) || Inside(lhs, rhs.hi) || Inside(rhs, lhs.lo) || Inside(rhs, lhs.hi);
 	}
 
+	/**
+	 * Check if two intervals are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(IvalInt<T> const& lhs, IvalInt<T> const& rhs) {
+		return (lhs.lo == rhs.lo) && (lhs.hi == rhs.hi);
+	}
+
+	/**
+	 * And two intervals. A constant that keeps every varying bit of the
+	 * other side maps its bounds exactly; otherwise the result is bounded
+	 * by the bits both sides are known to share.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result interval.
+	 */
+	static IvalInt<T> And(IvalInt<T> const& lhs, IvalInt<T> const& rhs) {
+		T lpre = lhs.Prefix(), rpre = rhs.Prefix();
+
+		if(rhs.IsConst() && ((~lpre & rhs.lo) == (T)~lpre))
+			return IvalInt(lhs.lo & rhs.lo, lhs.hi & rhs.lo);
+		else if(lhs.IsConst() && ((~rpre & lhs.lo) == (T)~rpre))
+			return IvalInt(lhs.lo & rhs.lo, lhs.lo & rhs.hi);
+
+		T zeros = (~lhs.lo & lpre) | (~rhs.lo & rpre), ones = lhs.lo & lpre & rhs.lo & rpre;
+
+		return IvalInt(ones, std::min({ (T)~zeros, lhs.hi, rhs.hi }));
+	}
+
+	/**
+	 * Or two intervals. A constant that only touches the shared leading bits
+	 * of the other side maps its bounds exactly.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result interval.
+	 */
+	static IvalInt<T> Or(IvalInt<T> const& lhs, IvalInt<T> const& rhs) {
+		T lpre = lhs.Prefix(), rpre = rhs.Prefix();
+
+		if(rhs.IsConst() && ((~lpre & rhs.lo) == 0))
+			return IvalInt(lhs.lo | rhs.lo, lhs.hi | rhs.lo);
+		else if(lhs.IsConst() && ((~rpre & lhs.lo) == 0))
+			return IvalInt(lhs.lo | rhs.lo, lhs.lo | rhs.hi);
+
+		T zeros = ~lhs.lo & lpre & ~rhs.lo & rpre, ones = (lhs.lo & lpre) | (rhs.lo & rpre);
+
+		return IvalInt(std::max({ ones, lhs.lo, rhs.lo }), ~zeros);
+	}
+
+	/**
+	 * Xor two intervals. A constant that only touches the shared leading
+	 * bits of the other side maps its bounds exactly.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result interval.
+	 */
+	static IvalInt<T> Xor(IvalInt<T> const& lhs, IvalInt<T> const& rhs) {
+		T lpre = lhs.Prefix(), rpre = rhs.Prefix();
+
+		if(rhs.IsConst() && ((~lpre & rhs.lo) == 0))
+			return IvalInt(lhs.lo ^ rhs.lo, lhs.hi ^ rhs.lo);
+		else if(lhs.IsConst() && ((~rpre & lhs.lo) == 0))
+			return IvalInt(lhs.lo ^ rhs.lo, lhs.lo ^ rhs.hi);
+
+		T zeros = lpre & rpre & ~(lhs.lo ^ rhs.lo), ones = lpre & rpre & (lhs.lo ^ rhs.lo);
+
+		return IvalInt(ones, ~zeros);
+	}
+
 	/**
 	 * Compute the intersection of two intervals. The intervals must
 	 *   overlap.
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <functional>
+
 /*
  * Pass class
  */
@@ -8,17 +10,92 @@ public:
 	Pass() { }
 	~Pass() { }
 
-	std::map<const llvm::Value *, Range> map;
+	Pass(Pass const&) = delete;
+	Pass& operator=(Pass const&) = delete;
+
+	/**
+	 * Storage of every range computed by the pass. The facts below hold
+	 * interned ranges, so identical ranges are stored once and compare by
+	 * address.
+	 */
+	RangePool pool;
+
+	/**
+	 * Ranges of the values of the function.
+	 */
+	Table map;
+
+	/**
+	 * Ranges implied on the edges of conditional branches, keyed by the
+	 * (source, destination) block pair.
+	 */
+	std::map<std::pair<const llvm::BasicBlock *, const llvm::BasicBlock *>, std::map<const llvm::Value *, const Range *>> edges;
+
+	/**
+	 * Dominator tree of the analysed function, used to find the edges whose
+	 * facts hold in a block.
+	 */
+	std::unique_ptr<llvm::DominatorTree> dom;
+
+	/**
+	 * Ranges implied by the `llvm.assume` calls of each block.
+	 */
+	std::map<const llvm::BasicBlock *, std::map<const llvm::Value *, const Range *>> assumes;
+
+	/**
+	 * Ranges declared on memory objects, bounding the loads from them.
+	 */
+	std::map<const llvm::Value *, Range> seeds;
+
+	/**
+	 * Memory slots of the non-escaping allocas, keyed by the loads and
+	 * stores that access them. A load from a slot takes the join of the
+	 * values stored to it.
+	 */
+	std::map<const llvm::Instruction *, uint32_t> slots;
+
+	/**
+	 * Stores and loads of each memory slot.
+	 */
+	std::vector<std::vector<const llvm::StoreInst *>> stores;
+	std::vector<std::vector<const llvm::LoadInst *>> loads;
+
+	/**
+	 * Optional operand filter. When set, arithmetic operands are passed
+	 * through it before evaluation so that the analysis sees the ranges of
+	 * the guarded operands.
+	 */
+	std::function<Range(llvm::Instruction const&, unsigned int, Range const&)> guard;
+
+	/**
+	 * Optional call summary. When set, the results of direct calls are taken
+	 * from it instead of being left unknown.
+	 */
+	std::function<Range(llvm::CallInst const&)> callee;
+
+	/**
+	 * Set the fact of a value.
+	 *   @value: The value.
+	 *   @range: The range.
+	 *   &returns: The interned range.
+	 */
+	Range const& Put(const llvm::Value *value, Range const& range) {
+		const Range *res = pool.Intern(range);
+
+		map.Set(value, res);
+
+		return *res;
+	}
 
 	/**
 	 * Given a value, retrieve the associated fact.
 	 *   @value: The value.
 	 *   &returns: The fact.
 	 */
-	Range& GetRange(llvm::Value *value) {
-		auto find = map.find(value);
-		if(find != map.end())
-			return find->second;
+	Range const& GetRange(llvm::Value *value) {
+		const Range *find = map.Find(value);
+		if(find != nullptr)
+			return *find;
 
 		if(llvm::isa<llvm::UndefValue>(value)) {
 			Type type = GetType(*value);
@@ -26,39 +103,35 @@ public:
 			switch(type.kind) {
 			case Kind::Flt:
 				if(type.width == 32)
-					return map[value] = Range(RangeVecF32::Undef(type.count));
+					return Put(value, Range(RangeVecF32::Undef(type.count)));
 				else if(type.width == 64)
-					return map[value] = Range(RangeVecF64::Undef(type.count));
+					return Put(value, Range(RangeVecF64::Undef(type.count)));
 				else
-					return map[value] = Range();
+					return Put(value, Range());
 
 			default:
-				return map[value] = Range();
+				return Put(value, Range());
 			}
 		}
 		else if(llvm::isa<llvm::ConstantFP>(value)) {
 			llvm::ConstantFP *fp = llvm::cast<llvm::ConstantFP>(value);
 
 			if(value->getType()->isFloatTy())
-				map[value] = Range::ConstF32(fp->getValueAPF().convertToFloat());
+				return Put(value, Range::ConstF32(fp->getValueAPF().convertToFloat()));
 			else if(value->getType()->isDoubleTy())
-				map[value] = Range::ConstF64(fp->getValueAPF().convertToDouble());
+				return Put(value, Range::ConstF64(fp->getValueAPF().convertToDouble()));
 			else
-				map[value] = Range();
-
-			return map[value];
+				return Put(value, Range());
 		}
 		else if(llvm::isa<llvm::ConstantInt>(value)) {
 			llvm::ConstantInt *ival = llvm::cast<llvm::ConstantInt>(value);
 
 			if(value->getType()->isIntegerTy(32))
-				map[value] = Range::ConstI32(ival->getZExtValue());
+				return Put(value, Range::ConstI32(ival->getZExtValue()));
 			else if(value->getType()->isIntegerTy(64))
-				map[value] = Range::ConstI64(ival->getZExtValue());
+				return Put(value, Range::ConstI64(ival->getZExtValue()));
 			else
-				map[value] = Range();
-
-			return map[value];
+				return Put(value, Range());
 		}
 		else if(llvm::isa<llvm::ConstantDataVector>(value)) {
 			llvm::ConstantDataVector *vec = llvm::cast<llvm::ConstantDataVector>(value);
@@ -70,7 +143,7 @@ public:
 				for(i = 0; i < n; i++)
 					range.scalars.push_back(RangeI32::Const(vec->getElementAsInteger(i)));
 
-				return map[value] = Range(range);
+				return Put(value, Range(range));
 			}
 			else if(vec->getType()->getElementType()->isIntegerTy(64)) {
 				RangeVecI64 range;
@@ -78,26 +151,30 @@ public:
 				for(i = 0; i < n; i++)
 					range.scalars.push_back(RangeI64::Const(vec->getElementAsInteger(i)));
 
-				return map[value] = Range(range);
+				return Put(value, Range(range));
 			}
 			else if(vec->getType()->getElementType()->isFloatTy()) {
 				RangeVecF32 range;
 
 				for(i = 0; i < n; i++)
-					range.scalars.push_back(RangeF32::Const(vec->getElementAsFloat(i)));
+					range.Push(RangeF32::Const(vec->getElementAsFloat(i)));
 
-				return map[value] = Range(range);
+				range.Pack();
+
+				return Put(value, Range(range));
 			}
 			else if(vec->getType()->getElementType()->isDoubleTy()) {
 				RangeVecF64 range;
 
 				for(i = 0; i < n; i++)
-					range.scalars.push_back(RangeF64::Const(vec->getElementAsDouble(i)));
+					range.Push(RangeF64::Const(vec->getElementAsDouble(i)));
+
+				range.Pack();
 
-				return map[value] = Range(range);
+				return Put(value, Range(range));
 			}
 			else
-				return map[value] = Range();
+				return Put(value, Range());
 		}
 		else if(llvm::isa<llvm::ConstantVector>(value)) {
 			llvm::ConstantVector *vec = llvm::cast<llvm::ConstantVector>(value);
@@ -110,14 +187,16 @@ public:
 					llvm::Constant *c = vec->getAggregateElement(i);
 
 					if(llvm::isa<llvm::ConstantFP>(c))
-						range.scalars.push_back(RangeF32::Const(llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToFloat()));
+						range.Push(RangeF32::Const(llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToFloat()));
 					else if(llvm::isa<llvm::UndefValue>(c))
-						range.scalars.push_back(RangeF32::Undef());
+						range.Push(RangeF32::Undef());
 					else
-						range.scalars.push_back(RangeF32::All());
+						range.Push(RangeF32::All());
 				}
 
-				return map[value] = Range(range);
+				range.Pack();
+
+				return Put(value, Range(range));
 			}
 			else if(vec->getType()->getElementType()->isDoubleTy()) {
 				RangeVecF64 range;
@@ -126,38 +205,584 @@ public:
 					llvm::Constant *c = vec->getAggregateElement(i);
 
 					if(llvm::isa<llvm::ConstantFP>(c))
-						range.scalars.push_back(RangeF64::Const(llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToDouble()));
+						range.Push(RangeF64::Const(llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToDouble()));
 					else if(llvm::isa<llvm::UndefValue>(c))
-						range.scalars.push_back(RangeF64::Undef());
+						range.Push(RangeF64::Undef());
 					else
-						range.scalars.push_back(RangeF64::All());
+						range.Push(RangeF64::All());
 				}
 
-				return map[value] = Range(range);
+				range.Pack();
+
+				return Put(value, Range(range));
 			}
 			else
-				return map[value] = Range();
+				return Put(value, Range());
 		}
 		else if(llvm::isa<llvm::ConstantAggregateZero>(value)) {
 			llvm::ConstantAggregateZero *zero = llvm::cast<llvm::ConstantAggregateZero>(value);
 
 			if(zero->getType()->isVectorTy()) {
 				if(zero->getType()->getVectorElementType()->isIntegerTy(32))
-					return map[value] = Range(RangeVecI32::Const(0, zero->getType()->getVectorNumElements()));
+					return Put(value, Range(RangeVecI32::Const(0, zero->getType()->getVectorNumElements())));
 				else if(zero->getType()->getVectorElementType()->isIntegerTy(64))
-					return map[value] = Range(RangeVecI64::Const(0, zero->getType()->getVectorNumElements()));
+					return Put(value, Range(RangeVecI64::Const(0, zero->getType()->getVectorNumElements())));
 				else if(zero->getType()->getVectorElementType()->isFloatTy())
-					return map[value] = Range(RangeVecF32::Const(0.0, zero->getType()->getVectorNumElements()));
+					return Put(value, Range(RangeVecF32::Const(0.0, zero->getType()->getVectorNumElements())));
 				else if(zero->getType()->getVectorElementType()->isDoubleTy())
-					return map[value] = Range(RangeVecF64::Const(0.0, zero->getType()->getVectorNumElements()));
+					return Put(value, Range(RangeVecF64::Const(0.0, zero->getType()->getVectorNumElements())));
 				else
-					return map[value] = Range();
+					return Put(value, Range());
+			}
+			else
+				return Put(value, Range());
+		}
+		else
+			return Put(value, Range());
+	}
+
+	/**
+	 * Retrieve the range of a value as seen from a block. The dominator tree
+	 * is walked upwards and the first edge fact found for the value wins.
+	 *   @value: The value.
+	 *   @block: The block.
+	 *   &returns: The range.
+	 */
+	Range const& Lookup(llvm::Value *value, llvm::BasicBlock const *block) {
+		if(!dom || llvm::isa<llvm::Constant>(value))
+			return GetRange(value);
+
+		for(auto *node = dom->getNode(const_cast<llvm::BasicBlock *>(block)); node != nullptr; node = node->getIDom()) {
+			const llvm::BasicBlock *cur = node->getBlock();
+
+			auto assume = assumes.find(cur);
+			if(assume != assumes.end()) {
+				auto find = assume->second.find(value);
+				if(find != assume->second.end())
+					return *find->second;
+			}
+
+			const llvm::BasicBlock *pred = cur->getSinglePredecessor();
+			if(pred == nullptr)
+				continue;
+
+			auto edge = edges.find({ pred, cur });
+			if(edge == edges.end())
+				continue;
+
+			auto find = edge->second.find(value);
+			if(find != edge->second.end())
+				return *find->second;
+		}
+
+		return GetRange(value);
+	}
+
+	/**
+	 * Retrieve the range of a value flowing along an edge.
+	 *   @value: The value.
+	 *   @from: The source block.
+	 *   @to: The destination block.
+	 *   &returns: The range.
+	 */
+	Range const& Lookup(llvm::Value *value, llvm::BasicBlock const *from, llvm::BasicBlock const *to) {
+		auto edge = edges.find({ from, to });
+		if(edge != edges.end()) {
+			auto find = edge->second.find(value);
+			if(find != edge->second.end())
+				return *find->second;
+		}
+
+		return Lookup(value, from);
+	}
+
+	/**
+	 * Retrieve the range of an operand at its use.
+	 *   @inst: The instruction.
+	 *   @i: The operand index.
+	 *   &returns: The range.
+	 */
+	Range const& Get(llvm::Instruction const &inst, unsigned int i) {
+		return Lookup(inst.getOperand(i), inst.getParent());
+	}
+
+	/**
+	 * Retrieve the range of an arithmetic operand, applying the guard.
+	 *   @inst: The instruction.
+	 *   @i: The operand index.
+	 *   &returns: The range.
+	 */
+	Range const& Arg(llvm::Instruction const &inst, unsigned int i) {
+		Range const& range = Get(inst, i);
+
+		return guard ? *pool.Intern(guard(inst, i, range)) : range;
+	}
+
+	/**
+	 * Retrieve the range of a value while collecting the facts of a
+	 * condition, preferring the facts collected so far.
+	 *   @value: The value.
+	 *   @block: The block.
+	 *   @facts: The facts.
+	 *   &returns: The range.
+	 */
+	Range const& Lookup(llvm::Value *value, llvm::BasicBlock const *block, std::map<const llvm::Value *, const Range *> const &facts) {
+		auto find = facts.find(value);
+
+		return (find != facts.end()) ? *find->second : Lookup(value, block);
+	}
+
+	/**
+	 * Collect the ranges implied by a condition having a given outcome.
+	 * Comparisons refine their operands, and the argument of an fabs operand;
+	 * unordered predicates are handled as the inverse ordered predicate with
+	 * the outcome flipped, so that the failing side of an ordered comparison
+	 * keeps NaN. Conjunctions that hold and disjunctions that fail refine
+	 * both of their sides in turn.
+	 *   @cond: The condition.
+	 *   @taken: The outcome.
+	 *   @block: The block evaluating the condition.
+	 *   @facts: The facts, refined in place.
+	 */
+	void Cond(llvm::Value *cond, bool taken, llvm::BasicBlock const *block, std::map<const llvm::Value *, const Range *> &facts) {
+		const llvm::Instruction *inst = llvm::dyn_cast<llvm::Instruction>(cond);
+		if((inst == nullptr) || !inst->getType()->isIntegerTy(1))
+			return;
+
+		if(((inst->getOpcode() == llvm::Instruction::And) && taken) || ((inst->getOpcode() == llvm::Instruction::Or) && !taken)) {
+			Cond(inst->getOperand(0), taken, block, facts);
+			Cond(inst->getOperand(1), taken, block, facts);
+			return;
+		}
+		else if(inst->getOpcode() == llvm::Instruction::Select) {
+			const llvm::ConstantInt *t = llvm::dyn_cast<llvm::ConstantInt>(inst->getOperand(1));
+			const llvm::ConstantInt *f = llvm::dyn_cast<llvm::ConstantInt>(inst->getOperand(2));
+
+			if((taken && (f != nullptr) && f->isZero()) || (!taken && (t != nullptr) && t->isOne())) {
+				Cond(inst->getOperand(0), taken, block, facts);
+				Cond(inst->getOperand((f != nullptr) && f->isZero() ? 1 : 2), taken, block, facts);
+			}
+
+			return;
+		}
+
+		const llvm::FCmpInst *cmp = llvm::dyn_cast<llvm::FCmpInst>(inst);
+		if(cmp == nullptr)
+			return;
+
+		llvm::CmpInst::Predicate pred = cmp->getPredicate();
+		if(llvm::CmpInst::isUnordered(pred)) {
+			pred = llvm::CmpInst::getInversePredicate(pred);
+			taken = !taken;
+		}
+
+		Range a = Lookup(cmp->getOperand(0), block, facts), b = Lookup(cmp->getOperand(1), block, facts);
+		Range res[2];
+
+		switch(pred) {
+		case llvm::CmpInst::FCMP_OLT:
+		case llvm::CmpInst::FCMP_OLE:
+			res[0] = taken ? Range::Below(a, b, false) : Range::Above(a, b, true);
+			res[1] = taken ? Range::Above(b, a, false) : Range::Below(b, a, true);
+			break;
+
+		case llvm::CmpInst::FCMP_OGT:
+		case llvm::CmpInst::FCMP_OGE:
+			res[0] = taken ? Range::Above(a, b, false) : Range::Below(a, b, true);
+			res[1] = taken ? Range::Below(b, a, false) : Range::Above(b, a, true);
+			break;
+
+		case llvm::CmpInst::FCMP_OEQ:
+			if(!taken)
+				return;
+
+			res[0] = Range::Above(Range::Below(a, b, false), b, false);
+			res[1] = Range::Above(Range::Below(b, a, false), a, false);
+			break;
+
+		case llvm::CmpInst::FCMP_ONE:
+		case llvm::CmpInst::FCMP_ORD:
+			if(!taken)
+				return;
+
+			res[0] = Range::Below(a, a, false);
+			res[1] = Range::Below(b, b, false);
+			break;
+
+		default:
+			return;
+		}
+
+		for(uint32_t j = 0; j < 2; j++) {
+			llvm::Value *val = cmp->getOperand(j);
+			if(llvm::isa<llvm::Constant>(val))
+				continue;
+
+			facts[val] = pool.Intern(res[j].Compact(128));
+
+			const llvm::Instruction *abs = llvm::dyn_cast<llvm::Instruction>(val);
+			if((abs != nullptr) && (GetOp(*abs) == Op::Abs)) {
+				llvm::Value *arg = abs->getOperand(0);
+
+				if(!llvm::isa<llvm::Constant>(arg))
+					facts[arg] = pool.Intern(Range::InvAbs(Lookup(arg, block, facts), res[j]).Compact(128));
+			}
+		}
+	}
+
+	/**
+	 * Store a set of facts, reporting whether they differ from the previous.
+	 * The ranges are interned, so equal facts hold the same pointers.
+	 *   @prev: The stored facts.
+	 *   @next: The new facts.
+	 *   &returns: True if changed.
+	 */
+	static bool Update(std::map<const llvm::Value *, const Range *> &prev, std::map<const llvm::Value *, const Range *> const &next) {
+		if(prev == next)
+			return false;
+
+		prev = next;
+		return true;
+	}
+
+	/**
+	 * Compute the ranges implied on the outgoing edges of a block that ends
+	 * with a conditional branch.
+	 *   @block: The block.
+	 *   &returns: True if any edge fact changed.
+	 */
+	bool Refine(llvm::BasicBlock const *block) {
+		const llvm::BranchInst *br = llvm::dyn_cast<llvm::BranchInst>(block->getTerminator());
+		if((br == nullptr) || !br->isConditional() || (br->getSuccessor(0) == br->getSuccessor(1)))
+			return false;
+
+		bool change = false;
+
+		for(uint32_t i = 0; i < 2; i++) {
+			std::map<const llvm::Value *, const Range *> edge;
+
+			Cond(br->getCondition(), i == 0, block, edge);
+			change |= Update(edges[{ block, br->getSuccessor(i) }], edge);
+		}
+
+		return change;
+	}
+
+	/**
+	 * Compute the ranges implied by the `llvm.assume` calls of a block. The
+	 * facts hold in the block and in the blocks it dominates.
+	 *   @block: The block.
+	 *   &returns: True if the facts changed.
+	 */
+	bool Assume(llvm::BasicBlock const *block) {
+		std::map<const llvm::Value *, const Range *> facts;
+
+		for(const llvm::Instruction &inst : *block) {
+			const llvm::CallInst *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+
+			if((call != nullptr) && (call->getCalledFunction() != nullptr) && (call->getCalledFunction()->getIntrinsicID() == llvm::Intrinsic::assume))
+				Cond(call->getArgOperand(0), true, block, facts);
+		}
+
+		if(facts.empty() && (assumes.find(block) == assumes.end()))
+			return false;
+
+		return Update(assumes[block], facts);
+	}
+
+	/**
+	 * Retrieve the value of a floating-point constant as a double.
+	 *   @fp: The constant.
+	 *   &returns: The value.
+	 */
+	static double GetDouble(llvm::ConstantFP const& fp) {
+		if(fp.getType()->isFloatTy())
+			return fp.getValueAPF().convertToFloat();
+		else
+			return fp.getValueAPF().convertToDouble();
+	}
+
+	/**
+	 * Parse a `ctfp_range(lo, hi)` annotation or a `lo, hi` attribute value.
+	 *   @str: The string.
+	 *   @lo: Output. The lower bound.
+	 *   @hi: Output. The upper bound.
+	 *   &returns: True if parsed.
+	 */
+	static bool Parse(std::string const &str, double *lo, double *hi) {
+		if(sscanf(str.c_str(), " ctfp_range ( %lf , %lf )", lo, hi) == 2)
+			return true;
+		else
+			return sscanf(str.c_str(), " %lf , %lf", lo, hi) == 2;
+	}
+
+	/**
+	 * Retrieve the string of an annotation operand.
+	 *   @value: The annotation string operand.
+	 *   &returns: The string, empty if not a constant string.
+	 */
+	static std::string Annot(llvm::Value const *value) {
+		const llvm::GlobalVariable *global = llvm::dyn_cast<llvm::GlobalVariable>(value->stripPointerCasts());
+		if((global == nullptr) || !global->hasInitializer())
+			return "";
+
+		const llvm::ConstantDataArray *data = llvm::dyn_cast<llvm::ConstantDataArray>(global->getInitializer());
+
+		return ((data != nullptr) && data->isCString()) ? data->getAsCString().str() : "";
+	}
+
+	/**
+	 * Seed the ranges declared in the source. Parameters take the
+	 * `ctfp_range` string attribute; globals and locals take a
+	 * `ctfp_range(lo, hi)` annotation, which bounds the loads from them.
+	 *   @func: The function.
+	 */
+	void Seed(llvm::Function &func) {
+		double lo, hi;
+
+		seeds.clear();
+
+		for(llvm::Argument &arg : func.args()) {
+			llvm::AttributeList attrs = func.getAttributes();
+			unsigned int idx = llvm::AttributeList::FirstArgIndex + arg.getArgNo();
+
+			if(attrs.hasAttribute(idx, "ctfp_range") && Parse(attrs.getAttribute(idx, "ctfp_range").getValueAsString().str(), &lo, &hi))
+				Put(&arg, Range::Clamp(GetRange(&arg), lo, hi, GetType(arg)));
+		}
+
+		llvm::GlobalVariable *annot = func.getParent()->getGlobalVariable("llvm.global.annotations");
+		if((annot != nullptr) && annot->hasInitializer() && llvm::isa<llvm::ConstantArray>(annot->getInitializer())) {
+			llvm::ConstantArray *list = llvm::cast<llvm::ConstantArray>(annot->getInitializer());
+
+			for(unsigned int i = 0; i < list->getNumOperands(); i++) {
+				llvm::ConstantStruct *entry = llvm::dyn_cast<llvm::ConstantStruct>(list->getOperand(i));
+				if((entry == nullptr) || !Parse(Annot(entry->getOperand(1)), &lo, &hi))
+					continue;
+
+				llvm::GlobalVariable *global = llvm::dyn_cast<llvm::GlobalVariable>(entry->getOperand(0)->stripPointerCasts());
+				if(global != nullptr)
+					seeds[global] = Range::Clamp(Range(), lo, hi, GetType(*global->getValueType()));
+			}
+		}
+
+		for(llvm::BasicBlock &block : func) {
+			for(llvm::Instruction &inst : block) {
+				const llvm::CallInst *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+				if((call == nullptr) || (call->getCalledFunction() == nullptr) || (call->getCalledFunction()->getIntrinsicID() != llvm::Intrinsic::var_annotation))
+					continue;
+
+				const llvm::AllocaInst *alloca = llvm::dyn_cast<llvm::AllocaInst>(call->getArgOperand(0)->stripPointerCasts());
+				if((alloca != nullptr) && Parse(Annot(call->getArgOperand(1)), &lo, &hi))
+					seeds[alloca] = Range::Clamp(Range(), lo, hi, GetType(*alloca->getAllocatedType()));
+			}
+		}
+	}
+
+	/**
+	 * Split the non-escaping allocas of a function into memory slots. An
+	 * alloca is tracked if it is only loaded from and stored to, directly or
+	 * through casts and constant offsets, and if its accesses at each offset
+	 * agree on the type and do not overlap those at other offsets.
+	 *   @func: The function.
+	 */
+	void Slots(llvm::Function &func) {
+		const llvm::DataLayout &layout = func.getParent()->getDataLayout();
+
+		slots.clear();
+		stores.clear();
+		loads.clear();
+
+		for(llvm::BasicBlock &block : func) {
+			for(llvm::Instruction &inst : block) {
+				std::map<int64_t, std::pair<llvm::Type *, std::vector<const llvm::Instruction *>>> offs;
+
+				if(!llvm::isa<llvm::AllocaInst>(inst) || !Access(&inst, 0, layout, offs))
+					continue;
+
+				int64_t end = std::numeric_limits<int64_t>::min();
+				bool overlap = false;
+
+				for(auto const& off : offs) {
+					overlap |= (off.first < end);
+					end = off.first + layout.getTypeStoreSize(off.second.first);
+				}
+
+				if(overlap)
+					continue;
+
+				for(auto const& off : offs) {
+					stores.emplace_back();
+					loads.emplace_back();
+
+					for(const llvm::Instruction *access : off.second.second) {
+						slots[access] = stores.size() - 1;
+
+						if(llvm::isa<llvm::StoreInst>(access))
+							stores.back().push_back(llvm::cast<llvm::StoreInst>(access));
+						else
+							loads.back().push_back(llvm::cast<llvm::LoadInst>(access));
+					}
+				}
+			}
+		}
+	}
+
+	/**
+	 * Collect the accesses through a pointer into an alloca.
+	 *   @ptr: The pointer.
+	 *   @off: The byte offset of the pointer into the alloca.
+	 *   @layout: The data layout.
+	 *   @offs: Output. The type and the accesses at each offset.
+	 *   &returns: True if the pointer does not escape.
+	 */
+	static bool Access(const llvm::Value *ptr, int64_t off, llvm::DataLayout const& layout, std::map<int64_t, std::pair<llvm::Type *, std::vector<const llvm::Instruction *>>> &offs) {
+		for(const llvm::User *user : ptr->users()) {
+			llvm::Type *type;
+
+			if(llvm::isa<llvm::LoadInst>(user) && !llvm::cast<llvm::LoadInst>(user)->isVolatile())
+				type = user->getType();
+			else if(llvm::isa<llvm::StoreInst>(user) && !llvm::cast<llvm::StoreInst>(user)->isVolatile() && (llvm::cast<llvm::StoreInst>(user)->getPointerOperand() == ptr))
+				type = llvm::cast<llvm::StoreInst>(user)->getValueOperand()->getType();
+			else if(llvm::isa<llvm::BitCastInst>(user)) {
+				if(!Access(user, off, layout, offs))
+					return false;
+
+				continue;
+			}
+			else if(llvm::isa<llvm::GetElementPtrInst>(user)) {
+				llvm::APInt delta(layout.getPointerSizeInBits(), 0);
+
+				if(!llvm::cast<llvm::GetElementPtrInst>(user)->accumulateConstantOffset(layout, delta) || !Access(user, off + delta.getSExtValue(), layout, offs))
+					return false;
+
+				continue;
+			}
+			else if(llvm::isa<llvm::IntrinsicInst>(user)) {
+				switch(llvm::cast<llvm::IntrinsicInst>(user)->getIntrinsicID()) {
+				case llvm::Intrinsic::lifetime_start:
+				case llvm::Intrinsic::lifetime_end:
+				case llvm::Intrinsic::var_annotation:
+					continue;
+
+				default:
+					return false;
+				}
 			}
 			else
-				return map[value] = Range();
+				return false;
+
+			auto ins = offs.insert({ off, { type, { } } });
+			if(ins.first->second.first != type)
+				return false;
+
+			ins.first->second.second.push_back(llvm::cast<llvm::Instruction>(user));
+		}
+
+		return true;
+	}
+
+	/**
+	 * Join the ranges stored to a memory slot. Stores not yet processed are
+	 * skipped.
+	 *   @slot: The slot.
+	 *   @type: The type.
+	 *   &returns: The range, unknown if nothing is stored yet.
+	 */
+	Range Stored(uint32_t slot, Type type) {
+		bool first = true;
+		Range res;
+
+		for(const llvm::StoreInst *store : stores[slot]) {
+			if(!map.Has(store))
+				continue;
+
+			res = first ? map.Get(store) : Range::Union(res, map.Get(store), type);
+			first = false;
+		}
+
+		return first ? Range(type) : res;
+	}
+
+	/**
+	 * Fold a load from constant memory. The pointer is either constant or
+	 * indexes a constant global with a single variable index, in which case
+	 * the elements within the range of the index are joined.
+	 *   @load: The load.
+	 *   &returns: The range, or unknown if the memory is not constant.
+	 */
+	Range Fold(llvm::LoadInst const& load) {
+		llvm::DataLayout const& layout = load.getModule()->getDataLayout();
+		llvm::Value *ptr = const_cast<llvm::Value *>(load.getPointerOperand());
+		const llvm::GlobalVariable *global = llvm::dyn_cast<llvm::GlobalVariable>(llvm::GetUnderlyingObject(ptr, layout));
+
+		if((global == nullptr) || !global->isConstant() || !global->hasDefinitiveInitializer())
+			return Range();
+
+		if(llvm::isa<llvm::Constant>(ptr)) {
+			llvm::Constant *val = llvm::ConstantFoldLoadFromConstPtr(llvm::cast<llvm::Constant>(ptr), load.getType(), layout);
+
+			return (val != nullptr) ? GetRange(val) : Range();
 		}
+
+		const llvm::GetElementPtrInst *gep = llvm::dyn_cast<llvm::GetElementPtrInst>(ptr);
+		if((gep == nullptr) || !llvm::isa<llvm::Constant>(gep->getPointerOperand()))
+			return Range();
+
+		llvm::Constant *base = llvm::cast<llvm::Constant>(const_cast<llvm::Value *>(gep->getPointerOperand()));
+
+		std::vector<llvm::Value *> idxs(gep->idx_begin(), gep->idx_end());
+		uint32_t pos = 0;
+
+		for(uint32_t i = 0; i < idxs.size(); i++) {
+			if(llvm::isa<llvm::ConstantInt>(idxs[i]))
+				continue;
+			else if((i == 0) || (pos != 0))
+				return Range();
+
+			pos = i;
+		}
+
+		llvm::Type *outer = llvm::GetElementPtrInst::getIndexedType(gep->getSourceElementType(), llvm::ArrayRef<llvm::Value *>(idxs).slice(0, pos));
+		uint64_t size;
+
+		if(outer->isArrayTy())
+			size = outer->getArrayNumElements();
+		else if(outer->isVectorTy())
+			size = outer->getVectorNumElements();
 		else
-			return map[value] = Range();
+			return Range();
+
+		if(size > 4096)
+			return Range();
+
+		llvm::Value *idx = idxs[pos];
+		if(llvm::isa<llvm::SExtInst>(idx) || llvm::isa<llvm::ZExtInst>(idx))
+			idx = llvm::cast<llvm::Instruction>(idx)->getOperand(0);
+
+		Range const& range = Lookup(idx, load.getParent());
+		Type type = GetType(load);
+		bool first = true;
+		Range res;
+
+		for(uint64_t i = 0; i < size; i++) {
+			if(!range.Contains(i))
+				continue;
+
+			std::vector<llvm::Constant *> elem;
+
+			for(uint32_t j = 0; j < idxs.size(); j++)
+				elem.push_back((j == pos) ? llvm::ConstantInt::get(idxs[j]->getType(), i) : llvm::cast<llvm::Constant>(idxs[j]));
+
+			llvm::Constant *addr = llvm::ConstantExpr::getGetElementPtr(gep->getSourceElementType(), base, elem);
+			llvm::Constant *val = llvm::ConstantFoldLoadFromConstPtr(addr, load.getType(), layout);
+			if(val == nullptr)
+				return Range();
+
+			res = first ? GetRange(val) : Range::Union(res, GetRange(val), type);
+			first = false;
+		}
+
+		return first ? Range(type) : res;
 	}
 
 	/**
@@ -165,112 +790,186 @@ public:
 	 *   @inst: The instruction.
 	 */
 	void Proc(llvm::Instruction const &inst) {
-		Range *lhs, *rhs;
 		Info info = GetInfo(inst);
+		Range res;
 
 		switch(info.op) {
 		case Op::Add:
-			lhs = &GetRange(inst.getOperand(0));
-			rhs = &GetRange(inst.getOperand(1));
-			map[&inst] = Range::Add(*lhs, *rhs, info.type);
+			res = Range::Add(Arg(inst, 0), Arg(inst, 1), info.type);
 			break;
 
 		case Op::Sub:
-			lhs = &GetRange(inst.getOperand(0));
-			rhs = &GetRange(inst.getOperand(1));
-			map[&inst] = Range::Sub(*lhs, *rhs, info.type);
+			res = Range::Sub(Arg(inst, 0), Arg(inst, 1), info.type);
 			break;
 
 		case Op::Mul:
-			lhs = &GetRange(inst.getOperand(0));
-			rhs = &GetRange(inst.getOperand(1));
-			map[&inst] = Range::Mul(*lhs, *rhs, info.type);
+			res = Range::Mul(Arg(inst, 0), Arg(inst, 1), info.type);
 			break;
 
 		case Op::Div:
-			lhs = &GetRange(inst.getOperand(0));
-			rhs = &GetRange(inst.getOperand(1));
-			map[&inst] = Range::Div(*lhs, *rhs, info.type);
+			res = Range::Div(Arg(inst, 0), Arg(inst, 1), info.type);
 			break;
 
 		case Op::And:
-			map[&inst] = Range::And(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), info.type);
+			res = Range::And(Get(inst, 0), Get(inst, 1), info.type);
 			break;
 
 		case Op::Or:
-			map[&inst] = Range::Or(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), info.type);
+			res = Range::Or(Get(inst, 0), Get(inst, 1), info.type);
 			break;
 
 		case Op::Xor:
-			map[&inst] = Range::Xor(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), info.type);
+			res = Range::Xor(Get(inst, 0), Get(inst, 1), info.type);
 			break;
 
 		case Op::CmpOLT:
-			map[&inst] = Range::CmpOLT(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), info.type);
+			res = Range::CmpOLT(Get(inst, 0), Get(inst, 1), info.type);
 			break;
 
 		case Op::CmpOGT:
-			map[&inst] = Range::CmpOGT(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), info.type);
+			res = Range::CmpOGT(Get(inst, 0), Get(inst, 1), info.type);
 			break;
 
 		case Op::Select:
-			map[&inst] = Range::Select(GetRange(inst.getOperand(0)), GetRange(inst.getOperand(1)), GetRange(inst.getOperand(2)), info.type);
+			res = Range::Select(Get(inst, 0), Get(inst, 1), Get(inst, 2), info.type);
 			break;
 
 		case Op::Abs:
-			map[&inst] = Range::Abs(GetRange(inst.getOperand(0)), info.type);
+			res = Range::Abs(Get(inst, 0), info.type);
 			break;
 
 		case Op::Sqrt:
-			map[&inst] = Range::Sqrt(GetRange(inst.getOperand(0)), info.type);
+			res = Range::Sqrt(Arg(inst, 0), info.type);
+			break;
+
+		case Op::Phi:
+			{
+				const llvm::PHINode *phi = llvm::cast<llvm::PHINode>(&inst);
+				bool first = true;
+
+				for(uint32_t i = 0; i < phi->getNumIncomingValues(); i++) {
+					llvm::Value *in = phi->getIncomingValue(i);
+					if(llvm::isa<llvm::Instruction>(in) && !map.Has(in))
+						continue;
+
+					Range const& range = Lookup(in, phi->getIncomingBlock(i), phi->getParent());
+					res = first ? range : Range::Union(res, range, info.type);
+					first = false;
+				}
+
+				if(first)
+					res = Range(info.type);
+			}
+			break;
+
+		case Op::Call:
+			res = callee ? callee(llvm::cast<llvm::CallInst>(inst)) : Range();
+			break;
+
+		case Op::Load:
+			{
+				const llvm::MDNode *node = inst.getMetadata("ctfp.range");
+				auto seed = seeds.find(llvm::cast<llvm::LoadInst>(inst).getPointerOperand()->stripPointerCasts());
+
+				auto slot = slots.find(&inst);
+
+				if(seed != seeds.end())
+					res = seed->second;
+				else if(slot != slots.end())
+					res = Stored(slot->second, info.type);
+				else
+					res = Fold(llvm::cast<llvm::LoadInst>(inst));
+
+				if((node != nullptr) && (node->getNumOperands() == 2)) {
+					const llvm::ConstantFP *lo = llvm::mdconst::dyn_extract<llvm::ConstantFP>(node->getOperand(0));
+					const llvm::ConstantFP *hi = llvm::mdconst::dyn_extract<llvm::ConstantFP>(node->getOperand(1));
+
+					if((lo != nullptr) && (hi != nullptr))
+						res = Range::Clamp(res, GetDouble(*lo), GetDouble(*hi), info.type);
+				}
+			}
+			break;
+
+		case Op::IAdd:
+			res = Range::Add(Get(inst, 0), Get(inst, 1), info.type);
+			break;
+
+		case Op::ISub:
+			res = Range::Sub(Get(inst, 0), Get(inst, 1), info.type);
+			break;
+
+		case Op::Shl:
+		case Op::LShr:
+			{
+				const llvm::Constant *amt = llvm::dyn_cast<llvm::Constant>(inst.getOperand(1));
+				if((amt != nullptr) && amt->getType()->isVectorTy())
+					amt = amt->getSplatValue();
+
+				if((amt == nullptr) || !llvm::isa<llvm::ConstantInt>(amt))
+					res = Range(info.type);
+				else if(info.op == Op::Shl)
+					res = Range::Shl(Get(inst, 0), llvm::cast<llvm::ConstantInt>(amt)->getZExtValue(), info.type);
+				else
+					res = Range::LShr(Get(inst, 0), llvm::cast<llvm::ConstantInt>(amt)->getZExtValue(), info.type);
+			}
+			break;
+
+		case Op::Cast:
+			res = Range::Cast(Get(inst, 0), info.type);
+			break;
+
+		case Op::Store:
+			res = (slots.count(&inst) > 0) ? Get(inst, 0) : Range();
 			break;
 
 		case Op::ItoF:
-			//in = &GetRange(inst.getOperand(0));
-			//map[&inst] = Range::ItoF(*in, info.type);
+			res = Range::ItoF(Get(inst, 0), info.type);
 			break;
 
 		case Op::FtoI:
-			//in = &GetRange(inst.getOperand(0));
-			//map[&inst] = Range::FtoI(*in, info.type);
+			res = Range::FtoI(Get(inst, 0), info.type);
 			break;
 
 		case Op::Insert:
 			if(llvm::isa<llvm::ConstantInt>(inst.getOperand(2))) {
 				int32_t idx = llvm::cast<llvm::ConstantInt>(inst.getOperand(2))->getZExtValue();
 
-				Range vec = GetRange(inst.getOperand(0));
-				Range val = GetRange(inst.getOperand(1));
+				Range const& vec = Get(inst, 0);
+				Range const& val = Get(inst, 1);
 
 				if(std::holds_alternative<RangeVecF32>(vec.var)) {
 					if(std::holds_alternative<RangeVecF32>(val.var)) {
 						RangeVecF32 range = std::get<RangeVecF32>(vec.var);
-						if((int)idx >= (int)range.scalars.size())
-							fprintf(stderr,"vector mismatch, idx=%d, len= %lu\n", idx, range.scalars.size()), abort();
+						if((int)idx >= (int)range.width)
+							fprintf(stderr,"vector mismatch, idx=%d, len= %u\n", idx, range.width), abort();
 
-						range.scalars[idx] = std::get<RangeVecF32>(val.var).scalars[0];
-						map[&inst] = range;
+						range.Expand();
+						range.scalars[idx] = std::get<RangeVecF32>(val.var).Lane(0);
+						range.Pack();
+						res = range;
 					}
 					else
-						map[&inst] = Range();
+						res = Range();
 				}
 				else if(std::holds_alternative<RangeVecF64>(vec.var)) {
 					if(std::holds_alternative<RangeVecF64>(val.var)) {
 						RangeVecF64 range = std::get<RangeVecF64>(vec.var);
-						if((int)idx >= (int)range.scalars.size())
-							fprintf(stderr,"vector mismatch, idx=%d, len= %lu\n", idx, range.scalars.size()), abort();
+						if((int)idx >= (int)range.width)
+							fprintf(stderr,"vector mismatch, idx=%d, len= %u\n", idx, range.width), abort();
 
-						range.scalars[idx] = std::get<RangeVecF64>(val.var).scalars[0];
-						map[&inst] = range;
+						range.Expand();
+						range.scalars[idx] = std::get<RangeVecF64>(val.var).Lane(0);
+						range.Pack();
+						res = range;
 					}
 					else
-						map[&inst] = Range();
+						res = Range();
 				}
 				else
-					map[&inst] = Range();
+					res = Range();
 			}
 			else
-				map[&inst] = Range();
+				res = Range();
 			
 			break;
 
@@ -278,45 +977,179 @@ public:
 			if(llvm::isa<llvm::ConstantInt>(inst.getOperand(1))) {
 				int32_t idx = llvm::cast<llvm::ConstantInt>(inst.getOperand(1))->getZExtValue();
 
-				Range vec = GetRange(inst.getOperand(0));
+				Range const& vec = Get(inst, 0);
 				if(std::holds_alternative<RangeVecF32>(vec.var)) {
-					RangeVecF32 range = std::get<RangeVecF32>(vec.var);
-					if((int)idx >= (int)range.scalars.size()) {
+					RangeVecF32 const& range = std::get<RangeVecF32>(vec.var);
+					if((int)idx >= (int)range.width) {
 						inst.print(llvm::outs());
 						std::cout << "\n";
 						inst.getParent()->print(llvm::outs());
 						std::cout << "\n";
-						fprintf(stderr,"vector mismatch, idx=%d, len= %lu\n", idx, range.scalars.size()), abort();
+						fprintf(stderr,"vector mismatch, idx=%d, len= %u\n", idx, range.width), abort();
 					}
 
-					map[&inst] = Range(range.scalars[idx]);
+					res = Range(range.Lane(idx));
 				}
 				else if(std::holds_alternative<RangeVecF64>(vec.var)) {
-					RangeVecF64 range = std::get<RangeVecF64>(vec.var);
-					if((int)idx >= (int)range.scalars.size()) {
+					RangeVecF64 const& range = std::get<RangeVecF64>(vec.var);
+					if((int)idx >= (int)range.width) {
 						inst.print(llvm::outs());
 						std::cout << "\n";
 						inst.getParent()->print(llvm::outs());
 						std::cout << "\n";
-						fprintf(stderr,"vector mismatch, idx=%d, len= %lu\n", idx, range.scalars.size()), abort();
+						fprintf(stderr,"vector mismatch, idx=%d, len= %u\n", idx, range.width), abort();
 					}
 
-					map[&inst] = Range(range.scalars[idx]);
+					res = Range(range.Lane(idx));
 				}
 				else
-					map[&inst] = Range();
+					res = Range();
 			}
 			else
-				map[&inst] = Range();
+				res = Range();
 
 			break;
 
 		default:
-			map[&inst] = Range();
+			res = Range();
 			break;
 		}
 
-		map[&inst] = map[&inst].Compact(128);
+		Put(&inst, res);
+	}
+
+	/**
+	 * Compute the ranges of a function by iterating to a fixpoint over the
+	 * control-flow graph. Blocks are visited in reverse post-order from a
+	 * worklist, PHI nodes join their incoming ranges, conditional branches on
+	 * comparisons refine their operands along each edge, stores wake up the
+	 * loads of their memory slot, loop headers and slot loads are widened
+	 * after a few visits, and a final narrowing sweep recovers the precision
+	 * lost to widening.
+	 *   @func: The function.
+	 */
+	void Run(llvm::Function &func) {
+		std::vector<llvm::BasicBlock *> order;
+		std::map<const llvm::BasicBlock *, uint32_t> index, visits;
+		std::set<const llvm::BasicBlock *> headers;
+		std::set<uint32_t> work;
+
+		dom.reset(new llvm::DominatorTree(func));
+		edges.clear();
+		assumes.clear();
+		Seed(func);
+		Slots(func);
+
+		uint32_t count = func.arg_size();
+
+		for(llvm::BasicBlock *block : llvm::ReversePostOrderTraversal<llvm::Function *>(&func)) {
+			index[block] = order.size();
+			order.push_back(block);
+			count += block->size();
+		}
+
+		map.Reserve(count);
+
+		for(llvm::BasicBlock *block : order) {
+			for(llvm::BasicBlock *succ : llvm::successors(block)) {
+				if(index[succ] <= index[block])
+					headers.insert(succ);
+			}
+
+			work.insert(index[block]);
+		}
+
+		while(!work.empty()) {
+			llvm::BasicBlock *block = order[*work.begin()];
+			work.erase(work.begin());
+
+			uint32_t visit = visits[block]++;
+			bool widen = (headers.count(block) > 0) && (visit >= 2);
+
+			for(llvm::Instruction &inst : *block) {
+				const Range *prev = map.Find(&inst);
+				auto slot = slots.find(&inst);
+
+				Proc(inst);
+
+				if((prev != nullptr) && ((widen && llvm::isa<llvm::PHINode>(inst)) || ((visit >= 2) && (slot != slots.end()) && llvm::isa<llvm::LoadInst>(inst))))
+					Put(&inst, Range::Widen(*prev, map.Get(&inst), GetInfo(inst).type));
+
+				if((prev != nullptr) && (prev == map.Find(&inst)))
+					continue;
+
+				if((slot != slots.end()) && llvm::isa<llvm::StoreInst>(inst)) {
+					for(const llvm::LoadInst *load : loads[slot->second]) {
+						auto iter = index.find(load->getParent());
+						if(iter != index.end())
+							work.insert(iter->second);
+					}
+				}
+
+				for(const llvm::User *user : inst.users()) {
+					const llvm::Instruction *use = llvm::dyn_cast<llvm::Instruction>(user);
+					if((use == nullptr) || ((use->getParent() == block) && !llvm::isa<llvm::PHINode>(use)))
+						continue;
+
+					auto iter = index.find(use->getParent());
+					if(iter != index.end())
+						work.insert(iter->second);
+				}
+			}
+
+			std::vector<llvm::BasicBlock *> roots;
+
+			if(Assume(block))
+				roots.push_back(block);
+
+			if(Refine(block)) {
+				for(llvm::BasicBlock *succ : llvm::successors(block))
+					roots.push_back(succ);
+			}
+
+			for(llvm::BasicBlock *root : roots) {
+				for(llvm::BasicBlock *cur : order) {
+					if(!dom->dominates(root, cur))
+						continue;
+
+					work.insert(index[cur]);
+					for(llvm::BasicBlock *next : llvm::successors(cur))
+						work.insert(index[next]);
+				}
+			}
+		}
+
+		for(uint32_t i = 0; i < 2; i++) {
+			for(llvm::BasicBlock *block : order) {
+				for(llvm::Instruction &inst : *block)
+					Proc(inst);
+
+				Assume(block);
+				Refine(block);
+			}
+		}
+	}
+
+	/**
+	 * Join the ranges of the values returned by a function.
+	 *   @func: The function.
+	 *   &returns: The range, or unknown if nothing is returned.
+	 */
+	Range Return(llvm::Function const& func) {
+		bool first = true;
+		Range res;
+
+		for(const llvm::BasicBlock &block : func) {
+			const llvm::ReturnInst *ret = llvm::dyn_cast<llvm::ReturnInst>(block.getTerminator());
+			if((ret == nullptr) || (ret->getReturnValue() == nullptr))
+				continue;
+
+			Range range = Lookup(ret->getReturnValue(), &block);
+			res = first ? range : Range::Union(res, range, GetType(*ret->getReturnValue()));
+			first = false;
+		}
+
+		return res;
 	}
 
 	/**
@@ -330,9 +1163,9 @@ public:
 				inst.print(llvm::outs());
 				std::cout << "\n";
 
-				auto fact = map.find(&inst);
-				if(fact != map.end())
-					printf("    %s\n", fact->second.Str().data());
+				const Range *fact = map.Find(&inst);
+				if(fact != nullptr)
+					printf("    %s\n", fact->Str().data());
 				else
 					printf("    missing\n");
 			}
@@ -346,17 +1179,34 @@ public:
 	 *   &returns: The operation.
 	 */
 	static Type GetType(llvm::Value const& val) {
-		if(val.getType()->isFloatTy())
+		return GetType(*val.getType());
+	}
+
+	/**
+	 * Retrieve the range type for an LLVM type.
+	 *   @type: The LLVM type.
+	 *   &returns: The type.
+	 */
+	static Type GetType(llvm::Type const& type) {
+		if(type.isFloatTy())
 			return Type(Kind::Flt, 32);
-		else if(val.getType()->isDoubleTy())
+		else if(type.isDoubleTy())
 			return Type(Kind::Flt, 64);
-		else if(val.getType()->isVectorTy()) {
-			uint32_t cnt = val.getType()->getVectorNumElements();
-
-			if(val.getType()->getScalarType()->isFloatTy())
+		else if(type.isIntegerTy(32))
+			return Type(Kind::Int, 32);
+		else if(type.isIntegerTy(64))
+			return Type(Kind::Int, 64);
+		else if(type.isVectorTy()) {
+			uint32_t cnt = type.getVectorNumElements();
+
+			if(type.getScalarType()->isFloatTy())
 				return Type(Kind::Flt, 32, cnt);
-			else if(val.getType()->getScalarType()->isDoubleTy())
+			else if(type.getScalarType()->isDoubleTy())
 				return Type(Kind::Flt, 64, cnt);
+			else if(type.getScalarType()->isIntegerTy(32))
+				return Type(Kind::Int, 32, cnt);
+			else if(type.getScalarType()->isIntegerTy(64))
+				return Type(Kind::Int, 64, cnt);
 			else
 				return Type();
 		}
@@ -395,13 +1245,42 @@ public:
 		case llvm::Instruction::Select:
 			return Op::Select;
 
+		case llvm::Instruction::Add:
+			return Op::IAdd;
+
+		case llvm::Instruction::Sub:
+			return Op::ISub;
+
+		case llvm::Instruction::Shl:
+			return Op::Shl;
+
+		case llvm::Instruction::LShr:
+			return Op::LShr;
+
+		case llvm::Instruction::Trunc:
+		case llvm::Instruction::ZExt:
+			{
+				Type src = GetType(*inst.getOperand(0)), dst = GetType(inst);
+
+				if((src.kind == Kind::Int) && (dst.kind == Kind::Int) && (src.count == dst.count) && (src.width != dst.width))
+					return Op::Cast;
+				else
+					return Op::Unk;
+			}
+
 		case llvm::Instruction::BitCast:
-			if(inst.getType()->isIntegerTy(64) && inst.getOperand(0)->getType()->isDoubleTy())
-				return Op::FtoI;
-			else if(inst.getType()->isDoubleTy() && inst.getOperand(0)->getType()->isIntegerTy(64))
-				return Op::ItoF;
-			else
-				return Op::Unk;
+			{
+				Type src = GetType(*inst.getOperand(0)), dst = GetType(inst);
+
+				if((src.width != dst.width) || (src.count != dst.count))
+					return Op::Unk;
+				else if((src.kind == Kind::Flt) && (dst.kind == Kind::Int))
+					return Op::FtoI;
+				else if((src.kind == Kind::Int) && (dst.kind == Kind::Flt))
+					return Op::ItoF;
+				else
+					return Op::Unk;
+			}
 
 		case llvm::Instruction::FCmp:
 			switch(llvm::cast<llvm::FCmpInst>(&inst)->getPredicate()) {
@@ -414,6 +1293,15 @@ public:
 		case llvm::Instruction::InsertElement:
 			return Op::Insert;
 
+		case llvm::Instruction::PHI:
+			return Op::Phi;
+
+		case llvm::Instruction::Load:
+			return Op::Load;
+
+		case llvm::Instruction::Store:
+			return Op::Store;
+
 		case llvm::Instruction::ExtractElement:
 			return Op::Extract;
 
@@ -429,7 +1317,7 @@ public:
 				else if(call->getCalledFunction()->getName().startswith("llvm.sqrt."))
 					return Op::Sqrt;
 				else
-					return Op::Unk;
+					return Op::Call;
 			}
 			break;
 
@@ -86,6 +86,27 @@ public:
 	static RangeBool Xor(RangeBool const& lhs, RangeBool const& rhs) {
 		return RangeBool((lhs.istrue && rhs.isfalse) || (lhs.isfalse && rhs.istrue), (lhs.istrue && rhs.istrue) || (lhs.isfalse && rhs.isfalse));
 	}
+
+
+	/**
+	 * Join two boolean ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
+	 */
+	static RangeBool Union(RangeBool const& lhs, RangeBool const& rhs) {
+		return RangeBool(lhs.istrue || rhs.istrue, lhs.isfalse || rhs.isfalse);
+	}
+
+	/**
+	 * Check if two boolean ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeBool const& lhs, RangeBool const& rhs) {
+		return (lhs.istrue == rhs.istrue) && (lhs.isfalse == rhs.isfalse);
+	}
 };
 
 /*
@@ -140,6 +161,19 @@ public:
 		return std::string("<" + ret + ">");
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t hash = scalars.size();
+
+		for(auto const& scalar : scalars)
+			hash = hash * 31 + scalar.istrue * 2 + scalar.isfalse;
+
+		return hash;
+	}
+
 
 	/**
 	 * And two boolean ranges together.
@@ -191,6 +225,42 @@ public:
 
 		return res;
 	}
+
+
+	/**
+	 * Join two boolean ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
+	 */
+	static RangeVecBool Union(RangeVecBool const& lhs, RangeVecBool const& rhs) {
+		assert(lhs.scalars.size() == rhs.scalars.size());
+
+		RangeVecBool res;
+
+		for(size_t i = 0; i < lhs.scalars.size(); i++)
+			res.scalars.push_back(RangeBool::Union(lhs.scalars[i], rhs.scalars[i]));
+
+		return res;
+	}
+
+	/**
+	 * Check if two boolean ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeVecBool const& lhs, RangeVecBool const& rhs) {
+		if(lhs.scalars.size() != rhs.scalars.size())
+			return false;
+
+		for(size_t i = 0; i < lhs.scalars.size(); i++) {
+			if(!RangeBool::Equal(lhs.scalars[i], rhs.scalars[i]))
+				return false;
+		}
+
+		return true;
+	}
 };
 
 
@@ -200,11 +270,11 @@ public:
 template <class T> class RangeFlt {
 public:
 	bool nan;
-	std::vector<IvalFlt<T>> ivals;
+	IvalSet<T> ivals;
 
 	RangeFlt(bool _nan) { nan = _nan; }
-	RangeFlt(IvalFlt<T> const& ival, bool _nan) { ivals.push_back(ival); nan = _nan; }
-	RangeFlt(std::vector<IvalFlt<T>> const& _ivals, bool _nan) { ivals = _ivals; nan = _nan; }
+	RangeFlt(IvalFlt<T> const& ival, bool _nan) { ivals.Insert(ival); nan = _nan; }
+	RangeFlt(IvalSet<T> const& _ivals, bool _nan) { ivals = _ivals; nan = _nan; }
 	~RangeFlt() { }
 
 
@@ -297,6 +367,47 @@ public:
 		return max;
 	}
 
+	/**
+	 * Retrieve the smallest least significant bit of the range.
+	 *   &returns: The least significant bit.
+	 */
+	int Lsb() const {
+		int lsb = std::numeric_limits<int>::max();
+
+		for(auto const &ival : ivals)
+			lsb = std::min(lsb, ival.lsb);
+
+		return lsb;
+	}
+
+	/**
+	 * Compute the hull of the negative or positive part of the range.
+	 *   @neg: Use the negative part if true, the positive part otherwise.
+	 *   @lo: Output. The lower bound.
+	 *   @hi: Output. The upper bound.
+	 *   &returns: True if the part is non-empty.
+	 */
+	bool Hull(bool neg, T *lo, T *hi) const {
+		bool found = false;
+
+		for(auto const &ival : ivals) {
+			T a, b;
+
+			if(neg && fp_lte<T>(ival.lo, -0.0))
+				a = ival.lo, b = fp_min<T>(ival.hi, -0.0);
+			else if(!neg && fp_gte<T>(ival.hi, 0.0))
+				a = fp_max<T>(ival.lo, 0.0), b = ival.hi;
+			else
+				continue;
+
+			*lo = found ? fp_min<T>(*lo, a) : a;
+			*hi = found ? fp_max<T>(*hi, b) : b;
+			found = true;
+		}
+
+		return found;
+	}
+
 	/**
 	 * Compute a 64-bit range below a bound.
 	 *   @bound: The bound.
@@ -307,8 +418,10 @@ public:
 		RangeFlt res(nan);
 
 		for(auto const &ival : ivals) {
-			if(ival.lo < bound)
-				res.ivals.push_back(IvalFlt<T>(ival.lo, std::fmin(ival.hi, bound)));
+			if(ival.lo <= bound) {
+				T hi = std::fmin(ival.hi, bound);
+				res.ivals.Insert(IvalFlt<T>(ival.lo, hi, std::max<int>(ival.lsb, fp_lsb2<T>(ival.lo, hi))));
+			}
 		}
 
 		return res;
@@ -324,8 +437,10 @@ public:
 		RangeFlt res(nan);
 
 		for(auto const &ival : ivals) {
-			if(ival.hi > bound)
-				res.ivals.push_back(IvalFlt<T>(std::fmax(ival.lo, bound), ival.hi));
+			if(ival.hi >= bound) {
+				T lo = std::fmax(ival.lo, bound);
+				res.ivals.Insert(IvalFlt<T>(lo, ival.hi, std::max<int>(ival.lsb, fp_lsb2<T>(lo, ival.hi))));
+			}
 		}
 
 		return res;
@@ -340,10 +455,10 @@ public:
 
 		for(auto const &ival : ivals) {
 			if(fp_lte<T>(ival.hi, -0.0) || fp_gte<T>(ival.lo, 0.0))
-				res.ivals.push_back(IvalFlt<T>(T(1.0) / ival.hi, T(1.0) / ival.lo));
+				res.ivals.Insert(IvalFlt<T>(T(1.0) / ival.hi, T(1.0) / ival.lo));
 			else {
-				res.ivals.push_back(IvalFlt<T>(-INFINITY, T(1.0) / ival.lo));
-				res.ivals.push_back(IvalFlt<T>(T(1.0) / ival.hi, INFINITY));
+				res.ivals.Insert(IvalFlt<T>(-INFINITY, T(1.0) / ival.lo));
+				res.ivals.Insert(IvalFlt<T>(T(1.0) / ival.hi, INFINITY));
 			}
 		}
 
@@ -359,7 +474,7 @@ public:
 		RangeFlt res(nan);
 
 		for(auto const &ival : ivals)
-			res.ivals.push_back(ival.Protect(min));
+			res.ivals.Insert(ival.Protect(min));
 
 		return res;
 	}
@@ -370,21 +485,11 @@ public:
 	 *   &returns: The comapcted range.
 	 */
 	RangeFlt Compact(uint32_t cap) const {
-		if(ivals.size() > cap) {
-			RangeFlt res(nan);
-			T lo = INFINITY, hi = -INFINITY;
-
-			for(auto const &ival : ivals) {
-				lo = std::min<T>(lo, ival.lo);
-				hi = std::max<T>(hi, ival.lo);
-			}
+		RangeFlt res(*this);
 
-			res.ivals.push_back(IvalFlt<T>(lo, hi));
+		res.ivals.Reduce(cap);
 
-			return res;
-		}
-		else
-			return *this;
+		return res;
 	}
 
 	/**
@@ -406,6 +511,19 @@ public:
 		return ret;
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t hash = nan;
+
+		for(auto const& ival : ivals)
+			hash = ((hash * 31 + std::hash<T>()(ival.lo)) * 31 + std::hash<T>()(ival.hi)) * 31 + ival.lsb;
+
+		return hash;
+	}
+
 
 	/**
 	 * Create an undefined range.
@@ -441,7 +559,7 @@ public:
 		RangeFlt<T> res(in.nan);
 
 		for(auto &ival : in.ivals)
-			res.ivals.push_back(IvalFlt<T>::Abs(ival));
+			res.ivals.Insert(IvalFlt<T>::Abs(ival));
 
 		return res;
 	}
@@ -463,7 +581,7 @@ public:
 			}
 
 			if(ival.hi >= -0.0)
-				res.ivals.push_back(IvalFlt<T>(std::sqrt(lo), std::sqrt(ival.hi)));
+				res.ivals.Insert(IvalFlt<T>(std::sqrt(lo), std::sqrt(ival.hi)));
 		}
 
 		return res;
@@ -482,9 +600,11 @@ public:
 		res.nan |= lhs.Contains(-INFINITY) && rhs.Contains(INFINITY);
 		res.nan |= lhs.Contains(INFINITY) && rhs.Contains(-INFINITY);
 
+		FpRound round;
+
 		for(auto &x : lhs.ivals) {
 			for(auto &y: rhs.ivals)
-				res.ivals.push_back(IvalFlt<T>::Add(x, y));
+				res.ivals.Insert(IvalFlt<T>::Add(x, y));
 		}
 
 		return res;
@@ -502,9 +622,11 @@ public:
 		res.nan |= lhs.Contains(INFINITY) && rhs.Contains(INFINITY);
 		res.nan |= lhs.Contains(-INFINITY) && rhs.Contains(-INFINITY);
 
+		FpRound round;
+
 		for(auto &x : lhs.ivals) {
 			for(auto &y: rhs.ivals)
-				res.ivals.push_back(IvalFlt<T>::Sub(x, y));
+				res.ivals.Insert(IvalFlt<T>::Sub(x, y));
 		}
 
 		return res;
@@ -522,9 +644,11 @@ public:
 		res.nan |= (lhs.Contains(INFINITY) || lhs.Contains(-INFINITY)) && (rhs.Contains(0.0) || rhs.Contains(-0.0));
 		res.nan |= (lhs.Contains(0.0) || lhs.Contains(-0.0)) && (rhs.Contains(INFINITY) || rhs.Contains(-INFINITY));
 
+		FpRound round;
+
 		for(auto &x : lhs.ivals) {
 			for(auto &y: rhs.ivals)
-				res.ivals.push_back(IvalFlt<T>::Mul(x, y));
+				res.ivals.Insert(IvalFlt<T>::Mul(x, y));
 		}
 
 		return res;
@@ -616,17 +740,93 @@ public:
 		if(cond.istrue) {
 			res.nan |= lhs.nan;
 			for(auto const& ival: lhs.ivals)
-				res.ivals.push_back(IvalFlt<T>(ival));
+				res.ivals.Insert(IvalFlt<T>(ival));
 		}
 
 		if(cond.isfalse) {
 			res.nan |= rhs.nan;
 			for(auto const& ival: rhs.ivals)
-				res.ivals.push_back(IvalFlt<T>(ival));
+				res.ivals.Insert(IvalFlt<T>(ival));
+		}
+
+		return res;
+	}
+
+
+	/**
+	 * Join two floating-point ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
+	 */
+	static RangeFlt Union(RangeFlt const& lhs, RangeFlt const& rhs) {
+		RangeFlt<T> res(lhs.ivals, lhs.nan || rhs.nan);
+
+		for(auto const& ival : rhs.ivals)
+			res.ivals.Insert(ival);
+
+		return res;
+	}
+
+	/**
+	 * Widen a range to guarantee termination at loop headers. Each sign is
+	 * reduced to its hull; a bound that grew since the previous iteration
+	 * jumps to infinity (away from zero) or to zero (towards zero), and a
+	 * shrinking least significant bit drops to the subnormal limit.
+	 *   @prev: The range from the previous iteration.
+	 *   @next: The range from the current iteration.
+	 *   &returns: The widened range.
+	 */
+	static RangeFlt Widen(RangeFlt const& prev, RangeFlt const& next) {
+		if(prev.IsUndef())
+			return next;
+
+		RangeFlt<T> res(prev.nan || next.nan);
+		int lsb = std::min(prev.Lsb(), next.Lsb());
+
+		if(next.Lsb() < prev.Lsb())
+			lsb = fp_lsb<T>(fp_next<T>(0.0));
+
+		for(bool neg : { true, false }) {
+			T plo, phi, nlo, nhi;
+			bool pany = prev.Hull(neg, &plo, &phi);
+			bool nany = next.Hull(neg, &nlo, &nhi);
+
+			if(!pany && !nany)
+				continue;
+			else if(!pany)
+				plo = nlo, phi = nhi;
+			else if(nany) {
+				if(nlo < plo)
+					plo = neg ? -INFINITY : 0.0;
+
+				if(nhi > phi)
+					phi = neg ? -0.0 : INFINITY;
+			}
+
+			res.ivals.Insert(IvalFlt<T>(plo, phi, lsb));
 		}
 
 		return res;
 	}
+
+	/**
+	 * Check if two floating-point ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeFlt const& lhs, RangeFlt const& rhs) {
+		if((lhs.nan != rhs.nan) || (lhs.ivals.size() != rhs.ivals.size()))
+			return false;
+
+		for(size_t i = 0; i < lhs.ivals.size(); i++) {
+			if(!IvalFlt<T>::Equal(lhs.ivals[i], rhs.ivals[i]))
+				return false;
+		}
+
+		return true;
+	}
 };
 
 /*
@@ -634,14 +834,78 @@ public:
  */
 template <class T> class RangeVecFlt {
 public:
+	/**
+	 * The number of lanes. A uniform range, where all lanes are equal,
+	 * stores a single scalar for all of them.
+	 */
+	uint32_t width;
 	std::vector<RangeFlt<T>> scalars;
 
-	RangeVecFlt() { }
-	RangeVecFlt(RangeFlt<T> scalar) { scalars.push_back(scalar); }
-	RangeVecFlt(std::vector<RangeFlt<T>> _scalars) { scalars = _scalars; }
+	RangeVecFlt() { width = 0; }
+	RangeVecFlt(RangeFlt<T> scalar) { scalars.push_back(scalar); width = 1; }
+	RangeVecFlt(RangeFlt<T> scalar, uint32_t _width) { scalars.push_back(scalar); width = _width; }
+	RangeVecFlt(std::vector<RangeFlt<T>> _scalars) { scalars = _scalars; width = scalars.size(); }
 	~RangeVecFlt() { }
 
-	bool HasSubnorm() const;
+	/**
+	 * Check if all lanes share a single scalar.
+	 *   &returns: True if uniform.
+	 */
+	bool IsUniform() const {
+		return scalars.size() == 1;
+	}
+
+	/**
+	 * Retrieve the range of a lane.
+	 *   @i: The lane index.
+	 *   &returns: The scalar range.
+	 */
+	RangeFlt<T> const& Lane(uint32_t i) const {
+		return scalars[IsUniform() ? 0 : i];
+	}
+
+	/**
+	 * Append a lane.
+	 *   @scalar: The scalar range.
+	 */
+	void Push(RangeFlt<T> const& scalar) {
+		scalars.push_back(scalar);
+		width++;
+	}
+
+	/**
+	 * Store one scalar per lane, so that a single lane can be replaced.
+	 */
+	void Expand() {
+		if(IsUniform() && (width > 1))
+			scalars.assign(width, scalars[0]);
+	}
+
+	/**
+	 * Share a single scalar if all lanes are equal.
+	 */
+	void Pack() {
+		for(uint32_t i = 1; i < scalars.size(); i++) {
+			if(!RangeFlt<T>::Equal(scalars[0], scalars[i]))
+				return;
+		}
+
+		if(scalars.size() > 1)
+			scalars.erase(scalars.begin() + 1, scalars.end());
+	}
+
+	/**
+	 * Check if any lane contains subnormal numbers.
+	 *   &returns: True if any lane may contain subnormals.
+	 */
+	bool HasSubnorm() const {
+		for(auto const& range : scalars) {
+			if(range.HasSubnorm())
+				return true;
+		}
+
+		return false;
+	}
 
 	/**
 	 * Check if a range is safe.
@@ -663,12 +927,7 @@ public:
 	 *   &returns: The removed range.
 	 */
 	RangeVecFlt Protect(T min) const {
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < scalars.size(); i++)
-			res.scalars.push_back(scalars[i].Protect(min));
-
-		return res;
+		return Map(*this, [min](RangeFlt<T> const& in) { return in.Protect(min); });
 	}
 
 	/**
@@ -677,12 +936,7 @@ public:
 	 *   &returns: The comapcted range.
 	 */
 	RangeVecFlt Compact(uint32_t cap) const {
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < scalars.size(); i++)
-			res.scalars.push_back(scalars[i].Compact(cap));
-
-		return res;
+		return Map(*this, [cap](RangeFlt<T> const& in) { return in.Compact(cap); });
 	}
 
 	/**
@@ -690,50 +944,94 @@ public:
 	 *   &returns: The string.
 	 */
 	std::string Str() const {
-		if(scalars.size() == 1)
+		if(width == 1)
 			return scalars[0].Str();
 
 		std::string ret;
 
-		for(auto const& scalar : scalars)
-			ret += ((ret.size() > 0) ? ", " : "") + scalar.Str();
+		for(uint32_t i = 0; i < width; i++)
+			ret += ((ret.size() > 0) ? ", " : "") + Lane(i).Str();
 
 		return std::string("<" + ret + ">");
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t lane = 0, hash = width;
+
+		for(uint32_t i = 0; i < width; i++) {
+			if((i == 0) || !IsUniform())
+				lane = Lane(i).Hash();
+
+			hash = hash * 31 + lane;
+		}
+
+		return hash;
+	}
+
 
-	static RangeVecFlt Undef(uint32_t width) { RangeVecFlt res; for(uint32_t i = 0; i < width; i++) res.scalars.push_back(RangeFlt<T>::Undef()); return res; }
-	static RangeVecFlt All(uint32_t width) { RangeVecFlt res; for(uint32_t i = 0; i < width; i++) res.scalars.push_back(RangeFlt<T>::All()); return res; }
-	static RangeVecFlt Const(T val, uint32_t width) { RangeVecFlt res; for(uint32_t i = 0; i < width; i++) res.scalars.push_back(RangeFlt<T>::Const(val)); return res; }
+	static RangeVecFlt Undef(uint32_t width) { return RangeVecFlt(RangeFlt<T>::Undef(), width); }
+	static RangeVecFlt All(uint32_t width) { return RangeVecFlt(RangeFlt<T>::All(), width); }
+	static RangeVecFlt Const(T val, uint32_t width) { return RangeVecFlt(RangeFlt<T>::Const(val), width); }
 
 	/**
-	 * Absolute value of floating-point ranges.
+	 * Apply a scalar operation to every lane of a range. Uniform ranges are
+	 * computed once.
 	 *   @in: The input range.
+	 *   @func: The scalar operation.
 	 *   &returns: The result range.
 	 */
-	static RangeVecFlt<T> Abs(RangeVecFlt<T> const& in) {
+	template <class F> static RangeVecFlt Map(RangeVecFlt<T> const& in, F func) {
 		RangeVecFlt<T> res;
 
-		for(uint32_t i = 0; i < in.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Abs(in.scalars[i]));
+		res.width = in.width;
+		for(auto const& scalar : in.scalars)
+			res.scalars.push_back(func(scalar));
 
 		return res;
 	}
 
 	/**
-	 * Square root of floating-point ranges.
-	 *   @in: The input range.
+	 * Apply a scalar operation to every pair of lanes of two ranges. The
+	 * result is uniform if both inputs are.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   @func: The scalar operation.
 	 *   &returns: The result range.
 	 */
-	static RangeVecFlt<T> Sqrt(RangeVecFlt<T> const& in) {
+	template <class F> static RangeVecFlt Map(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs, F func) {
+		assert(lhs.width == rhs.width);
+
 		RangeVecFlt<T> res;
 
-		for(uint32_t i = 0; i < in.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Sqrt(in.scalars[i]));
+		res.width = lhs.width;
+		for(uint32_t i = 0; i < ((lhs.IsUniform() && rhs.IsUniform()) ? 1 : lhs.width); i++)
+			res.scalars.push_back(func(lhs.Lane(i), rhs.Lane(i)));
 
 		return res;
 	}
 
+	/**
+	 * Absolute value of floating-point ranges.
+	 *   @in: The input range.
+	 *   &returns: The result range.
+	 */
+	static RangeVecFlt<T> Abs(RangeVecFlt<T> const& in) {
+		return Map(in, RangeFlt<T>::Abs);
+	}
+
+	/**
+	 * Square root of floating-point ranges.
+	 *   @in: The input range.
+	 *   &returns: The result range.
+	 */
+	static RangeVecFlt<T> Sqrt(RangeVecFlt<T> const& in) {
+		return Map(in, RangeFlt<T>::Sqrt);
+	}
+
 	/**
 	 * Add two floating-point ranges together.
 	 *   @lhs: The left-hand side.
@@ -741,14 +1039,7 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecFlt<T> Add(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
-
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Add(lhs.scalars[i], rhs.scalars[i]));
-
-		return res;
+		return Map(lhs, rhs, RangeFlt<T>::Add);
 	}
 
 	/**
@@ -758,14 +1049,7 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecFlt<T> Sub(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
-
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Sub(lhs.scalars[i], rhs.scalars[i]));
-
-		return res;
+		return Map(lhs, rhs, RangeFlt<T>::Sub);
 	}
 
 	/**
@@ -775,14 +1059,7 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecFlt<T> Mul(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
-
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Mul(lhs.scalars[i], rhs.scalars[i]));
-
-		return res;
+		return Map(lhs, rhs, RangeFlt<T>::Mul);
 	}
 
 	/**
@@ -792,14 +1069,7 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecFlt<T> Div(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
-
-		RangeVecFlt<T> res;
-
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::Div(lhs.scalars[i], rhs.scalars[i]));
-
-		return res;
+		return Map(lhs, rhs, RangeFlt<T>::Div);
 	}
 
 
@@ -810,12 +1080,12 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecBool CmpOLT(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
+		assert(lhs.width == rhs.width);
 
 		RangeVecBool res;
 
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::CmpOLT(lhs.scalars[i], rhs.scalars[i]));
+		for(uint32_t i = 0; i < lhs.width; i++)
+			res.scalars.push_back(RangeFlt<T>::CmpOLT(lhs.Lane(i), rhs.Lane(i)));
 
 		return res;
 	}
@@ -827,12 +1097,12 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecBool CmpOGT(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
+		assert(lhs.width == rhs.width);
 
 		RangeVecBool res;
 
-		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-			res.scalars.push_back(RangeFlt<T>::CmpOGT(lhs.scalars[i], rhs.scalars[i]));
+		for(uint32_t i = 0; i < lhs.width; i++)
+			res.scalars.push_back(RangeFlt<T>::CmpOGT(lhs.Lane(i), rhs.Lane(i)));
 
 		return res;
 	}
@@ -845,62 +1115,275 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeVecFlt Select(RangeVecBool const& cond, RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
-		assert(lhs.scalars.size() == rhs.scalars.size());
+		assert(lhs.width == rhs.width);
 
-		RangeVecFlt<T> res;
+		if(cond.scalars.size() == 1)
+			return Map(lhs, rhs, [&cond](RangeFlt<T> const& a, RangeFlt<T> const& b) { return RangeFlt<T>::Select(cond.scalars[0], a, b); });
 
-		if(cond.scalars.size() == 1) {
-			for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-				res.scalars.push_back(RangeFlt<T>::Select(cond.scalars[0], lhs.scalars[i], rhs.scalars[i]));
-		}
-		else {
-			assert(cond.scalars.size() == lhs.scalars.size());
-			assert(cond.scalars.size() == rhs.scalars.size());
+		assert(cond.scalars.size() == lhs.width);
 
-			for(uint32_t i = 0; i < lhs.scalars.size(); i++)
-				res.scalars.push_back(RangeFlt<T>::Select(cond.scalars[i], lhs.scalars[i], rhs.scalars[i]));
-		}
+		RangeVecFlt<T> res;
+
+		for(uint32_t i = 0; i < lhs.width; i++)
+			res.Push(RangeFlt<T>::Select(cond.scalars[i], lhs.Lane(i), rhs.Lane(i)));
 
 		return res;
 	}
-};
-
-
-/*
- * integer range class
- */
-template <class T> class RangeInt {
-public:
-	std::vector<IvalInt<T>> ivals;
 
-	RangeInt() { }
-	RangeInt(IvalInt<T> const& ival) { ivals.push_back(ival); }
-	~RangeInt() { }
 
 	/**
-	 * Check if a range is undefined.
-	 *   &returns: True if undefined.
+	 * Join two floating-point, vector ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
 	 */
-	bool IsUndef() const {
-		return ivals.size() == 0;
+	static RangeVecFlt Union(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
+		return Map(lhs, rhs, RangeFlt<T>::Union);
 	}
 
 	/**
-	 * Convert a range to a string.
-	 *   &returns: The string.
+	 * Widen floating-point, vector ranges.
+	 *   @prev: The range from the previous iteration.
+	 *   @next: The range from the current iteration.
+	 *   &returns: The widened range.
 	 */
-	std::string Str() const {
-		std::string ret;
-
-		if(IsUndef())
-			return "Undef";
+	static RangeVecFlt Widen(RangeVecFlt<T> const& prev, RangeVecFlt<T> const& next) {
+		return Map(prev, next, RangeFlt<T>::Widen);
+	}
+
+	/**
+	 * Check if two floating-point, vector ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeVecFlt<T> const& lhs, RangeVecFlt<T> const& rhs) {
+		if(lhs.width != rhs.width)
+			return false;
+
+		for(uint32_t i = 0; i < ((lhs.IsUniform() && rhs.IsUniform()) ? 1 : lhs.width); i++) {
+			if(!RangeFlt<T>::Equal(lhs.Lane(i), rhs.Lane(i)))
+				return false;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Restrict a floating-point, vector range to the values below the upper
+	 * bound of another, lane by lane. Lanes with no bound are left as-is.
+	 *   @in: The input range.
+	 *   @bound: The bounding range.
+	 *   @nan: Keep NaN if the input may be NaN.
+	 *   &returns: The restricted range.
+	 */
+	static RangeVecFlt Below(RangeVecFlt<T> const& in, RangeVecFlt<T> const& bound, bool nan) {
+		return Map(in, bound, [nan](RangeFlt<T> const& lane, RangeFlt<T> const& limit) {
+			if(limit.ivals.empty())
+				return RangeFlt<T>(lane.ivals, lane.nan && nan);
+			else
+				return lane.Below(limit.Upper(), lane.nan && nan);
+		});
+	}
+
+	/**
+	 * Restrict a floating-point, vector range to the values above the lower
+	 * bound of another, lane by lane. Lanes with no bound are left as-is.
+	 *   @in: The input range.
+	 *   @bound: The bounding range.
+	 *   @nan: Keep NaN if the input may be NaN.
+	 *   &returns: The restricted range.
+	 */
+	static RangeVecFlt Above(RangeVecFlt<T> const& in, RangeVecFlt<T> const& bound, bool nan) {
+		return Map(in, bound, [nan](RangeFlt<T> const& lane, RangeFlt<T> const& limit) {
+			if(limit.ivals.empty())
+				return RangeFlt<T>(lane.ivals, lane.nan && nan);
+			else
+				return lane.Above(limit.Lower(), lane.nan && nan);
+		});
+	}
+
+	/**
+	 * Restrict a floating-point, vector range to an interval, lane by lane.
+	 * The result excludes NaN.
+	 *   @in: The input range.
+	 *   @lo: The lower bound.
+	 *   @hi: The upper bound.
+	 *   &returns: The restricted range.
+	 */
+	static RangeVecFlt Clamp(RangeVecFlt<T> const& in, T lo, T hi) {
+		return Map(in, [lo, hi](RangeFlt<T> const& lane) { return lane.Above(lo, false).Below(hi, false); });
+	}
+
+	/**
+	 * Restrict a floating-point, vector range to the values whose magnitude
+	 * lies within the hull of another range, lane by lane.
+	 *   @in: The input range.
+	 *   @abs: The range of the magnitude.
+	 *   &returns: The restricted range.
+	 */
+	static RangeVecFlt InvAbs(RangeVecFlt<T> const& in, RangeVecFlt<T> const& abs) {
+		return Map(in, abs, [](RangeFlt<T> const& lane, RangeFlt<T> const& mag) {
+			bool nan = lane.nan && mag.nan;
+
+			if(mag.ivals.empty())
+				return RangeFlt<T>(lane.ivals, nan);
+
+			T lo = mag.Lower(), hi = mag.Upper();
+			RangeFlt<T> neg = lane.Below(-lo, nan).Above(-hi, nan);
+			RangeFlt<T> pos = lane.Above(lo, nan).Below(hi, nan);
+
+			return RangeFlt<T>::Union(neg, pos);
+		});
+	}
+};
+
+
+/*
+ * integer range class
+ *   A set of sorted, disjoint intervals, further restricted by masks of the
+ *   bits known to be zero and known to be one in every value. The masks
+ *   carry what the intervals cannot, such as the exponent written into a
+ *   float by `frexp` or the low word cleared by `SET_LOW_WORD`.
+ */
+template <class T> class RangeInt {
+public:
+	static const uint32_t Max = 16;
+
+	std::vector<IvalInt<T>> ivals;
+	T zeros, ones;
+
+	RangeInt() { zeros = 0; ones = 0; }
+	RangeInt(IvalInt<T> const& ival) { ivals.push_back(ival); zeros = 0; ones = 0; Norm(); }
+	~RangeInt() { }
+
+	/**
+	 * Check if a range is undefined.
+	 *   &returns: True if undefined.
+	 */
+	bool IsUndef() const {
+		return ivals.size() == 0;
+	}
+
+	/**
+	 * Check if a range contains a value.
+	 *   @val: The value.
+	 *   &returns: True if the value is in the range.
+	 */
+	bool Contains(T val) const {
+		if(((val & zeros) != 0) || ((~val & ones) != 0))
+			return false;
+
+		for(auto const& ival : ivals) {
+			if((val >= ival.lo) && (val <= ival.hi))
+				return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Retrieve the number of low bits that are all known.
+	 *   &returns: The number of bits.
+	 */
+	uint32_t Known() const {
+		T unk = ~(zeros | ones);
+
+		return (unk == 0) ? (8 * sizeof(T)) : __builtin_ctzll((uint64_t)unk);
+	}
+
+	/**
+	 * Sort and merge the intervals, bound their number, and tighten them
+	 * against the known bits. The leading bits shared by all values are
+	 * added to the known bits.
+	 */
+	void Norm() {
+		if(ivals.empty())
+			return;
+
+		std::sort(ivals.begin(), ivals.end(), [](IvalInt<T> const& a, IvalInt<T> const& b) { return a.lo < b.lo; });
+
+		size_t n = 0;
+		for(size_t i = 1; i < ivals.size(); i++) {
+			if((ivals[i].lo <= ivals[n].hi) || (ivals[i].lo - 1 == ivals[n].hi))
+				ivals[n].hi = std::max(ivals[n].hi, ivals[i].hi);
+			else
+				ivals[++n] = ivals[i];
+		}
+
+		ivals.erase(ivals.begin() + n + 1, ivals.end());
+
+		while(ivals.size() > Max) {
+			size_t min = 0;
+
+			for(size_t i = 1; i + 1 < ivals.size(); i++) {
+				if((ivals[i + 1].lo - ivals[i].hi) < (ivals[min + 1].lo - ivals[min].hi))
+					min = i;
+			}
+
+			ivals[min].hi = ivals[min + 1].hi;
+			ivals.erase(ivals.begin() + min + 1);
+		}
+
+		T pre = IvalInt<T>(ivals.front().lo, ivals.back().hi).Prefix();
+
+		zeros |= ~ivals.front().lo & pre;
+		ones |= ivals.front().lo & pre;
+
+		std::vector<IvalInt<T>> tight;
+
+		if((zeros & ones) != 0)
+			ivals.clear();
+
+		for(auto const& ival : ivals) {
+			T lo, hi;
+
+			if(Up(ival.lo, zeros, ones, &lo) && Down(ival.hi, zeros, ones, &hi) && (lo <= hi))
+				tight.push_back(IvalInt<T>(lo, hi));
+		}
+
+		ivals.swap(tight);
+
+		if(ivals.empty())
+			zeros = ones = 0;
+	}
+
+	/**
+	 * Convert a range to a string.
+	 *   &returns: The string.
+	 */
+	std::string Str() const {
+		std::string ret;
+
+		if(IsUndef())
+			return "Undef";
 
 		for(auto const& ival : ivals)
 			ret += ((ret.size() > 0) ? ", " : "") + ival.Str();
 
+		if((ivals.size() > 1) || !ivals[0].IsConst()) {
+			char str[64];
+
+			snprintf(str, sizeof(str), " (0:%lx 1:%lx)", (uint64_t)zeros, (uint64_t)ones);
+			ret += str;
+		}
+
 		return ret;
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t hash = (ivals.size() * 31 + zeros) * 31 + ones;
+
+		for(auto const& ival : ivals)
+			hash = (hash * 31 + ival.lo) * 31 + ival.hi;
+
+		return hash;
+	}
+
 
 	/**
 	 * Create a range of all intergers.
@@ -927,8 +1410,99 @@ public:
 		return RangeInt<T>(IvalInt<T>::Const(val));
 	}
 
+	/**
+	 * Create the range of all integers matching the known bits.
+	 *   @zeros: The bits known to be zero.
+	 *   @ones: The bits known to be one.
+	 *   &returns: The range.
+	 */
+	static RangeInt<T> Bits(T zeros, T ones) {
+		RangeInt<T> res;
+
+		if((zeros & ones) != 0)
+			return res;
+
+		res.ivals.push_back(IvalInt<T>(ones, ~zeros));
+		res.zeros = zeros;
+		res.ones = ones;
+		res.Norm();
+
+		return res;
+	}
+
+
+	/**
+	 * Find the smallest value not below a bound that matches the known
+	 * bits.
+	 *   @lo: The bound.
+	 *   @zeros: The bits known to be zero.
+	 *   @ones: The bits known to be one.
+	 *   @res: Output. The value.
+	 *   &returns: True if found.
+	 */
+	static bool Up(T lo, T zeros, T ones, T *res) {
+		T bad = (lo & zeros) | (~lo & ones);
+
+		if(bad == 0) {
+			*res = lo;
+			return true;
+		}
+
+		uint32_t i = 63 - __builtin_clzll((uint64_t)bad);
+		T bit = (T)1 << i, low = bit - 1;
+
+		if(lo & bit) {
+			T free = ~(lo | zeros | ones) & ~(low | bit);
+			if(free == 0)
+				return false;
+
+			bit = free & -free;
+			low = bit - 1;
+		}
+
+		*res = (lo & ~(low | bit)) | bit | (ones & low);
+
+		return true;
+	}
+
+	/**
+	 * Find the largest value not above a bound that matches the known bits.
+	 *   @hi: The bound.
+	 *   @zeros: The bits known to be zero.
+	 *   @ones: The bits known to be one.
+	 *   @res: Output. The value.
+	 *   &returns: True if found.
+	 */
+	static bool Down(T hi, T zeros, T ones, T *res) {
+		T inv;
 
-	//template <class U> static RangeInt<T> FromFlt(const RangeFlt<U> &flt);
+		if(!Up(~hi, ones, zeros, &inv))
+			return false;
+
+		*res = ~inv;
+
+		return true;
+	}
+
+	/**
+	 * Build a range from wide bounds that may have wrapped around, as the
+	 * result of an addition or subtraction.
+	 *   @lo: The wide lower bound.
+	 *   @hi: The wide upper bound.
+	 *   @res: The range to extend.
+	 */
+	template <class W> static void Wrap(W lo, W hi, RangeInt<T> &res) {
+		W size = (W)fp_ones<T>() + 1;
+
+		if(hi - lo >= size - 1)
+			res.ivals.push_back(IvalInt<T>::All());
+		else if((T)lo <= (T)hi)
+			res.ivals.push_back(IvalInt<T>((T)lo, (T)hi));
+		else {
+			res.ivals.push_back(IvalInt<T>((T)lo, fp_ones<T>()));
+			res.ivals.push_back(IvalInt<T>(0, (T)hi));
+		}
+	}
 
 
 	/**
@@ -940,26 +1514,21 @@ public:
 	static RangeInt<T> And(RangeInt const& lhs, RangeInt const& rhs) {
 		RangeInt res = RangeInt<T>::Undef();
 
+		res.zeros = lhs.zeros | rhs.zeros;
+		res.ones = lhs.ones & rhs.ones;
+
 		for(auto const &x : lhs.ivals) {
-			for(auto const &y : rhs.ivals) {
-				if(x.IsConst() && y.IsConst())
-					res.ivals.push_back(IvalInt<T>::Const(x.lo & y.lo));
-				else if(x.IsZero() || y.IsZero())
-					res.ivals.push_back(IvalInt<T>::Const(0));
-				else if(x.IsOnes())
-					res.ivals.push_back(y);
-				else if(y.IsOnes())
-					res.ivals.push_back(x);
-				else
-					res.ivals.push_back(IvalInt<T>::All());
-			}
+			for(auto const &y : rhs.ivals)
+				res.ivals.push_back(IvalInt<T>::And(x, y));
 		}
 
+		res.Norm();
+
 		return res;
 	}
 
 	/**
-	 * Or two floating-point ranges together.
+	 * Or two integer ranges together.
 	 *   @lhs: The left-hand side.
 	 *   @rhs: The right-hand side.
 	 *   &returns: The result range.
@@ -967,24 +1536,21 @@ public:
 	static RangeInt<T> Or(RangeInt const& lhs, RangeInt const& rhs) {
 		RangeInt res = RangeInt<T>::Undef();
 
+		res.zeros = lhs.zeros & rhs.zeros;
+		res.ones = lhs.ones | rhs.ones;
+
 		for(auto const &x : lhs.ivals) {
-			for(auto const &y : rhs.ivals) {
-				if(x.IsConst() && y.IsConst())
-					res.ivals.push_back(IvalInt<T>::Const(x.lo | y.lo));
-				else if(x.IsZero())
-					res.ivals.push_back(y);
-				else if(y.IsZero())
-					res.ivals.push_back(x);
-				else
-					res.ivals.push_back(IvalInt<T>::All());
-			}
+			for(auto const &y : rhs.ivals)
+				res.ivals.push_back(IvalInt<T>::Or(x, y));
 		}
 
+		res.Norm();
+
 		return res;
 	}
 
 	/**
-	 * Xor two floating-point ranges together.
+	 * Xor two integer ranges together.
 	 *   @lhs: The left-hand side.
 	 *   @rhs: The right-hand side.
 	 *   &returns: The result range.
@@ -992,18 +1558,243 @@ public:
 	static RangeInt<T> Xor(RangeInt const& lhs, RangeInt const& rhs) {
 		RangeInt res = RangeInt<T>::Undef();
 
+		res.zeros = (lhs.zeros & rhs.zeros) | (lhs.ones & rhs.ones);
+		res.ones = (lhs.zeros & rhs.ones) | (lhs.ones & rhs.zeros);
+
 		for(auto const &x : lhs.ivals) {
-			for(auto const &y : rhs.ivals) {
-				if(x.IsConst() && y.IsConst())
-					res.ivals.push_back(IvalInt<T>::Const(x.lo ^ y.lo));
-				else
+			for(auto const &y : rhs.ivals)
+				res.ivals.push_back(IvalInt<T>::Xor(x, y));
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Add two integer ranges, wrapping around. The low bits known on both
+	 * sides are known in the sum.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result range.
+	 */
+	static RangeInt<T> Add(RangeInt const& lhs, RangeInt const& rhs) {
+		using W = typename std::conditional<sizeof(T) == 4, uint64_t, unsigned __int128>::type;
+
+		RangeInt res = RangeInt<T>::Undef();
+		uint32_t known = std::min(lhs.Known(), rhs.Known());
+		T low = (known >= 8 * sizeof(T)) ? fp_ones<T>() : (((T)1 << known) - 1), sum = lhs.ones + rhs.ones;
+
+		res.zeros = ~sum & low;
+		res.ones = sum & low;
+
+		for(auto const &x : lhs.ivals) {
+			for(auto const &y : rhs.ivals)
+				Wrap<W>((W)x.lo + y.lo, (W)x.hi + y.hi, res);
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Subtract two integer ranges, wrapping around.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result range.
+	 */
+	static RangeInt<T> Sub(RangeInt const& lhs, RangeInt const& rhs) {
+		using W = typename std::conditional<sizeof(T) == 4, uint64_t, unsigned __int128>::type;
+
+		RangeInt res = RangeInt<T>::Undef();
+		uint32_t known = std::min(lhs.Known(), rhs.Known());
+		T low = (known >= 8 * sizeof(T)) ? fp_ones<T>() : (((T)1 << known) - 1), diff = lhs.ones - rhs.ones;
+		W size = (W)fp_ones<T>() + 1;
+
+		res.zeros = ~diff & low;
+		res.ones = diff & low;
+
+		for(auto const &x : lhs.ivals) {
+			for(auto const &y : rhs.ivals)
+				Wrap<W>(size + x.lo - y.hi, size + x.hi - y.lo, res);
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Shift an integer range left by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   &returns: The result range.
+	 */
+	static RangeInt<T> Shl(RangeInt const& in, uint32_t amt) {
+		if(amt >= 8 * sizeof(T))
+			return RangeInt<T>::All();
+		else if(amt == 0)
+			return in;
+
+		RangeInt res = RangeInt<T>::Undef();
+
+		res.zeros = (in.zeros << amt) | (((T)1 << amt) - 1);
+		res.ones = in.ones << amt;
+
+		for(auto const &x : in.ivals) {
+			if((x.hi >> (8 * sizeof(T) - amt)) == 0)
+				res.ivals.push_back(IvalInt<T>(x.lo << amt, x.hi << amt));
+			else
+				res.ivals.push_back(IvalInt<T>::All());
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Shift an integer range right, logically, by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   &returns: The result range.
+	 */
+	static RangeInt<T> LShr(RangeInt const& in, uint32_t amt) {
+		if(amt >= 8 * sizeof(T))
+			return RangeInt<T>::All();
+		else if(amt == 0)
+			return in;
+
+		RangeInt res = RangeInt<T>::Undef();
+
+		res.zeros = (in.zeros >> amt) | ~(fp_ones<T>() >> amt);
+		res.ones = in.ones >> amt;
+
+		for(auto const &x : in.ivals)
+			res.ivals.push_back(IvalInt<T>(x.lo >> amt, x.hi >> amt));
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Truncate or zero-extend an integer range of another width.
+	 *   @in: The input range.
+	 *   &returns: The result range.
+	 */
+	template <class U> static RangeInt<T> Cast(RangeInt<U> const& in) {
+		RangeInt res = RangeInt<T>::Undef();
+
+		if(sizeof(T) >= sizeof(U)) {
+			res.zeros = (T)in.zeros | (T)~(T)fp_ones<U>();
+			res.ones = (T)in.ones;
+
+			for(auto const &x : in.ivals)
+				res.ivals.push_back(IvalInt<T>((T)x.lo, (T)x.hi));
+		}
+		else {
+			res.zeros = (T)in.zeros;
+			res.ones = (T)in.ones;
+
+			for(auto const &x : in.ivals) {
+				if((x.hi - x.lo) >= (U)fp_ones<T>())
 					res.ivals.push_back(IvalInt<T>::All());
+				else if((T)x.lo <= (T)x.hi)
+					res.ivals.push_back(IvalInt<T>((T)x.lo, (T)x.hi));
+				else {
+					res.ivals.push_back(IvalInt<T>((T)x.lo, fp_ones<T>()));
+					res.ivals.push_back(IvalInt<T>(0, (T)x.hi));
+				}
+			}
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Reinterpret the bits of a floating-point range as integers. Each
+	 * interval maps to one interval of bit patterns per sign, and NaNs to
+	 * every NaN pattern.
+	 *   @flt: The floating-point range.
+	 *   &returns: The integer range.
+	 */
+	template <class F> static RangeInt<T> FromFlt(RangeFlt<F> const& flt) {
+		static_assert(sizeof(F) == sizeof(T), "Mismatched bitcast width.");
+
+		RangeInt res = RangeInt<T>::Undef();
+		auto bits = [](F val) { T u; memcpy(&u, &val, sizeof(T)); return u; };
+
+		if(flt.nan) {
+			res.ivals.push_back(IvalInt<T>::NanPos());
+			res.ivals.push_back(IvalInt<T>::NanNeg());
+		}
+
+		for(auto const &ival : flt.ivals) {
+			if(!std::signbit(ival.lo))
+				res.ivals.push_back(IvalInt<T>(bits(ival.lo), bits(ival.hi)));
+			else if(std::signbit(ival.hi))
+				res.ivals.push_back(IvalInt<T>(bits(ival.hi), bits(ival.lo)));
+			else {
+				res.ivals.push_back(IvalInt<T>(fp_nzero<T>(), bits(ival.lo)));
+				res.ivals.push_back(IvalInt<T>(0, bits(ival.hi)));
+			}
+		}
+
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Reinterpret the bits of an integer range as floating-point values. The
+	 * intervals are split by sign and tightened against the known bits of
+	 * the magnitude, and known trailing zero bits raise the least
+	 * significant bit of the result.
+	 *   &returns: The floating-point range.
+	 */
+	template <class F> RangeFlt<F> ToFlt() const {
+		static_assert(sizeof(F) == sizeof(T), "Mismatched bitcast width.");
+
+		RangeFlt<F> res(false);
+		auto flt = [](T u) { F val; memcpy(&val, &u, sizeof(T)); return val; };
+		T sign = fp_nzero<T>(), mag = ~sign;
+		int shift = std::min<int>((zeros == fp_ones<T>()) ? (8 * sizeof(T)) : __builtin_ctzll((uint64_t)~zeros), std::numeric_limits<F>::digits - 1);
+
+		for(auto const &ival : ivals) {
+			for(T s : { (T)0, sign }) {
+				if((s != 0) ? ((zeros & sign) != 0) : ((ones & sign) != 0))
+					continue;
+
+				T lo = std::max<T>(ival.lo, s), hi = std::min<T>(ival.hi, s | mag);
+				if(lo > hi)
+					continue;
+
+				T mlo, mhi;
+				if(!Up(lo & mag, zeros & mag, ones & mag, &mlo) || !Down(hi & mag, zeros & mag, ones & mag, &mhi) || (mlo > mhi))
+					continue;
+
+				if(mhi > fp_pinf<T>()) {
+					res.nan = true;
+
+					if((mlo > fp_pinf<T>()) || !Down(fp_pinf<T>(), zeros & mag, ones & mag, &mhi) || (mlo > mhi))
+						continue;
+				}
+
+				IvalFlt<F> out = (s != 0) ? IvalFlt<F>(-flt(mhi), -flt(mlo)) : IvalFlt<F>(flt(mlo), flt(mhi));
+
+				out.lsb += shift;
+				res.ivals.Insert(out);
 			}
 		}
 
 		return res;
 	}
 
+
 	/**
 	 * Select on integer ranges.
 	 *   @cond: The conditional.
@@ -1012,19 +1803,75 @@ public:
 	 *   &returns: The result range.
 	 */
 	static RangeInt<T> Select(RangeBool const& cond, RangeInt const& lhs, RangeInt const& rhs) {
-		RangeInt res = RangeInt<T>::Undef();
+		if(cond.istrue && cond.isfalse)
+			return Union(lhs, rhs);
+		else if(cond.istrue)
+			return lhs;
+		else if(cond.isfalse)
+			return rhs;
+		else
+			return RangeInt<T>::Undef();
+	}
 
-		if(cond.istrue) {
-			for(auto const& ival: lhs.ivals)
-				res.ivals.push_back(IvalInt<T>(ival));
-		}
 
-		if(cond.isfalse) {
-			for(auto const& ival: rhs.ivals)
-				res.ivals.push_back(IvalInt<T>(ival));
+	/**
+	 * Join two integer ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
+	 */
+	static RangeInt<T> Union(RangeInt const& lhs, RangeInt const& rhs) {
+		if(lhs.IsUndef())
+			return rhs;
+		else if(rhs.IsUndef())
+			return lhs;
+
+		RangeInt res = lhs;
+
+		res.zeros &= rhs.zeros;
+		res.ones &= rhs.ones;
+		res.ivals.insert(res.ivals.end(), rhs.ivals.begin(), rhs.ivals.end());
+		res.Norm();
+
+		return res;
+	}
+
+	/**
+	 * Widen an integer range at a loop header. A range that still grows
+	 * keeps only the bits known on both iterations, so that widening ends
+	 * after at most one step per bit.
+	 *   @prev: The range from the previous iteration.
+	 *   @next: The range from the current iteration.
+	 *   &returns: The widened range.
+	 */
+	static RangeInt<T> Widen(RangeInt const& prev, RangeInt const& next) {
+		if(prev.IsUndef())
+			return next;
+
+		RangeInt res = Union(prev, next);
+
+		if(Equal(res, prev))
+			return prev;
+
+		return Bits(prev.zeros & next.zeros, prev.ones & next.ones);
+	}
+
+	/**
+	 * Check if two integer ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeInt const& lhs, RangeInt const& rhs) {
+		if((lhs.ivals.size() != rhs.ivals.size()) || (lhs.zeros != rhs.zeros) || (lhs.ones != rhs.ones))
+			return false;
+
+		for(size_t i = 0; i < lhs.ivals.size(); i++) {
+			if(!IvalInt<T>::Equal(lhs.ivals[i], rhs.ivals[i]))
+				return false;
 		}
 
-		return res;
+		return true;
 	}
 };
 
@@ -1057,6 +1904,19 @@ public:
 		return std::string("<" + ret + ">");
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t hash = scalars.size();
+
+		for(auto const& scalar : scalars)
+			hash = hash * 31 + scalar.Hash();
+
+		return hash;
+	}
+
 
 	/**
 	 * Create an integer range of all possible values.
@@ -1140,7 +2000,113 @@ public:
 	}
 
 
-	//template <class U> static RangeVecInt<T> FromFlt(RangeVecFlt<U> const& flt);
+	/**
+	 * Add two integer ranges, wrapping around.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result range.
+	 */
+	static RangeVecInt<T> Add(const RangeVecInt<T> &lhs, const RangeVecInt<T> &rhs) {
+		assert(lhs.scalars.size() == rhs.scalars.size());
+
+		RangeVecInt<T> res;
+
+		for(size_t i = 0; i < lhs.scalars.size(); i++)
+			res.scalars.push_back(RangeInt<T>::Add(lhs.scalars[i], rhs.scalars[i]));
+
+		return res;
+	}
+
+	/**
+	 * Subtract two integer ranges, wrapping around.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The result range.
+	 */
+	static RangeVecInt<T> Sub(const RangeVecInt<T> &lhs, const RangeVecInt<T> &rhs) {
+		assert(lhs.scalars.size() == rhs.scalars.size());
+
+		RangeVecInt<T> res;
+
+		for(size_t i = 0; i < lhs.scalars.size(); i++)
+			res.scalars.push_back(RangeInt<T>::Sub(lhs.scalars[i], rhs.scalars[i]));
+
+		return res;
+	}
+
+	/**
+	 * Shift integer ranges left by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   &returns: The result range.
+	 */
+	static RangeVecInt<T> Shl(const RangeVecInt<T> &in, uint32_t amt) {
+		RangeVecInt<T> res;
+
+		for(auto const& scalar : in.scalars)
+			res.scalars.push_back(RangeInt<T>::Shl(scalar, amt));
+
+		return res;
+	}
+
+	/**
+	 * Shift integer ranges right, logically, by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   &returns: The result range.
+	 */
+	static RangeVecInt<T> LShr(const RangeVecInt<T> &in, uint32_t amt) {
+		RangeVecInt<T> res;
+
+		for(auto const& scalar : in.scalars)
+			res.scalars.push_back(RangeInt<T>::LShr(scalar, amt));
+
+		return res;
+	}
+
+	/**
+	 * Truncate or zero-extend integer ranges of another width.
+	 *   @in: The input range.
+	 *   &returns: The result range.
+	 */
+	template <class U> static RangeVecInt<T> Cast(RangeVecInt<U> const& in) {
+		RangeVecInt<T> res;
+
+		for(auto const& scalar : in.scalars)
+			res.scalars.push_back(RangeInt<T>::template Cast<U>(scalar));
+
+		return res;
+	}
+
+
+	/**
+	 * Reinterpret the bits of floating-point ranges as integers.
+	 *   @flt: The floating-point range.
+	 *   &returns: The integer range.
+	 */
+	template <class F> static RangeVecInt<T> FromFlt(RangeVecFlt<F> const& flt) {
+		RangeVecInt<T> res;
+
+		for(uint32_t i = 0; i < flt.width; i++)
+			res.scalars.push_back(RangeInt<T>::template FromFlt<F>(flt.Lane(i)));
+
+		return res;
+	}
+
+	/**
+	 * Reinterpret the bits of integer ranges as floating-point values.
+	 *   &returns: The floating-point range.
+	 */
+	template <class F> RangeVecFlt<F> ToFlt() const {
+		RangeVecFlt<F> res;
+
+		for(auto const& scalar : scalars)
+			res.Push(scalar.template ToFlt<F>());
+
+		res.Pack();
+
+		return res;
+	}
 
 
 	/**
@@ -1161,6 +2127,59 @@ public:
 
 		return res;
 	}
+
+
+	/**
+	 * Join two integer, vector ranges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: The union.
+	 */
+	static RangeVecInt<T> Union(RangeVecInt<T> const& lhs, RangeVecInt<T> const& rhs) {
+		assert(lhs.scalars.size() == rhs.scalars.size());
+
+		RangeVecInt<T> res;
+
+		for(uint32_t i = 0; i < lhs.scalars.size(); i++)
+			res.scalars.push_back(RangeInt<T>::Union(lhs.scalars[i], rhs.scalars[i]));
+
+		return res;
+	}
+
+	/**
+	 * Widen integer, vector ranges.
+	 *   @prev: The range from the previous iteration.
+	 *   @next: The range from the current iteration.
+	 *   &returns: The widened range.
+	 */
+	static RangeVecInt<T> Widen(RangeVecInt<T> const& prev, RangeVecInt<T> const& next) {
+		assert(prev.scalars.size() == next.scalars.size());
+
+		RangeVecInt<T> res;
+
+		for(uint32_t i = 0; i < prev.scalars.size(); i++)
+			res.scalars.push_back(RangeInt<T>::Widen(prev.scalars[i], next.scalars[i]));
+
+		return res;
+	}
+
+	/**
+	 * Check if two integer, vector ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(RangeVecInt<T> const& lhs, RangeVecInt<T> const& rhs) {
+		if(lhs.scalars.size() != rhs.scalars.size())
+			return false;
+
+		for(uint32_t i = 0; i < lhs.scalars.size(); i++) {
+			if(!RangeInt<T>::Equal(lhs.scalars[i], rhs.scalars[i]))
+				return false;
+		}
+
+		return true;
+	}
 };
 
 /*
@@ -1214,6 +2233,33 @@ public:
 			return false;
 	}
 
+	/**
+	 * Check if an integer range may contain a value in any lane. Ranges of
+	 * other types may contain anything.
+	 *   @val: The value.
+	 *   &returns: True if the value may be in the range.
+	 */
+	bool Contains(uint64_t val) const {
+		if(IsA<RangeVecI32>(*this)) {
+			for(auto const& scalar : std::get<RangeVecI32>(var).scalars) {
+				if(scalar.Contains(val))
+					return true;
+			}
+
+			return false;
+		}
+		else if(IsA<RangeVecI64>(*this)) {
+			for(auto const& scalar : std::get<RangeVecI64>(var).scalars) {
+				if(scalar.Contains(val))
+					return true;
+			}
+
+			return false;
+		}
+		else
+			return true;
+	}
+
 	/**
 	 * Check if a range contains subnormal numbers.
 	 *   &returns: True the range may contains subnormals.
@@ -1251,16 +2297,68 @@ public:
 			fatal("Invalid range type.");
 	}
 
+	/**
+	 * Hash a range, consistently with `Equal`.
+	 *   &returns: The hash.
+	 */
+	size_t Hash() const {
+		size_t hash = var.index();
+
+		if(IsA<RangeVecBool>(*this))
+			hash = hash * 31 + std::get<RangeVecBool>(var).Hash();
+		else if(IsA<RangeVecI32>(*this))
+			hash = hash * 31 + std::get<RangeVecI32>(var).Hash();
+		else if(IsA<RangeVecI64>(*this))
+			hash = hash * 31 + std::get<RangeVecI64>(var).Hash();
+		else if(IsA<RangeVecF32>(*this))
+			hash = hash * 31 + std::get<RangeVecF32>(var).Hash();
+		else if(IsA<RangeVecF64>(*this))
+			hash = hash * 31 + std::get<RangeVecF64>(var).Hash();
+
+		return hash;
+	}
+
 	//static Range AllI64(uint32_t width) { return Range(RangeVecI64::All(width)); }
 	//static Range AllF64(uint32_t width) { return Range(RangeVecF64::All(width)); }
 	//static Range ConstI64(uint64_t val) { return Range(RangeVecI64(RangeI64::Const(val))); }
 	//static Range ConstF64(double val) { return Range(RangeVecF64(RangeF64::Const(val))); }
 
-	static Range ItoF(const Range &in, Type type);
-	static Range FtoI(const Range &in, Type type);
+	/**
+	 * Reinterpret the bits of an integer range as floating-point values.
+	 *   @in: The input range.
+	 *   @type: The floating-point type.
+	 *   &returns: The result range.
+	 */
+	static Range ItoF(const Range &in, Type type) {
+		if(IsUnk1(in))
+			return Range(type);
+		else if(IsA<RangeVecI32>(in) && (type.width == 32))
+			return Range(std::get<RangeVecI32>(in.var).ToFlt<float>());
+		else if(IsA<RangeVecI64>(in) && (type.width == 64))
+			return Range(std::get<RangeVecI64>(in.var).ToFlt<double>());
+		else
+			fatal("Invalid bitcast to float.");
+	}
+
+	/**
+	 * Reinterpret the bits of a floating-point range as integers.
+	 *   @in: The input range.
+	 *   @type: The integer type.
+	 *   &returns: The result range.
+	 */
+	static Range FtoI(const Range &in, Type type) {
+		if(IsUnk1(in))
+			return Range(type);
+		else if(IsA<RangeVecF32>(in) && (type.width == 32))
+			return Range(RangeVecI32::FromFlt<float>(std::get<RangeVecF32>(in.var)));
+		else if(IsA<RangeVecF64>(in) && (type.width == 64))
+			return Range(RangeVecI64::FromFlt<double>(std::get<RangeVecF64>(in.var)));
+		else
+			fatal("Invalid bitcast to integer.");
+	}
 
 
-	Range Protect(Type type, double min) {
+	Range Protect(Type type, double min) const {
 		if(IsA<RangeUnk>(*this)) {
 			if(type.kind != Kind::Flt)
 				fatal("Invalid range type.");
@@ -1275,7 +2373,7 @@ public:
 			fatal("Invalid range type.");
 	}
 
-	Range Compact(double cap) {
+	Range Compact(double cap) const {
 		if(IsA<RangeVecF32>(*this))
 			return Range(std::get<RangeVecF32>(var).Compact(cap));
 		else if(IsA<RangeVecF64>(*this))
@@ -1333,6 +2431,10 @@ public:
 			return RangeVecF32::Add(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var));
 		else if(IsPair<RangeVecF64>(lhs, rhs))
 			return RangeVecF64::Add(std::get<RangeVecF64>(lhs.var), std::get<RangeVecF64>(rhs.var));
+		else if(IsPair<RangeVecI32>(lhs, rhs))
+			return RangeVecI32::Add(std::get<RangeVecI32>(lhs.var), std::get<RangeVecI32>(rhs.var));
+		else if(IsPair<RangeVecI64>(lhs, rhs))
+			return RangeVecI64::Add(std::get<RangeVecI64>(lhs.var), std::get<RangeVecI64>(rhs.var));
 		else
 			fatal("Invalid addition.");
 	}
@@ -1351,6 +2453,10 @@ public:
 			return RangeVecF32::Sub(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var));
 		else if(IsPair<RangeVecF64>(lhs, rhs))
 			return RangeVecF64::Sub(std::get<RangeVecF64>(lhs.var), std::get<RangeVecF64>(rhs.var));
+		else if(IsPair<RangeVecI32>(lhs, rhs))
+			return RangeVecI32::Sub(std::get<RangeVecI32>(lhs.var), std::get<RangeVecI32>(rhs.var));
+		else if(IsPair<RangeVecI64>(lhs, rhs))
+			return RangeVecI64::Sub(std::get<RangeVecI64>(lhs.var), std::get<RangeVecI64>(rhs.var));
 		else
 			fatal("Invalid subtraction.");
 	}
@@ -1453,6 +2559,60 @@ public:
 	}
 
 
+	/**
+	 * Shift a range left by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   @type: The type.
+	 *   &returns: The result range.
+	 */
+	static Range Shl(const Range &in, uint32_t amt, Type type) {
+		if(IsUnk1(in))
+			return Range(type);
+		else if(IsA<RangeVecI32>(in))
+			return RangeVecI32::Shl(std::get<RangeVecI32>(in.var), amt);
+		else if(IsA<RangeVecI64>(in))
+			return RangeVecI64::Shl(std::get<RangeVecI64>(in.var), amt);
+		else
+			fatal("Invalid shift left.");
+	}
+
+	/**
+	 * Shift a range right, logically, by a constant.
+	 *   @in: The input range.
+	 *   @amt: The shift amount.
+	 *   @type: The type.
+	 *   &returns: The result range.
+	 */
+	static Range LShr(const Range &in, uint32_t amt, Type type) {
+		if(IsUnk1(in))
+			return Range(type);
+		else if(IsA<RangeVecI32>(in))
+			return RangeVecI32::LShr(std::get<RangeVecI32>(in.var), amt);
+		else if(IsA<RangeVecI64>(in))
+			return RangeVecI64::LShr(std::get<RangeVecI64>(in.var), amt);
+		else
+			fatal("Invalid shift right.");
+	}
+
+	/**
+	 * Truncate or zero-extend a range to another integer width.
+	 *   @in: The input range.
+	 *   @type: The result type.
+	 *   &returns: The result range.
+	 */
+	static Range Cast(const Range &in, Type type) {
+		if(IsUnk1(in))
+			return Range(type);
+		else if(IsA<RangeVecI64>(in) && (type.width == 32))
+			return RangeVecI32::Cast<uint64_t>(std::get<RangeVecI64>(in.var));
+		else if(IsA<RangeVecI32>(in) && (type.width == 64))
+			return RangeVecI64::Cast<uint32_t>(std::get<RangeVecI32>(in.var));
+		else
+			fatal("Invalid integer cast.");
+	}
+
+
 	/**
 	 * Comparison (OLT) on two ranges.
 	 *   @lhs: The left-hand side.
@@ -1462,7 +2622,7 @@ public:
 	 */
 	static Range CmpOLT(Range const &lhs, Range const &rhs, Type type) {
 		if(IsUnk2(lhs, rhs))
-			return Range(RangeUnk());
+			return Range(type);
 
 		if(IsPair<RangeVecF32>(lhs, rhs))
 			return Range(RangeVecF32::CmpOLT(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var)));
@@ -1481,7 +2641,7 @@ public:
 	 */
 	static Range CmpOGT(Range const &lhs, Range const &rhs, Type type) {
 		if(IsUnk2(lhs, rhs))
-			return Range(RangeUnk());
+			return Range(type);
 
 		if(IsPair<RangeVecF32>(lhs, rhs))
 			return Range(RangeVecF32::CmpOGT(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var)));
@@ -1524,6 +2684,146 @@ public:
 	}
 
 
+	/**
+	 * Join two ranges, as needed at control-flow merges.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   @type: The type.
+	 *   &returns: The union.
+	 */
+	static Range Union(Range const& lhs, Range const& rhs, Type type) {
+		if(IsUnk2(lhs, rhs))
+			return Range(type);
+		else if(IsPair<RangeVecBool>(lhs, rhs))
+			return Range(RangeVecBool::Union(std::get<RangeVecBool>(lhs.var), std::get<RangeVecBool>(rhs.var)));
+		else if(IsPair<RangeVecI32>(lhs, rhs))
+			return Range(RangeVecI32::Union(std::get<RangeVecI32>(lhs.var), std::get<RangeVecI32>(rhs.var)));
+		else if(IsPair<RangeVecI64>(lhs, rhs))
+			return Range(RangeVecI64::Union(std::get<RangeVecI64>(lhs.var), std::get<RangeVecI64>(rhs.var)));
+		else if(IsPair<RangeVecF32>(lhs, rhs))
+			return Range(RangeVecF32::Union(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var)));
+		else if(IsPair<RangeVecF64>(lhs, rhs))
+			return Range(RangeVecF64::Union(std::get<RangeVecF64>(lhs.var), std::get<RangeVecF64>(rhs.var)));
+		else
+			fatal("Invalid union (%zd, %zd).", lhs.var.index(), rhs.var.index());
+	}
+
+	/**
+	 * Widen a range at a loop header. Boolean ranges are only joined, as
+	 * they have finite height.
+	 *   @prev: The range from the previous iteration.
+	 *   @next: The range from the current iteration.
+	 *   @type: The type.
+	 *   &returns: The widened range.
+	 */
+	static Range Widen(Range const& prev, Range const& next, Type type) {
+		if(IsUnk2(prev, next))
+			return Range(type);
+		else if(IsPair<RangeVecF32>(prev, next))
+			return Range(RangeVecF32::Widen(std::get<RangeVecF32>(prev.var), std::get<RangeVecF32>(next.var)));
+		else if(IsPair<RangeVecF64>(prev, next))
+			return Range(RangeVecF64::Widen(std::get<RangeVecF64>(prev.var), std::get<RangeVecF64>(next.var)));
+		else if(IsPair<RangeVecI32>(prev, next))
+			return Range(RangeVecI32::Widen(std::get<RangeVecI32>(prev.var), std::get<RangeVecI32>(next.var)));
+		else if(IsPair<RangeVecI64>(prev, next))
+			return Range(RangeVecI64::Widen(std::get<RangeVecI64>(prev.var), std::get<RangeVecI64>(next.var)));
+		else
+			return Union(prev, next, type);
+	}
+
+	/**
+	 * Check if two ranges are identical.
+	 *   @lhs: The left-hand side.
+	 *   @rhs: The right-hand side.
+	 *   &returns: True if equal.
+	 */
+	static bool Equal(Range const& lhs, Range const& rhs) {
+		if(lhs.var.index() != rhs.var.index())
+			return false;
+		else if(IsA<RangeVecBool>(lhs))
+			return RangeVecBool::Equal(std::get<RangeVecBool>(lhs.var), std::get<RangeVecBool>(rhs.var));
+		else if(IsA<RangeVecI32>(lhs))
+			return RangeVecI32::Equal(std::get<RangeVecI32>(lhs.var), std::get<RangeVecI32>(rhs.var));
+		else if(IsA<RangeVecI64>(lhs))
+			return RangeVecI64::Equal(std::get<RangeVecI64>(lhs.var), std::get<RangeVecI64>(rhs.var));
+		else if(IsA<RangeVecF32>(lhs))
+			return RangeVecF32::Equal(std::get<RangeVecF32>(lhs.var), std::get<RangeVecF32>(rhs.var));
+		else if(IsA<RangeVecF64>(lhs))
+			return RangeVecF64::Equal(std::get<RangeVecF64>(lhs.var), std::get<RangeVecF64>(rhs.var));
+		else
+			return true;
+	}
+
+	/**
+	 * Restrict a range to the values at or below the upper bound of another,
+	 * as implied by a taken comparison. Non-float ranges are left as-is.
+	 *   @in: The input range.
+	 *   @bound: The bounding range.
+	 *   @nan: Keep NaN if the input may be NaN.
+	 *   &returns: The restricted range.
+	 */
+	static Range Below(Range const& in, Range const& bound, bool nan) {
+		if(IsPair<RangeVecF32>(in, bound))
+			return Range(RangeVecF32::Below(std::get<RangeVecF32>(in.var), std::get<RangeVecF32>(bound.var), nan));
+		else if(IsPair<RangeVecF64>(in, bound))
+			return Range(RangeVecF64::Below(std::get<RangeVecF64>(in.var), std::get<RangeVecF64>(bound.var), nan));
+		else
+			return in;
+	}
+
+	/**
+	 * Restrict a range to the values at or above the lower bound of another,
+	 * as implied by a taken comparison. Non-float ranges are left as-is.
+	 *   @in: The input range.
+	 *   @bound: The bounding range.
+	 *   @nan: Keep NaN if the input may be NaN.
+	 *   &returns: The restricted range.
+	 */
+	static Range Above(Range const& in, Range const& bound, bool nan) {
+		if(IsPair<RangeVecF32>(in, bound))
+			return Range(RangeVecF32::Above(std::get<RangeVecF32>(in.var), std::get<RangeVecF32>(bound.var), nan));
+		else if(IsPair<RangeVecF64>(in, bound))
+			return Range(RangeVecF64::Above(std::get<RangeVecF64>(in.var), std::get<RangeVecF64>(bound.var), nan));
+		else
+			return in;
+	}
+
+	/**
+	 * Restrict a range to a declared interval. Unknown ranges are first
+	 * widened to every value of the type.
+	 *   @in: The input range.
+	 *   @lo: The lower bound.
+	 *   @hi: The upper bound.
+	 *   @type: The type.
+	 *   &returns: The restricted range.
+	 */
+	static Range Clamp(Range const& in, double lo, double hi, Type type) {
+		Range range = IsUnk1(in) ? Range(type) : in;
+
+		if(IsA<RangeVecF32>(range))
+			return Range(RangeVecF32::Clamp(std::get<RangeVecF32>(range.var), lo, hi));
+		else if(IsA<RangeVecF64>(range))
+			return Range(RangeVecF64::Clamp(std::get<RangeVecF64>(range.var), lo, hi));
+		else
+			return range;
+	}
+
+	/**
+	 * Restrict a range given the range of its absolute value.
+	 *   @in: The input range.
+	 *   @abs: The range of the absolute value.
+	 *   &returns: The restricted range.
+	 */
+	static Range InvAbs(Range const& in, Range const& abs) {
+		if(IsPair<RangeVecF32>(in, abs))
+			return Range(RangeVecF32::InvAbs(std::get<RangeVecF32>(in.var), std::get<RangeVecF32>(abs.var)));
+		else if(IsPair<RangeVecF64>(in, abs))
+			return Range(RangeVecF64::InvAbs(std::get<RangeVecF64>(in.var), std::get<RangeVecF64>(abs.var)));
+		else
+			return in;
+	}
+
+
 	/**
 	 * Check if a value is undefined.
 	 *   @in: The input range.
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <deque>
+
+/*
+ * range pool class
+ *
+ * Arena of hash-consed ranges. Every distinct range is stored once, in
+ * chunks that are neither moved nor freed before the pool, so interned
+ * ranges can be shared by pointer and compared by address.
+ */
+class RangePool {
+public:
+	RangePool() { cnt = 0; }
+	~RangePool() { }
+
+	RangePool(RangePool const&) = delete;
+	RangePool& operator=(RangePool const&) = delete;
+
+	/**
+	 * Retrieve the interned copy of a range, adding it if new.
+	 *   @range: The range.
+	 *   &returns: The interned range.
+	 */
+	const Range *Intern(Range const& range) {
+		if(2 * (cnt + 1) > slots.size())
+			Grow();
+
+		size_t hash = range.Hash(), mask = slots.size() - 1;
+
+		for(size_t i = hash & mask; ; i = (i + 1) & mask) {
+			if(slots[i].second == nullptr) {
+				arena.push_back(range);
+				slots[i] = { hash, &arena.back() };
+				cnt++;
+
+				return slots[i].second;
+			}
+			else if((slots[i].first == hash) && Range::Equal(*slots[i].second, range))
+				return slots[i].second;
+		}
+	}
+
+	/**
+	 * Retrieve the number of distinct ranges.
+	 *   &returns: The count.
+	 */
+	size_t Size() const {
+		return cnt;
+	}
+
+private:
+	size_t cnt;
+	std::deque<Range> arena;
+	std::vector<std::pair<size_t, const Range *>> slots;
+
+	/**
+	 * Double the hash table, reinserting the interned ranges.
+	 */
+	void Grow() {
+		std::vector<std::pair<size_t, const Range *>> old(std::max<size_t>(64, 2 * slots.size()), { 0, nullptr });
+		size_t mask = old.size() - 1;
+
+		old.swap(slots);
+
+		for(auto const& slot : old) {
+			if(slot.second == nullptr)
+				continue;
+
+			size_t i;
+			for(i = slot.first & mask; slots[i].second != nullptr; i = (i + 1) & mask);
+
+			slots[i] = slot;
+		}
+	}
+};
+
+/*
+ * fact table class
+ *
+ * Ranges of the values of a function. Values are numbered densely on first
+ * use and their facts are held in a flat array of interned ranges.
+ */
+class Table {
+public:
+	Table() { }
+	~Table() { }
+
+	/**
+	 * Retrieve the number of a value, numbering it if new.
+	 *   @value: The value.
+	 *   &returns: The number.
+	 */
+	uint32_t Id(const llvm::Value *value) {
+		auto ins = ids.insert({ value, (uint32_t)facts.size() });
+		if(ins.second)
+			facts.push_back(nullptr);
+
+		return ins.first->second;
+	}
+
+	/**
+	 * Find the fact of a value.
+	 *   @value: The value.
+	 *   &returns: The interned range, or null if none.
+	 */
+	const Range *Find(const llvm::Value *value) const {
+		auto find = ids.find(value);
+
+		return (find != ids.end()) ? facts[find->second] : nullptr;
+	}
+
+	/**
+	 * Check if a value has a fact.
+	 *   @value: The value.
+	 *   &returns: True if present.
+	 */
+	bool Has(const llvm::Value *value) const {
+		return Find(value) != nullptr;
+	}
+
+	/**
+	 * Retrieve the fact of a value, unknown if none.
+	 *   @value: The value.
+	 *   &returns: The range.
+	 */
+	Range const& Get(const llvm::Value *value) const {
+		static const Range unk;
+		const Range *range = Find(value);
+
+		return (range != nullptr) ? *range : unk;
+	}
+
+	/**
+	 * Set the fact of a value.
+	 *   @value: The value.
+	 *   @range: The interned range.
+	 */
+	void Set(const llvm::Value *value, const Range *range) {
+		facts[Id(value)] = range;
+	}
+
+	/**
+	 * Reserve room for a number of values.
+	 *   @n: The number of values.
+	 */
+	void Reserve(uint32_t n) {
+		ids.reserve(n);
+		facts.reserve(n);
+	}
+
+private:
+	llvm::DenseMap<const llvm::Value *, uint32_t> ids;
+	std::vector<const Range *> facts;
+};
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <set>
+
+/*
+ * Taint class
+ *
+ * Forward propagation of secret data over SSA values, memory objects, call
+ * arguments and return values. Secrets are introduced by the `ctfp_secret`
+ * string attribute on parameters and globals, and by `ctfp_secret`
+ * annotations on functions, globals and locals.
+ */
+class Taint {
+public:
+	Taint() { wild = false; }
+	~Taint() { }
+
+	std::set<const llvm::Value *> values;
+	std::set<const llvm::Value *> objects;
+	std::set<const llvm::Function *> rets;
+
+	/**
+	 * Secret data was stored through a pointer with no known object.
+	 */
+	bool wild;
+
+	/**
+	 * Check if a value carries secret data.
+	 *   @value: The value.
+	 *   &returns: True if secret.
+	 */
+	bool IsSecret(llvm::Value const *value) const {
+		return values.count(value) > 0;
+	}
+
+	/**
+	 * Check if an instruction operates on secret data.
+	 *   @inst: The instruction.
+	 *   &returns: True if any operand is secret.
+	 */
+	bool Secret(llvm::Instruction const& inst) const {
+		for(const llvm::Value *op : inst.operands()) {
+			if(IsSecret(op))
+				return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Run the taint analysis over a module to a fixpoint.
+	 *   @mod: The module.
+	 */
+	void Run(llvm::Module& mod) {
+		values.clear();
+		objects.clear();
+		rets.clear();
+		wild = false;
+
+		Seed(mod);
+
+		bool change = true;
+		while(change) {
+			change = false;
+
+			for(llvm::Function &func : mod)
+				change |= Func(func);
+		}
+	}
+
+	/**
+	 * Introduce the declared secrets of a module.
+	 *   @mod: The module.
+	 */
+	void Seed(llvm::Module& mod) {
+		for(llvm::Function &func : mod) {
+			for(llvm::Argument &arg : func.args()) {
+				if(func.getAttributes().hasAttribute(llvm::AttributeList::FirstArgIndex + arg.getArgNo(), "ctfp_secret"))
+					values.insert(&arg);
+			}
+		}
+
+		for(llvm::GlobalVariable &global : mod.globals()) {
+			if(global.hasAttribute("ctfp_secret"))
+				objects.insert(&global);
+		}
+
+		llvm::GlobalVariable *annot = mod.getGlobalVariable("llvm.global.annotations");
+		if((annot == nullptr) || !annot->hasInitializer())
+			return;
+
+		llvm::ConstantArray *list = llvm::dyn_cast<llvm::ConstantArray>(annot->getInitializer());
+		if(list == nullptr)
+			return;
+
+		for(unsigned int i = 0; i < list->getNumOperands(); i++) {
+			llvm::ConstantStruct *entry = llvm::dyn_cast<llvm::ConstantStruct>(list->getOperand(i));
+			if((entry == nullptr) || !IsAnnot(entry->getOperand(1)))
+				continue;
+
+			llvm::Value *target = entry->getOperand(0)->stripPointerCasts();
+
+			if(llvm::isa<llvm::Function>(target)) {
+				for(llvm::Argument &arg : llvm::cast<llvm::Function>(target)->args())
+					values.insert(&arg);
+			}
+			else if(llvm::isa<llvm::GlobalVariable>(target))
+				objects.insert(target);
+		}
+	}
+
+	/**
+	 * Propagate the secrets through a function. Branching on a secret makes
+	 * every PHI and store of the function secret, as a coarse account of
+	 * implicit flows.
+	 *   @func: The function.
+	 *   &returns: True if anything changed.
+	 */
+	bool Func(llvm::Function& func) {
+		size_t before = values.size() + objects.size() + rets.size() + wild;
+		bool implicit = false;
+
+		for(llvm::BasicBlock &block : func) {
+			const llvm::TerminatorInst *term = block.getTerminator();
+
+			if(llvm::isa<llvm::BranchInst>(term) && llvm::cast<llvm::BranchInst>(term)->isConditional())
+				implicit |= IsSecret(llvm::cast<llvm::BranchInst>(term)->getCondition());
+			else if(llvm::isa<llvm::SwitchInst>(term))
+				implicit |= IsSecret(llvm::cast<llvm::SwitchInst>(term)->getCondition());
+		}
+
+		for(llvm::BasicBlock &block : func) {
+			for(llvm::Instruction &inst : block)
+				Inst(inst, implicit);
+		}
+
+		return (values.size() + objects.size() + rets.size() + wild) != before;
+	}
+
+	/**
+	 * Propagate the secrets through an instruction.
+	 *   @inst: The instruction.
+	 *   @implicit: Whether the function branches on a secret.
+	 */
+	void Inst(llvm::Instruction& inst, bool implicit) {
+		const llvm::DataLayout &layout = inst.getModule()->getDataLayout();
+
+		if(llvm::isa<llvm::LoadInst>(inst)) {
+			llvm::Value *ptr = llvm::cast<llvm::LoadInst>(inst).getPointerOperand();
+
+			if(IsSecret(ptr) || Load(llvm::GetUnderlyingObject(ptr, layout)))
+				values.insert(&inst);
+		}
+		else if(llvm::isa<llvm::StoreInst>(inst)) {
+			llvm::StoreInst &store = llvm::cast<llvm::StoreInst>(inst);
+
+			if(implicit || IsSecret(store.getValueOperand()))
+				Store(llvm::GetUnderlyingObject(store.getPointerOperand(), layout));
+		}
+		else if(llvm::isa<llvm::CallInst>(inst)) {
+			llvm::CallInst &call = llvm::cast<llvm::CallInst>(inst);
+			llvm::Function *callee = call.getCalledFunction();
+
+			if((callee != nullptr) && callee->getName().startswith("llvm.var.annotation")) {
+				if(IsAnnot(call.getArgOperand(1)))
+					Store(llvm::GetUnderlyingObject(call.getArgOperand(0), layout));
+			}
+			else if((callee != nullptr) && !callee->isDeclaration()) {
+				for(unsigned int i = 0; i < call.getNumArgOperands() && i < callee->arg_size(); i++) {
+					llvm::Value *arg = call.getArgOperand(i);
+					llvm::Argument *param = &*(callee->arg_begin() + i);
+
+					if(IsSecret(arg))
+						values.insert(param);
+
+					if(arg->getType()->isPointerTy()) {
+						const llvm::Value *obj = llvm::GetUnderlyingObject(arg, layout);
+
+						if(Load(obj))
+							objects.insert(param);
+						else if(objects.count(param) > 0)
+							Store(obj);
+					}
+				}
+
+				if(rets.count(callee) > 0)
+					values.insert(&inst);
+			}
+			else {
+				bool secret = Secret(inst);
+
+				for(unsigned int i = 0; i < call.getNumArgOperands(); i++) {
+					if(call.getArgOperand(i)->getType()->isPointerTy())
+						secret |= Load(llvm::GetUnderlyingObject(call.getArgOperand(i), layout));
+				}
+
+				if(!secret)
+					return;
+
+				values.insert(&inst);
+
+				for(unsigned int i = 0; i < call.getNumArgOperands(); i++) {
+					if(call.getArgOperand(i)->getType()->isPointerTy())
+						Store(llvm::GetUnderlyingObject(call.getArgOperand(i), layout));
+				}
+			}
+		}
+		else if(llvm::isa<llvm::ReturnInst>(inst)) {
+			llvm::Value *ret = llvm::cast<llvm::ReturnInst>(inst).getReturnValue();
+
+			if((ret != nullptr) && IsSecret(ret))
+				rets.insert(inst.getFunction());
+		}
+		else if((implicit && llvm::isa<llvm::PHINode>(inst)) || Secret(inst))
+			values.insert(&inst);
+	}
+
+	/**
+	 * Check if a load from an object may read secret data.
+	 *   @obj: The underlying object.
+	 *   &returns: True if secret.
+	 */
+	bool Load(const llvm::Value *obj) const {
+		if(IsObject(obj))
+			return wild || (objects.count(obj) > 0);
+		else
+			return wild || !objects.empty();
+	}
+
+	/**
+	 * Record a store of secret data into an object.
+	 *   @obj: The underlying object.
+	 */
+	void Store(const llvm::Value *obj) {
+		if(IsObject(obj))
+			objects.insert(obj);
+		else
+			wild = true;
+	}
+
+
+	/**
+	 * Check if an underlying object is tracked on its own.
+	 *   @obj: The object.
+	 *   &returns: True if tracked.
+	 */
+	static bool IsObject(const llvm::Value *obj) {
+		return llvm::isa<llvm::AllocaInst>(obj) || llvm::isa<llvm::GlobalVariable>(obj) || llvm::isa<llvm::Argument>(obj);
+	}
+
+	/**
+	 * Check if an annotation string declares a secret.
+	 *   @str: The annotation string operand.
+	 *   &returns: True if secret.
+	 */
+	static bool IsAnnot(llvm::Value *str) {
+		llvm::GlobalVariable *global = llvm::dyn_cast<llvm::GlobalVariable>(str->stripPointerCasts());
+		if((global == nullptr) || !global->hasInitializer())
+			return false;
+
+		llvm::ConstantDataArray *data = llvm::dyn_cast<llvm::ConstantDataArray>(global->getInitializer());
+
+		return (data != nullptr) && data->isCString() && (data->getAsCString() == "ctfp_secret");
+	}
+};
@@ -7,50 +7,277 @@
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include <llvm/Transforms/Utils/Cloning.h>
-#include <llvm/Linker/Linker.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/CFG.h>
+#include <llvm/IR/Dominators.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/Analysis/CallGraph.h>
+#include <llvm/Analysis/ConstantFolding.h>
+#include <llvm/Analysis/ValueTracking.h>
+#include <llvm/Analysis/LoopInfo.h>
+#include <llvm/ADT/SCCIterator.h>
+#include <llvm/ADT/PostOrderIterator.h>
 
 #include <float.h>
+#include <algorithm>
 #include <regex>
 #include <cmath>
+#include <map>
+#include <memory>
 #include <set>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
 
 #include "../ival/inc.hpp"
+#include "pack.hpp"
 
 #include "../ctfp.bc.c"
 
-enum mode_e { basic_v, rest_v, full_v, fast_v, flags_v, stats_v };
+enum mode_e { basic_v, rest_v, full_v, fast_v, flags_v, stats_v, hybrid_v, off_v };
+enum ftz_e { ftz_keep, ftz_set, ftz_clobber };
 
 /*
  * local declarations
  */
+bool ctfp_init(llvm::Module& mod);
+bool ctfp_done(llvm::Module& mod);
 bool ctfp_func(llvm::Function &func);
 void ctfp_block(llvm::BasicBlock& block, Pass& pass);
-void ctfp_protect(llvm::Instruction *inst, unsigned int i, double safe);
+bool ctfp_limit(Info const& info, unsigned int i, double *min, double *safe);
+Range ctfp_guard(llvm::Instruction const& inst, unsigned int i, Range const& range);
+Range ctfp_default(llvm::Argument const& arg);
+bool ctfp_internal(llvm::Function const& func);
+Range ctfp_callee(llvm::CallInst const& call);
+void ctfp_solve(llvm::Module& mod);
+uint32_t ctfp_guards(llvm::Function& func, std::vector<Range> const& args);
+uint32_t ctfp_size(llvm::Function const& func);
+bool ctfp_clone(llvm::Module& mod);
+void ctfp_summary(llvm::Module& mod);
+llvm::Value *ctfp_protect(llvm::Value *op, double safe, llvm::Instruction *inst);
+uint64_t ctfp_weight(llvm::LoopInfo const& loops, const llvm::BasicBlock *block);
+uint64_t ctfp_cut(llvm::DomTreeNode *node, std::set<const llvm::BasicBlock *> const& live, std::set<const llvm::BasicBlock *> const& uses, llvm::LoopInfo const& loops, std::vector<const llvm::BasicBlock *>& place);
+llvm::Instruction *ctfp_after(llvm::Instruction *def);
+void ctfp_place(llvm::Function& func, Pass& pass);
+uint32_t ctfp_site(llvm::Instruction *inst, const char *id);
 void ctfp_replace(llvm::Instruction *inst, const char *id);
+bool ctfp_hybrid(llvm::Instruction const& inst, Pass& pass);
+llvm::Type *ctfp_shape(llvm::Type *type, llvm::Type *elem);
+llvm::Type *ctfp_bits(llvm::Type *type);
+llvm::Value *ctfp_pow2(llvm::IRBuilder<>& irb, llvm::Value *exp, llvm::Type *type);
+llvm::Value *ctfp_clamp(llvm::IRBuilder<>& irb, llvm::Value *val, int64_t lo, int64_t hi);
+llvm::Value *ctfp_widen(llvm::IRBuilder<>& irb, llvm::Value *val);
+llvm::Value *ctfp_round(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Value *err);
+llvm::Value *ctfp_narrow(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Type *type);
+llvm::Value *ctfp_scale(llvm::IRBuilder<>& irb, llvm::Value *val, int exp);
+llvm::Value *ctfp_split(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Value **exp);
+llvm::Value *ctfp_join(llvm::IRBuilder<>& irb, llvm::Value *mant, llvm::Value *exp, llvm::Value *err);
+llvm::Value *ctfp_correct(llvm::Instruction *inst, Info const& info);
+
+bool ctfp_parse(std::string str, enum mode_e *mode);
+bool ctfp_ftzmode(enum mode_e mode);
+bool ctfp_kernels(enum mode_e mode);
+const llvm::Function *ctfp_called(llvm::Instruction const& inst);
+enum ftz_e ctfp_effect(llvm::Instruction const& inst);
+bool ctfp_needs(llvm::Instruction const& inst);
+bool ctfp_step(llvm::Instruction const& inst, bool set, bool flags);
+bool ctfp_flow(llvm::Function const& func, bool entry, bool flags, std::map<const llvm::BasicBlock *, bool>& in);
+void ctfp_ftz(llvm::Module& mod);
+void ctfp_reload(llvm::Function& func);
+void ctfp_annotate(llvm::Module& mod);
+enum mode_e ctfp_select(llvm::Function const& func);
 
 void ctfp_cleanup(llvm::Module& mod);
+llvm::Function *ctfp_kernel(llvm::Module &mod, const char *id);
 
+/*
+ * transformation modes
+ *   The default is taken from `CTFP_MODE` and may be overridden per
+ *   function; `ctfp_mode` holds the mode of the function being processed.
+ */
+enum mode_e ctfp_base;
 enum mode_e ctfp_mode;
 
+/*
+ * secret taint, enabled by `CTFP_TAINT`
+ */
+bool ctfp_tainted = false;
+Taint ctfp_taint;
+
+/*
+ * interprocedural summaries, fast mode only
+ */
+std::map<const llvm::Function *, std::vector<Range>> ctfp_args;
+std::map<const llvm::Function *, Range> ctfp_rets;
+
+/*
+ * stats-mode site identifiers already emitted
+ */
+std::set<uint32_t> ctfp_sites;
+
+/*
+ * flags-mode MXCSR summaries
+ *   A call either keeps the FTZ/DAZ state of its caller, always returns
+ *   with FTZ/DAZ set, or may clear them. Flags-mode functions whose callers
+ *   all have FTZ/DAZ set skip their entry reload.
+ */
+std::map<const llvm::Function *, enum ftz_e> ctfp_ftzs;
+std::set<const llvm::Function *> ctfp_entered;
+
+/*
+ * kernel source
+ *   The CTFP bitcode, in the context of the module being transformed, and
+ *   the copies of its globals made so far. Both are released with the
+ *   kernels once the pass is done with the module.
+ */
+std::unique_ptr<llvm::Module> ctfp_src;
+std::map<const llvm::GlobalValue *, llvm::GlobalValue *> ctfp_copies;
+
 
-void ctfp_link(unsigned char *prog, unsigned int len, llvm::Module &mod)
+/**
+ * Retrieve the CTFP bitcode, loaded lazily into the context of the module
+ * being transformed. Only the symbol table is read up front; the body of a
+ * function is read when a kernel first needs it.
+ *   @ctx: The context.
+ *   &returns: The kernel module.
+ */
+llvm::Module *ctfp_source(llvm::LLVMContext &ctx)
 {
-	llvm::SMDiagnostic err;
-	std::unique_ptr<llvm::WritableMemoryBuffer> mem = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(len);
+	if(ctfp_src != nullptr)
+		return ctfp_src.get();
 
-	memcpy(mem->getBufferStart(), prog, len);
+	llvm::SMDiagnostic err;
+	std::unique_ptr<llvm::MemoryBuffer> mem = llvm::MemoryBuffer::getMemBuffer(llvm::StringRef((const char *)ctfp_bc, ctfp_bc_len), "ctfp.bc", false);
 
-	std::unique_ptr<llvm::Module> parse = llvm::parseIR(mem->getMemBufferRef(), err, mod.getContext());
-	if(parse == nullptr)
+	ctfp_src = llvm::getLazyIRModule(std::move(mem), err, ctx);
+	if(ctfp_src == nullptr)
 		fprintf(stderr, "Failed to load CTFP bitcode.\n"), abort();
 
-	if(llvm::Linker::linkModules(mod, std::move(parse)))
-		fprintf(stderr, "Link failed.\n"), abort();
+	return ctfp_src.get();
+}
+
+/**
+ * Collect the global values transitively referenced by a value, reading
+ * the bodies of the functions on the way.
+ *   @value: The value.
+ *   @need: The set of needed global values.
+ */
+void ctfp_refs(llvm::Value *value, std::set<llvm::GlobalValue *> &need)
+{
+	if(llvm::isa<llvm::GlobalValue>(value)) {
+		llvm::GlobalValue *global = llvm::cast<llvm::GlobalValue>(value);
+		if(!need.insert(global).second)
+			return;
+
+		if(llvm::Error err = global->materialize())
+			fatal("Failed to read CTFP kernel '%s'. %s", global->getName().str().c_str(), llvm::toString(std::move(err)).c_str());
+
+		if(llvm::isa<llvm::Function>(global)) {
+			for(llvm::BasicBlock &block : *llvm::cast<llvm::Function>(global)) {
+				for(llvm::Instruction &inst : block) {
+					for(llvm::Value *op : inst.operands())
+						ctfp_refs(op, need);
+				}
+			}
+		}
+		else if(llvm::isa<llvm::GlobalVariable>(global) && llvm::cast<llvm::GlobalVariable>(global)->hasInitializer())
+			ctfp_refs(llvm::cast<llvm::GlobalVariable>(global)->getInitializer(), need);
+	}
+	else if(llvm::isa<llvm::Constant>(value)) {
+		for(llvm::Value *op : llvm::cast<llvm::Constant>(value)->operands())
+			ctfp_refs(op, need);
+	}
+}
+
+/**
+ * Materialize a CTFP kernel in a module. The kernel and the globals it
+ * references are first declared in the module, reusing the ones copied
+ * before, and the bodies and initializers are then copied over. Kernels
+ * stay in the module until the pass is done with it.
+ *   @mod: The module.
+ *   @id: The kernel name.
+ *   &returns: The kernel function or null if it does not exist.
+ */
+llvm::Function *ctfp_kernel(llvm::Module &mod, const char *id)
+{
+	llvm::Function *func = mod.getFunction(id);
+	if((func != nullptr) && !func->isDeclaration())
+		return func;
+
+	llvm::Module *src = ctfp_source(mod.getContext());
+	llvm::Function *kern = src->getFunction(id);
+	if(kern == nullptr)
+		return nullptr;
+
+	std::set<llvm::GlobalValue *> need;
+	ctfp_refs(kern, need);
+
+	llvm::ValueToValueMapTy vmap;
+	std::vector<llvm::GlobalValue *> copy;
+
+	/* in module order, so that the output does not depend on addresses */
+	for(llvm::GlobalValue &value : src->global_values()) {
+		llvm::GlobalValue *global = &value;
+		if(need.count(global) == 0)
+			continue;
+
+		auto find = ctfp_copies.find(global);
+		if(find != ctfp_copies.end()) {
+			vmap[global] = find->second;
+			continue;
+		}
+
+		llvm::GlobalValue *dst = global->hasLocalLinkage() ? nullptr : mod.getNamedValue(global->getName());
+
+		if(dst != nullptr) {
+			if(dst->getType() != global->getType())
+				fatal("Mismatched type of CTFP global '%s'.", global->getName().str().c_str());
+		}
+		else if(llvm::isa<llvm::Function>(global))
+			dst = llvm::Function::Create(llvm::cast<llvm::Function>(global)->getFunctionType(), global->getLinkage(), global->getName(), &mod);
+		else if(llvm::isa<llvm::GlobalVariable>(global)) {
+			llvm::GlobalVariable *var = llvm::cast<llvm::GlobalVariable>(global);
+
+			dst = new llvm::GlobalVariable(mod, var->getValueType(), var->isConstant(), var->getLinkage(), nullptr, var->getName(), nullptr, var->getThreadLocalMode(), var->getType()->getAddressSpace());
+		}
+		else
+			fatal("Unhandled CTFP global '%s'.", global->getName().str().c_str());
+
+		if(dst->isDeclaration() && !global->isDeclaration()) {
+			if(llvm::isa<llvm::Function>(global))
+				llvm::cast<llvm::Function>(dst)->copyAttributesFrom(llvm::cast<llvm::Function>(global));
+			else
+				llvm::cast<llvm::GlobalVariable>(dst)->copyAttributesFrom(llvm::cast<llvm::GlobalVariable>(global));
+
+			copy.push_back(global);
+		}
+
+		vmap[global] = ctfp_copies[global] = dst;
+	}
+
+	for(llvm::GlobalValue *global : copy) {
+		if(llvm::isa<llvm::Function>(global)) {
+			llvm::Function *from = llvm::cast<llvm::Function>(global), *to = llvm::cast<llvm::Function>(vmap[global]);
+			llvm::SmallVector<llvm::ReturnInst *, 4> rets;
+			auto arg = to->arg_begin();
+
+			for(llvm::Argument &param : from->args()) {
+				arg->setName(param.getName());
+				vmap[&param] = &*arg++;
+			}
+
+			llvm::CloneFunctionInto(to, from, vmap, true, rets);
+		}
+		else {
+			llvm::GlobalVariable *from = llvm::cast<llvm::GlobalVariable>(global);
+
+			llvm::cast<llvm::GlobalVariable>(vmap[global])->setInitializer(llvm::MapValue(from->getInitializer(), vmap));
+		}
+	}
+
+	return llvm::cast<llvm::Function>(vmap[kern]);
 }
 
 void ctfp_flags(llvm::Instruction *inst)
@@ -68,156 +295,1063 @@ void ctfp_flags(llvm::Instruction *inst)
 	llvm::CallInst::Create(ftype, mod->getOrInsertFunction("llvm.x86.sse.ldmxcsr", ftype), { ptr8 }, "", inst);
 }
 
-/**
- * Apply the hack to the entire function.
- *   @func: The function.
- */
-void ctfp_hack(llvm::Function& func) {
-	llvm::LLVMContext &ctx = func.getContext();
+/**
+ * Retrieve the function called by an instruction.
+ *   @inst: The instruction.
+ *   &returns: The callee, null if not a direct call.
+ */
+const llvm::Function *ctfp_called(llvm::Instruction const& inst) {
+	if(llvm::isa<llvm::CallInst>(inst))
+		return llvm::cast<llvm::CallInst>(inst).getCalledFunction();
+	else if(llvm::isa<llvm::InvokeInst>(inst))
+		return llvm::cast<llvm::InvokeInst>(inst).getCalledFunction();
+	else
+		return nullptr;
+}
+
+/**
+ * Retrieve the MXCSR effect of a call.
+ *   @inst: The call instruction.
+ *   &returns: The effect.
+ */
+enum ftz_e ctfp_effect(llvm::Instruction const& inst) {
+	const llvm::Function *callee = ctfp_called(inst);
+
+	if(callee == nullptr)
+		return ftz_clobber;
+	else if(callee->isIntrinsic())
+		return (callee->getName() == "llvm.x86.sse.ldmxcsr") ? ftz_clobber : ftz_keep;
+	else if(callee->getName().startswith("ctfp_"))
+		return ftz_keep;
+
+	auto find = ctfp_ftzs.find(callee);
+	if(find != ctfp_ftzs.end())
+		return find->second;
+	else if(callee->hasFnAttribute("ctfp_ftz"))
+		return ftz_set;
+	else
+		return ftz_clobber;
+}
+
+/**
+ * Check if an instruction must run with FTZ/DAZ set. This covers floating-
+ * point computations and, as before, calls into code that does not set the
+ * flags itself.
+ *   @inst: The instruction.
+ *   &returns: True if needed.
+ */
+bool ctfp_needs(llvm::Instruction const& inst) {
+	if(llvm::isa<llvm::CallInst>(inst) || llvm::isa<llvm::InvokeInst>(inst)) {
+		const llvm::Function *callee = ctfp_called(inst);
+
+		if((callee == nullptr) || callee->getName().startswith("ctfp_"))
+			return true;
+		else if(!callee->isIntrinsic())
+			return (ctfp_effect(inst) != ftz_set);
+	}
+
+	switch(inst.getOpcode()) {
+	case llvm::Instruction::Load:
+	case llvm::Instruction::Store:
+	case llvm::Instruction::PHI:
+	case llvm::Instruction::Select:
+	case llvm::Instruction::BitCast:
+	case llvm::Instruction::ExtractElement:
+	case llvm::Instruction::InsertElement:
+	case llvm::Instruction::ShuffleVector:
+	case llvm::Instruction::ExtractValue:
+	case llvm::Instruction::InsertValue:
+	case llvm::Instruction::Ret:
+		return false;
+
+	default:
+		break;
+	}
+
+	if(inst.getType()->isFPOrFPVectorTy())
+		return true;
+
+	for(const llvm::Value *op : inst.operands()) {
+		if(op->getType()->isFPOrFPVectorTy())
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Step the FTZ/DAZ state over an instruction.
+ *   @inst: The instruction.
+ *   @set: Whether FTZ/DAZ are known set before it.
+ *   @flags: Whether reloads are inserted where needed.
+ *   &returns: Whether FTZ/DAZ are known set after it.
+ */
+bool ctfp_step(llvm::Instruction const& inst, bool set, bool flags) {
+	if(flags && ctfp_needs(inst))
+		set = true;
+
+	if(llvm::isa<llvm::CallInst>(inst) || llvm::isa<llvm::InvokeInst>(inst)) {
+		switch(ctfp_effect(inst)) {
+		case ftz_keep: break;
+		case ftz_set: set = true; break;
+		case ftz_clobber: set = false; break;
+		}
+	}
+
+	return set;
+}
+
+/**
+ * Compute the FTZ/DAZ state at the start of every block of a function, as
+ * the greatest fixpoint over the control flow.
+ *   @func: The function.
+ *   @entry: Whether FTZ/DAZ are set on entry.
+ *   @flags: Whether the function is in flags mode.
+ *   @in: Output. The state at each block entry.
+ *   &returns: True if the flags are set at every return.
+ */
+bool ctfp_flow(llvm::Function const& func, bool entry, bool flags, std::map<const llvm::BasicBlock *, bool>& in) {
+	std::map<const llvm::BasicBlock *, bool> out;
+	llvm::ReversePostOrderTraversal<const llvm::Function *> rpo(&func);
+
+	in.clear();
+	for(const llvm::BasicBlock &block : func)
+		in[&block] = true, out[&block] = true;
+
+	bool change = true;
+	while(change) {
+		change = false;
+
+		for(const llvm::BasicBlock *block : rpo) {
+			bool set = (block == &func.getEntryBlock()) ? entry : true;
+
+			for(const llvm::BasicBlock *pred : llvm::predecessors(block))
+				set &= out[pred];
+
+			in[block] = set;
+
+			for(const llvm::Instruction &inst : *block)
+				set = ctfp_step(inst, set, flags);
+
+			if(out[block] != set)
+				out[block] = set, change = true;
+		}
+	}
+
+	bool ret = true;
+	for(const llvm::BasicBlock &block : func) {
+		if(llvm::isa<llvm::ReturnInst>(block.getTerminator()))
+			ret &= out[&block];
+	}
+
+	return ret;
+}
+
+/**
+ * Summarize the MXCSR effects of the functions of a module, then find the
+ * flags-mode functions that only have callers with FTZ/DAZ set. Summaries
+ * start optimistic and are lowered to a fixpoint, and the flags-mode
+ * functions that return with FTZ/DAZ set are marked `ctfp_ftz` for later
+ * passes and link-time callers.
+ *   @mod: The module.
+ */
+void ctfp_ftz(llvm::Module& mod) {
+	std::map<const llvm::BasicBlock *, bool> in;
+
+	ctfp_ftzs.clear();
+	ctfp_entered.clear();
+
+	for(llvm::Function &func : mod) {
+		if(!func.isDeclaration() && !func.getName().startswith("ctfp_"))
+			ctfp_ftzs[&func] = ctfp_ftzmode(ctfp_select(func)) ? ftz_set : ftz_keep;
+	}
+
+	bool change = true;
+	while(change) {
+		change = false;
+
+		for(auto &entry : ctfp_ftzs) {
+			bool flags = (entry.second == ftz_set);
+
+			if((entry.second != ftz_clobber) && !ctfp_flow(*entry.first, true, flags, in))
+				entry.second = ftz_clobber, change = true;
+		}
+	}
+
+	std::map<const llvm::Function *, bool> sites;
+
+	for(auto const& entry : ctfp_ftzs) {
+		const llvm::Function *func = entry.first;
+		bool flags = ctfp_ftzmode(ctfp_select(*func));
+
+		ctfp_flow(*func, flags, flags, in);
+
+		for(const llvm::BasicBlock &block : *func) {
+			bool set = in[&block];
+
+			for(const llvm::Instruction &inst : block) {
+				const llvm::Function *callee = ctfp_called(inst);
+
+				if((callee != nullptr) && ctfp_ftzs.count(callee) && ctfp_ftzmode(ctfp_select(*callee))) {
+					auto find = sites.find(callee);
+					sites[callee] = set && ((find == sites.end()) || find->second);
+				}
+
+				set = ctfp_step(inst, set, flags);
+			}
+		}
+	}
+
+	for(auto const& entry : sites) {
+		if(entry.second && ctfp_internal(*entry.first))
+			ctfp_entered.insert(entry.first);
+	}
+
+	for(auto const& entry : ctfp_ftzs) {
+		if(entry.second == ftz_set)
+			const_cast<llvm::Function *>(entry.first)->addFnAttr("ctfp_ftz");
+	}
+}
+
+/**
+ * Insert the MXCSR reloads of a flags-mode function, only where FTZ/DAZ
+ * are not already known to be set.
+ *   @func: The function.
+ */
+void ctfp_reload(llvm::Function& func) {
+	std::map<const llvm::BasicBlock *, bool> in;
+	std::vector<llvm::Instruction *> points;
+
+	ctfp_flow(func, true, true, in);
+
+	for(llvm::BasicBlock &block : func) {
+		bool set = in[&block];
+
+		for(llvm::Instruction &inst : block) {
+			if(!set && ctfp_needs(inst))
+				points.push_back(&inst);
+
+			set = ctfp_step(inst, set, true);
+		}
+	}
+
+	for(llvm::Instruction *inst : points)
+		ctfp_flags(inst);
+
+	if(ctfp_entered.count(&func) == 0)
+		ctfp_flags(func.getEntryBlock().getFirstNonPHI());
+}
+
+/**
+ * Retrieve the range of an argument when nothing is known about its callers.
+ *   @arg: The argument.
+ *   &returns: The range.
+ */
+Range ctfp_default(llvm::Argument const& arg) {
+	Type type = Pass::GetType(arg);
+
+	switch(type.kind) {
+	case Kind::Int:
+		if(type.width == 32)
+			return Range(RangeVecI32(std::vector<RangeI32>(type.count, RangeI32::All())));
+		else if(type.width == 64)
+			return Range(RangeVecI64(std::vector<RangeI64>(type.count, RangeI64::All())));
+
+		break;
+
+	case Kind::Flt:
+		if(type.width == 32)
+			return Range(RangeVecF32::All(type.count));
+		else if(type.width == 64)
+			return Range(RangeVecF64::All(type.count));
+
+		break;
+
+	default:
+		break;
+	}
+
+	return Range(RangeUnk());
+}
+
+/**
+ * Check if all callers of a function are visible. This is the case for
+ * functions with local linkage whose address is never taken.
+ *   @func: The function.
+ *   &returns: True if internal.
+ */
+bool ctfp_internal(llvm::Function const& func) {
+	if(!func.hasLocalLinkage())
+		return false;
+
+	for(const llvm::Use &use : func.uses()) {
+		const llvm::CallInst *call = llvm::dyn_cast<llvm::CallInst>(use.getUser());
+		if((call == nullptr) || (use.getOperandNo() + 1 != call->getNumOperands()))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Retrieve the summarised range of a call result. An interposable callee
+ * may be replaced at link time, so its summary is never used.
+ *   @call: The call.
+ *   &returns: The range, or unknown if there is no summary.
+ */
+Range ctfp_callee(llvm::CallInst const& call) {
+	const llvm::Function *callee = call.getCalledFunction();
+	if((callee == nullptr) || callee->isInterposable())
+		return Range();
+
+	auto find = ctfp_rets.find(callee);
+
+	return (find != ctfp_rets.end()) ? find->second : Range();
+}
+
+/**
+ * Solve the interprocedural range summaries of a module. Functions are
+ * analysed callees first; each round joins the call-site arguments of the
+ * internal functions top-down and the returned ranges bottom-up, widening
+ * after a few rounds. Call-site arguments pass through the guards of their
+ * caller, which only fast-mode callers have. If the rounds run out before
+ * a fixpoint is reached, the summaries are dropped.
+ *   @mod: The module.
+ */
+void ctfp_solve(llvm::Module& mod) {
+	std::vector<llvm::Function *> order;
+
+	ctfp_args.clear();
+	ctfp_rets.clear();
+
+	llvm::CallGraph graph(mod);
+	for(auto scc = llvm::scc_begin(&graph); !scc.isAtEnd(); ++scc) {
+		for(llvm::CallGraphNode *node : *scc) {
+			llvm::Function *func = node->getFunction();
+
+			if((func != nullptr) && !func->isDeclaration() && !func->isInterposable() && (func->getName().str().find("ctfp_") != 0))
+				order.push_back(func);
+		}
+	}
+
+	for(llvm::Function *func : order) {
+		if(ctfp_internal(*func))
+			continue;
+
+		for(auto &arg : func->args())
+			ctfp_args[func].push_back(ctfp_default(arg));
+	}
+
+	for(uint32_t round = 0; round < 16; round++) {
+		std::map<const llvm::Function *, std::vector<Range>> args;
+		bool change = false;
+
+		for(llvm::Function *func : order) {
+			if(ctfp_args.find(func) == ctfp_args.end())
+				continue;
+
+			Pass pass;
+			pass.guard = ctfp_guard;
+			pass.callee = ctfp_callee;
+
+			for(auto &arg : func->args())
+				pass.Put(&arg, ctfp_args[func][arg.getArgNo()]);
+
+			pass.Run(*func);
+
+			Range ret = pass.Return(*func);
+			Type type = Pass::GetType(*func->getReturnType());
+
+			auto prev = ctfp_rets.find(func);
+			if(prev == ctfp_rets.end())
+				ctfp_rets[func] = ret, change = true;
+			else {
+				Range next = (round >= 2) ? Range::Widen(prev->second, ret, type) : ret;
+
+				if(!Range::Equal(prev->second, next))
+					prev->second = next, change = true;
+			}
+
+			for(llvm::BasicBlock &block : *func) {
+				for(llvm::Instruction &inst : block) {
+					llvm::CallInst *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+					if((call == nullptr) || (call->getCalledFunction() == nullptr) || !ctfp_internal(*call->getCalledFunction()))
+						continue;
+
+					std::vector<Range> &in = args[call->getCalledFunction()];
+
+					for(unsigned int i = 0; i < call->getNumArgOperands(); i++) {
+						Range range = pass.Get(*call, i);
+
+						if(in.size() <= i)
+							in.push_back(range);
+						else
+							in[i] = Range::Union(in[i], range, Pass::GetType(*call->getArgOperand(i)));
+					}
+				}
+			}
+		}
+
+		for(auto &next : args) {
+			auto prev = ctfp_args.find(next.first);
+
+			if(prev == ctfp_args.end()) {
+				ctfp_args[next.first] = next.second;
+				change = true;
+				continue;
+			}
+
+			for(uint32_t i = 0; i < next.second.size(); i++) {
+				Type type = Pass::GetType(*(next.first->arg_begin() + i));
+				Range range = (round >= 2) ? Range::Widen(prev->second[i], next.second[i], type) : next.second[i];
+
+				if(!Range::Equal(prev->second[i], range))
+					prev->second[i] = range, change = true;
+			}
+		}
+
+		if(!change)
+			return;
+	}
+
+	ctfp_args.clear();
+	ctfp_rets.clear();
+}
+
+/**
+ * Count the operands that fast mode would guard in a function when it is
+ * entered with the given argument ranges.
+ *   @func: The function.
+ *   @args: The argument ranges.
+ *   &returns: The number of guards.
+ */
+uint32_t ctfp_guards(llvm::Function& func, std::vector<Range> const& args) {
+	uint32_t cnt = 0;
+	Pass pass;
+
+	pass.guard = ctfp_guard;
+	pass.callee = ctfp_callee;
+
+	for(auto &arg : func.args())
+		pass.Put(&arg, args[arg.getArgNo()]);
+
+	pass.Run(func);
+
+	for(llvm::BasicBlock &block : func) {
+		for(llvm::Instruction &inst : block) {
+			Info info = Pass::GetInfo(inst);
+			double min, safe;
+
+			for(unsigned int i = 0; i < inst.getNumOperands(); i++) {
+				if(ctfp_limit(info, i, &min, &safe) && !pass.Get(inst, i).IsSafe(min))
+					cnt++;
+			}
+		}
+	}
+
+	return cnt;
+}
+
+/**
+ * Count the instructions of a function.
+ *   @func: The function.
+ *   &returns: The number of instructions.
+ */
+uint32_t ctfp_size(llvm::Function const& func) {
+	uint32_t cnt = 0;
+
+	for(const llvm::BasicBlock &block : func)
+		cnt += block.size();
+
+	return cnt;
+}
+
+static const uint32_t ctfp_clone_max = 4;
+static const uint32_t ctfp_clone_budget = 50;
+
+/**
+ * Clone fast-mode callees for the call sites whose argument ranges let a
+ * specialised body drop guards. Call-site ranges only reflect the guards of
+ * fast-mode callers, as no other mode places any. Call sites are grouped by
+ * the signature of their argument ranges; a group gets its own internal
+ * clone if the clone needs fewer guards than the shared body. At most
+ * `ctfp_clone_max` clones are made per callee and the total growth is
+ * bounded by `ctfp_clone_budget` percent of the module instructions.
+ *   @mod: The module.
+ *   &returns: True if any clone was made.
+ */
+bool ctfp_clone(llvm::Module& mod) {
+	std::map<llvm::Function *, std::map<std::string, std::pair<std::vector<Range>, std::vector<llvm::CallInst *>>>> sites;
+	uint32_t size = 0, grow = 0;
+	bool change = false;
+
+	for(llvm::Function &func : mod)
+		size += ctfp_size(func);
+
+	for(llvm::Function &func : mod) {
+		if(ctfp_args.find(&func) == ctfp_args.end())
+			continue;
+
+		Pass pass;
+		pass.guard = ctfp_guard;
+		pass.callee = ctfp_callee;
+
+		for(auto &arg : func.args())
+			pass.Put(&arg, ctfp_args[&func][arg.getArgNo()]);
+
+		pass.Run(func);
+
+		for(llvm::BasicBlock &block : func) {
+			for(llvm::Instruction &inst : block) {
+				llvm::CallInst *call = llvm::dyn_cast<llvm::CallInst>(&inst);
+				if((call == nullptr) || (call->getCalledFunction() == nullptr))
+					continue;
+
+				llvm::Function *callee = call->getCalledFunction();
+				if((callee == &func) || callee->isDeclaration() || callee->isInterposable() || (callee->getName().str().find("ctfp_") == 0))
+					continue;
+				else if(ctfp_select(*callee) != fast_v)
+					continue;
+
+				std::vector<Range> args;
+				std::string key;
+
+				for(unsigned int i = 0; i < call->getNumArgOperands(); i++) {
+					args.push_back(pass.Get(*call, i));
+					key += args.back().Str() + "|";
+				}
+
+				auto &site = sites[callee][key];
+				site.first = args;
+				site.second.push_back(call);
+			}
+		}
+	}
+
+	for(auto &entry : sites) {
+		llvm::Function *callee = entry.first;
+		if((entry.second.size() < 2) && ctfp_internal(*callee))
+			continue;
+
+		std::vector<Range> shared;
+		auto find = ctfp_args.find(callee);
+		if(find != ctfp_args.end())
+			shared = find->second;
+		else {
+			for(auto &arg : callee->args())
+				shared.push_back(ctfp_default(arg));
+		}
+
+		uint32_t base = ctfp_guards(*callee, shared), n = 0;
+
+		for(auto &site : entry.second) {
+			if((n >= ctfp_clone_max) || (100 * (grow + ctfp_size(*callee)) > ctfp_clone_budget * size))
+				break;
+
+			if(ctfp_guards(*callee, site.second.first) >= base)
+				continue;
+
+			llvm::ValueToValueMapTy vmap;
+			llvm::Function *clone = llvm::CloneFunction(callee, vmap);
+			clone->setName(callee->getName() + ".ctfp." + std::to_string(n++));
+			clone->setLinkage(llvm::GlobalValue::InternalLinkage);
+
+			for(llvm::CallInst *call : site.second.second)
+				call->setCalledFunction(clone);
+
+			grow += ctfp_size(*callee);
+			change = true;
+		}
+	}
+
+	return change;
+}
+
+/**
+ * Build the interprocedural range summaries of a module, specialising
+ * callees on their call-site ranges where it pays off. The clones are new
+ * functions, so the secret taint is recomputed before solving again.
+ *   @mod: The module.
+ */
+void ctfp_summary(llvm::Module& mod) {
+	ctfp_solve(mod);
+
+	if(ctfp_clone(mod)) {
+		if(ctfp_tainted)
+			ctfp_taint.Run(mod);
+
+		ctfp_solve(mod);
+	}
+}
+
+/**
+ * Prepare a module before any of its functions is transformed. Only here
+ * may the pass add functions and change other functions than the one it
+ * runs on, so the mode annotations, the secret taint, the range summaries
+ * with their clones and the MXCSR summaries are all computed up front.
+ *   @mod: The module.
+ *   &returns: True if modified.
+ */
+bool ctfp_init(llvm::Module& mod) {
+	bool fast = false, ftz = false;
+
+	ctfp_args.clear();
+	ctfp_rets.clear();
+	ctfp_annotate(mod);
+
+	if(ctfp_tainted)
+		ctfp_taint.Run(mod);
+
+	for(llvm::Function &func : mod) {
+		if(func.isDeclaration())
+			continue;
+
+		fast |= (ctfp_select(func) == fast_v);
+		ftz |= ctfp_ftzmode(ctfp_select(func));
+	}
+
+	if(fast)
+		ctfp_summary(mod);
+
+	if(ftz)
+		ctfp_ftz(mod);
+
+	return true;
+}
+
+/**
+ * Finish a module once all of its functions are transformed. The kernels
+ * are only removed here, so that each is copied into the module once, and
+ * the bitcode they came from is released with the summaries.
+ *   @mod: The module.
+ *   &returns: True if modified.
+ */
+bool ctfp_done(llvm::Module& mod) {
+	ctfp_cleanup(mod);
+	ctfp_copies.clear();
+	ctfp_src.reset();
+
+	ctfp_args.clear();
+	ctfp_rets.clear();
+	ctfp_ftzs.clear();
+	ctfp_entered.clear();
+
+	return true;
+}
+
+/**
+ * Run CTFP on a function.
+ *   @func: The function.
+ *   &returns: True if modified.
+ */
+bool ctfp_func(llvm::Function& func) {
+	Pass pass;
+
+	if(func.getName().str().find("ctfp_restrict_") == 0)
+		return false;
+	else if(func.getName().str().find("ctfp_full_") == 0)
+		return false;
+	else if(func.getName().str().find("ctfp_fast_") == 0)
+		return false;
+
+	ctfp_mode = ctfp_select(func);
+	if(ctfp_mode == off_v)
+		return false;
+
+	if(ctfp_kernels(ctfp_mode)) {
+		std::function<bool(llvm::Instruction const&)> secret;
+		if(ctfp_tainted)
+			secret = [](llvm::Instruction const& inst) { return ctfp_taint.Secret(inst); };
+
+		for(llvm::BasicBlock &block : func)
+			ctfp_pack(block, secret);
+	}
+
+	if(ctfp_tainted)
+		ctfp_taint.Func(func);
+
+	int i = 0;
+	for(auto &arg : func.args()) {
+		if(arg.getName() == "")
+			arg.setName("a" + std::to_string(i++));
+
+		auto find = ctfp_args.find(&func);
+		pass.Put(&arg, (find != ctfp_args.end()) ? find->second[arg.getArgNo()] : ctfp_default(arg));
+	}
+
+	if(ctfp_ftzmode(ctfp_mode))
+		ctfp_reload(func);
+
+	if(ctfp_mode == fast_v) {
+		pass.guard = ctfp_guard;
+		pass.callee = ctfp_callee;
+		pass.Run(func);
+		ctfp_place(func, pass);
+	}
+	else if(ctfp_mode == hybrid_v)
+		pass.Run(func);
+
+	for(llvm::BasicBlock &block : func)
+		ctfp_block(block, pass);
+
+	return true;
+}
+
+
+/**
+ * Parse a mode name, case insensitive.
+ *   @str: The name.
+ *   @mode: Output. The mode.
+ *   &returns: True on success.
+ */
+bool ctfp_parse(std::string str, enum mode_e *mode) {
+	std::transform(str.begin(), str.end(), str.begin(), ::tolower);
+
+	if(str == "basic")
+		*mode = basic_v;
+	else if((str == "rest") || (str == "restrict"))
+		*mode = rest_v;
+	else if(str == "full")
+		*mode = full_v;
+	else if(str == "fast")
+		*mode = fast_v;
+	else if(str == "flags")
+		*mode = flags_v;
+	else if(str == "stats")
+		*mode = stats_v;
+	else if(str == "hybrid")
+		*mode = hybrid_v;
+	else if(str == "off")
+		*mode = off_v;
+	else
+		return false;
+
+	return true;
+}
+
+/**
+ * Check if a mode runs with FTZ/DAZ set.
+ *   @mode: The mode.
+ *   &returns: True for flags and hybrid modes.
+ */
+bool ctfp_ftzmode(enum mode_e mode) {
+	return (mode == flags_v) || (mode == hybrid_v);
+}
+
+/**
+ * Check if a mode replaces operations by kernel calls.
+ *   @mode: The mode.
+ *   &returns: True for all but the stats, hybrid and off modes.
+ */
+bool ctfp_kernels(enum mode_e mode) {
+	return (mode != stats_v) && (mode != hybrid_v) && (mode != off_v);
+}
+
+/**
+ * Turn the `ctfp_mode(name)` annotations of a module into `ctfp_mode`
+ * function attributes, which also survive cloning.
+ *   @mod: The module.
+ */
+void ctfp_annotate(llvm::Module& mod) {
+	llvm::GlobalVariable *annot = mod.getGlobalVariable("llvm.global.annotations");
+	if((annot == nullptr) || !annot->hasInitializer())
+		return;
+
+	llvm::ConstantArray *list = llvm::dyn_cast<llvm::ConstantArray>(annot->getInitializer());
+	if(list == nullptr)
+		return;
+
+	static const std::regex pat("^ctfp_mode\\(\"?([A-Za-z]+)\"?\\)$");
+
+	for(unsigned int i = 0; i < list->getNumOperands(); i++) {
+		llvm::ConstantStruct *entry = llvm::dyn_cast<llvm::ConstantStruct>(list->getOperand(i));
+		if(entry == nullptr)
+			continue;
+
+		llvm::Function *func = llvm::dyn_cast<llvm::Function>(entry->getOperand(0)->stripPointerCasts());
+		std::string str = Pass::Annot(entry->getOperand(1));
+		std::smatch match;
+		enum mode_e mode;
+
+		if((func == nullptr) || !std::regex_match(str, match, pat))
+			continue;
+		else if(!ctfp_parse(match[1].str(), &mode))
+			fatal("Unknown CTFP mode '%s' on '%s'.", match[1].str().c_str(), func->getName().str().c_str());
+
+		func->addFnAttr("ctfp_mode", match[1].str());
+	}
+}
+
+/**
+ * Select the mode of a function, either from its `ctfp_mode` attribute,
+ * which `ctfp_init` also derives from annotations, or the default.
+ *   @func: The function.
+ *   &returns: The mode.
+ */
+enum mode_e ctfp_select(llvm::Function const& func) {
+	enum mode_e mode = ctfp_base;
+
+	if(func.hasFnAttribute("ctfp_mode") && !ctfp_parse(func.getFnAttribute("ctfp_mode").getValueAsString().str(), &mode))
+		fatal("Unknown CTFP mode '%s' on '%s'.", func.getFnAttribute("ctfp_mode").getValueAsString().str().c_str(), func.getName().str().c_str());
+
+	return mode;
+}
+
+/**
+ * Cleanup the leftover CTFP functions. Kernels may call each other, so all
+ * bodies are dropped before the unused kernels are erased.
+ *   @mod: The module.
+ */
+void ctfp_cleanup(llvm::Module& mod)
+{
+	std::vector<llvm::Function *> kernels;
+
+	for(llvm::Function &func : mod) {
+		std::string name = func.getName().str();
+		if(regex_match(name, std::regex("^ctfp_restrict_.*$")))
+			kernels.push_back(&func);
+		else if(regex_match(name, std::regex("^ctfp_full_.*$")))
+			kernels.push_back(&func);
+		else if(regex_match(name, std::regex("^ctfp_fast_.*$")))
+			kernels.push_back(&func);
+	}
+
+	for(llvm::Function *func : kernels)
+		func->dropAllReferences();
+
+	for(llvm::Function *func : kernels) {
+		if(func->use_empty())
+			func->eraseFromParent();
+	}
+}
+
+static const float addmin32 = 9.86076131526264760e-32f;
+static const double addmin64 = 2.00416836000897278e-292;
+static const float mulmin32 = 1.08420217248550443e-19f;
+static const double mulmin64 = 1.49166814624004135e-154;
+static const float divmax32 = 4.61168601842738790e+18f;
+static const double divmax64 = 3.35195198248564927e+153;
+#define SQR(x) (x*x)
+static const float safemin32 = SQR(5.960464477539063e-8f);
+static const double safemin64 = SQR(1.1102230246251565e-16);
+static const float safemax32 = SQR(16777216.0f);
+static const double safemax64 = SQR(9007199254740992.0);
+
+/**
+ * Retrieve the limits of the fast kernels for an operand.
+ *   @info: The instruction info.
+ *   @i: The operand index.
+ *   @min: Output. The smallest magnitude handled without protection.
+ *   @safe: Output. The value passed to the protection.
+ *   &returns: True if the operand must be checked.
+ */
+bool ctfp_limit(Info const& info, unsigned int i, double *min, double *safe) {
+	bool f32 = (info.type.width == 32);
+
+	if((info.type.kind != Kind::Flt) || ((info.type.width != 32) && (info.type.width != 64)))
+		return false;
+
+	switch(info.op) {
+	case Op::Add:
+	case Op::Sub:
+		if(i > 1)
+			return false;
+
+		*min = f32 ? addmin32 : addmin64;
+		*safe = f32 ? safemin32 : safemin64;
+		return true;
 
-	for(llvm::BasicBlock &block : func) {
-		for(llvm::Instruction &inst : block) {
-			if((inst.getOpcode() != llvm::Instruction::FAdd) && (inst.getOpcode() != llvm::Instruction::FSub) && (inst.getOpcode() != llvm::Instruction::FMul) && (inst.getOpcode() != llvm::Instruction::FDiv))
-				continue;
+	case Op::Mul:
+		if(i > 1)
+			return false;
 
-			if(!inst.getType()->isFloatTy() && !inst.getType()->isDoubleTy())
-				continue;
+		*min = f32 ? mulmin32 : mulmin64;
+		*safe = f32 ? safemin32 : safemin64;
+		return true;
 
-			llvm::Type *itype = inst.getType()->isFloatTy() ? llvm::Type::getInt32Ty(ctx) : llvm::Type::getInt64Ty(ctx);
-			llvm::Type *type = llvm::VectorType::get(inst.getType(), 4);
-			llvm::UndefValue *undef = llvm::UndefValue::get(type);
-			llvm::Constant *zero = llvm::ConstantInt::get(itype, 0);
-
-			if(llvm::isa<llvm::BinaryOperator>(inst)) {
-				llvm::Instruction::BinaryOps op = llvm::cast<llvm::BinaryOperator>(inst).getOpcode();
-				llvm::Instruction *lhs = llvm::InsertElementInst::Create(undef, inst.getOperand(0), zero, "", &inst);
-				llvm::Instruction *rhs = llvm::InsertElementInst::Create(undef, inst.getOperand(1), zero, "", &inst);
-				llvm::Instruction *ret = llvm::BinaryOperator::Create(op, lhs, rhs, "", &inst);
-				llvm::Instruction *done = llvm::ExtractElementInst::Create(ret, zero, "", &inst);
-				inst.replaceAllUsesWith(done);
-			}
-		}
+	case Op::Div:
+		if(i > 1)
+			return false;
+
+		*min = (i == 0) ? (f32 ? mulmin32 : mulmin64) : (f32 ? divmax32 : divmax64);
+		*safe = (i == 0) ? (f32 ? safemin32 : safemin64) : (f32 ? safemax32 : safemax64);
+		return true;
+
+	case Op::Sqrt:
+		if(i > 0)
+			return false;
+
+		*min = f32 ? FLT_MIN : DBL_MIN;
+		*safe = f32 ? safemin32 : safemin64;
+		return true;
+
+	default:
+		return false;
 	}
 }
 
 /**
- * Run CTFP on a function.
- *   @func: The function.
- *   &returns: True if modified.
+ * Compute the range of an operand after the guard that fast mode would
+ * place on it, used as the operand filter of the analysis. Only fast-mode
+ * functions are guarded, so operands elsewhere keep their range.
+ *   @inst: The instruction.
+ *   @i: The operand index.
+ *   @range: The unguarded range.
+ *   &returns: The guarded range.
  */
-bool ctfp_func(llvm::Function& func) {
-	Pass pass;
+Range ctfp_guard(llvm::Instruction const& inst, unsigned int i, Range const& range) {
+	double min, safe;
 
-	if(func.getName().str().find("ctfp_restrict_") == 0)
-		return false;
-	else if(func.getName().str().find("ctfp_full_") == 0)
-		return false;
-	else if(func.getName().str().find("ctfp_fast_") == 0)
-		return false;
+	if(ctfp_select(*inst.getFunction()) != fast_v)
+		return range;
+
+	Info info = Pass::GetInfo(inst);
 
-	ctfp_hack(func);
+	if(!ctfp_limit(info, i, &min, &safe) || range.IsSafe(min))
+		return range;
+	else if(ctfp_tainted && !ctfp_taint.Secret(inst))
+		return range;
 
-	llvm::Module *mod = func.getParent();
-	if(mod->getFunction("ctfp_restrict_add_f32v4") == nullptr) {
-		llvm::SMDiagnostic err;
-		std::unique_ptr<llvm::WritableMemoryBuffer> mem = llvm::WritableMemoryBuffer::getNewUninitMemBuffer(ctfp_bc_len);
+	return Range(range).Protect(info.type, safe);
+}
 
-		memcpy(mem->getBufferStart(), ctfp_bc, ctfp_bc_len);
+/**
+ * Compute the dynamic weight of a block from its loop depth.
+ *   @loops: The loop info.
+ *   @block: The block.
+ *   &returns: The weight.
+ */
+uint64_t ctfp_weight(llvm::LoopInfo const& loops, const llvm::BasicBlock *block) {
+	return 1ull << (3 * std::min(loops.getLoopDepth(block), 16u));
+}
 
-		std::unique_ptr<llvm::Module> parse = llvm::parseIR(mem->getMemBufferRef(), err, func.getContext());
-		if(parse == nullptr)
-			fprintf(stderr, "Failed to load CTFP bitcode.\n"), abort();
+/**
+ * Choose the blocks that hold the guard of one value. A guard at a block
+ * covers every use in the blocks it dominates; the cheapest cover of the
+ * dominator subtree is found bottom-up, which is the minimum cut between
+ * the definition and the unsafe uses when weighted by loop depth.
+ *   @node: The dominator tree node.
+ *   @live: The blocks on a path from the definition to a use.
+ *   @uses: The blocks with a direct use.
+ *   @loops: The loop info.
+ *   @place: Output. The chosen blocks.
+ *   &returns: The cost of the cover.
+ */
+uint64_t ctfp_cut(llvm::DomTreeNode *node, std::set<const llvm::BasicBlock *> const& live, std::set<const llvm::BasicBlock *> const& uses, llvm::LoopInfo const& loops, std::vector<const llvm::BasicBlock *>& place) {
+	const llvm::BasicBlock *block = node->getBlock();
+	uint64_t here = ctfp_weight(loops, block), below = 0;
+	size_t mark = place.size();
+
+	if(uses.count(block) == 0) {
+		for(llvm::DomTreeNode *child : node->getChildren()) {
+			if(live.count(child->getBlock()) > 0)
+				below += ctfp_cut(child, live, uses, loops, place);
+		}
 
-		if(llvm::Linker::linkModules(*mod, std::move(parse)))
-			fprintf(stderr, "Link failed.\n"), abort();
+		/* a block without an insertion point, such as a catchswitch, cannot hold the guard */
+		if((below < here) || (block->getFirstInsertionPt() == block->end()))
+			return below;
 	}
 
-	int i = 0;
-	for(auto &arg : func.args()) {
-		if(arg.getName() == "")
-			arg.setName("a" + std::to_string(i++));
+	place.resize(mark);
+	place.push_back(block);
 
-		Range range;
-		Type type = Pass::GetType(arg);
+	return here;
+}
 
-		switch(type.kind) {
-		case Kind::Unk:
-			range = Range(RangeUnk());
-			break;
+/**
+ * Retrieve the first point where the value of an instruction is available
+ * to a guard. This is past the PHI nodes and EH pads of its block, or at
+ * the start of the normal destination for an invoke.
+ *   @def: The instruction.
+ *   &returns: The insertion point.
+ */
+llvm::Instruction *ctfp_after(llvm::Instruction *def) {
+	if(llvm::isa<llvm::InvokeInst>(def))
+		return &*llvm::cast<llvm::InvokeInst>(def)->getNormalDest()->getFirstInsertionPt();
+	else if(llvm::isa<llvm::PHINode>(def) || def->isEHPad())
+		return &*def->getParent()->getFirstInsertionPt();
+	else
+		return def->getNextNode();
+}
 
-		case Kind::Int:
-			if(type.width == 32)
-				range = Range(RangeVecI32(std::vector<RangeI32>(type.count, RangeI32::All())));
-			else if(type.width == 64)
-				range = Range(RangeVecI64(std::vector<RangeI64>(type.count, RangeI64::All())));
+/**
+ * Place the guards required by fast mode. All unsafe operands are
+ * collected first and grouped per value and safe bound, so that a value
+ * feeding several unsafe uses is guarded once. Each group is then placed
+ * at the cheapest set of dominating blocks, which hoists guards of
+ * loop-invariant values out of loops and places a guard at the producer
+ * when that covers the uses most cheaply. Only the unsafe uses are
+ * rewritten; other uses keep the original value.
+ *   @func: The function.
+ *   @pass: The pass, with the ranges of the function.
+ */
+void ctfp_place(llvm::Function& func, Pass& pass) {
+	std::map<std::pair<llvm::Value *, double>, std::vector<std::pair<llvm::Instruction *, unsigned int>>> need;
+	llvm::LoopInfo loops(*pass.dom);
 
-			break;
+	for(llvm::BasicBlock &block : func) {
+		for(llvm::Instruction &inst : block) {
+			Info info = Pass::GetInfo(inst);
+			double min, safe;
 
-		case Kind::Flt:
-			if(type.width == 32)
-				range = Range(RangeVecF32(std::vector<RangeF32>(type.count, RangeF32::All())));
-			else if(type.width == 64)
-				range = Range(RangeVecF64(std::vector<RangeF64>(type.count, RangeF64::All())));
+			if(ctfp_tainted && !ctfp_taint.Secret(inst))
+				continue;
 
-			break;
+			for(unsigned int i = 0; i < inst.getNumOperands(); i++) {
+				if(ctfp_limit(info, i, &min, &safe) && !pass.Get(inst, i).IsSafe(min))
+					need[{ inst.getOperand(i), safe }].push_back({ &inst, i });
+			}
 		}
-
-		pass.map[&arg] = range;
 	}
 
-	if(ctfp_mode == flags_v) {
-		for(llvm::BasicBlock &block : func) {
-			for(llvm::Instruction &inst : block) {
-				if(inst.getOpcode() == llvm::Instruction::Call)
-					ctfp_flags(&inst);
-			}
-		}
+	for(auto &group : need) {
+		llvm::Value *val = group.first.first;
+		double safe = group.first.second;
+		std::set<const llvm::BasicBlock *> live, uses;
 
-		ctfp_flags(func.getEntryBlock().getFirstNonPHI());
-	}
+		llvm::Instruction *def = llvm::dyn_cast<llvm::Instruction>(val);
+		llvm::BasicBlock *root = (def != nullptr) ? def->getParent() : &func.getEntryBlock();
 
-	for(llvm::BasicBlock &block : func)
-		ctfp_block(block, pass);
+		for(auto &use : group.second) {
+			uses.insert(use.first->getParent());
 
-	ctfp_cleanup(*func.getParent());
+			for(llvm::DomTreeNode *node = pass.dom->getNode(use.first->getParent()); node != nullptr; node = node->getIDom()) {
+				if(!live.insert(node->getBlock()).second || (node->getBlock() == root))
+					break;
+			}
+		}
 
-	return true;
-}
+		std::vector<const llvm::BasicBlock *> place;
+		ctfp_cut(pass.dom->getNode(root), live, uses, loops, place);
 
+		std::map<const llvm::BasicBlock *, llvm::Value *> guards;
 
-/**
- * Cleanup the leftover CTFP functions.
- *   @mod: The module.
- */
-void ctfp_cleanup(llvm::Module& mod)
-{
-	auto iter = mod.begin();
+		for(const llvm::BasicBlock *block : place) {
+			llvm::Instruction *at;
 
-	while(iter != mod.end()) {
-		llvm::Function *func = &*iter++;
+			if((block == root) && (def != nullptr))
+				at = ctfp_after(def);
+			else
+				at = &*const_cast<llvm::BasicBlock *>(block)->getFirstInsertionPt();
 
-		std::string name = func->getName().str();
-		if(regex_match(name, std::regex("^ctfp_restrict_.*$")))
-			func->eraseFromParent();
-		else if(regex_match(name, std::regex("^ctfp_full_.*$")))
-			func->eraseFromParent();
-		else if(regex_match(name, std::regex("^ctfp_fast_.*$")))
-			func->eraseFromParent();
+			llvm::Value *guard = ctfp_protect(val, safe, at);
+			pass.Put(guard, pass.Lookup(val, block).Protect(Pass::GetType(*val), safe));
+			guards[block] = guard;
+		}
+
+		for(auto &use : group.second) {
+			for(llvm::DomTreeNode *node = pass.dom->getNode(use.first->getParent()); node != nullptr; node = node->getIDom()) {
+				auto find = guards.find(node->getBlock());
+				if(find != guards.end()) {
+					use.first->setOperand(use.second, find->second);
+					break;
+				}
+			}
+		}
 	}
 }
 
-static const float addmin32 = 9.86076131526264760e-32f;
-static const double addmin64 = 2.00416836000897278e-292;
-static const float mulmin32 = 1.08420217248550443e-19f;
-static const double mulmin64 = 1.49166814624004135e-154;
-static const float divmax32 = 4.61168601842738790e+18f;
-static const double divmax64 = 3.35195198248564927e+153;
-#define SQR(x) (x*x)
-static const float safemin32 = SQR(5.960464477539063e-8f);
-static const double safemin64 = SQR(1.1102230246251565e-16);
-static const float safemax32 = SQR(16777216.0f);
-static const double safemax64 = SQR(9007199254740992.0);
-
 /**
  * Run CTFP on a block.
  *   @block: The block.
@@ -232,6 +1366,13 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 		llvm::Instruction *inst = &*iter++;
 		Info info = Pass::GetInfo(*inst);
 
+		if(ctfp_tainted && !ctfp_taint.Secret(*inst)) {
+			if(ctfp_mode == fast_v)
+				pass.Proc(*inst);
+
+			continue;
+		}
+
 		const char *op = nullptr;
 
 		switch(info.op) {
@@ -244,127 +1385,6 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 		}
 
 		if(ctfp_mode == fast_v) {
-			if(((info.op == Op::Add) || (info.op == Op::Sub)) && (info.type.kind == Kind::Flt) && (info.type.width == 32)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(addmin32)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin32);
-					ctfp_protect(inst, 0, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(addmin32)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemin32);
-					ctfp_protect(inst, 1, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if(((info.op == Op::Add) || (info.op == Op::Sub)) && (info.type.kind == Kind::Flt) && (info.type.width == 64)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(addmin64)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin64);
-					ctfp_protect(inst, 0, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(addmin64)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemin64);
-					ctfp_protect(inst, 1, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if((info.op == Op::Mul) && (info.type.kind == Kind::Flt) && (info.type.width == 32)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(mulmin32)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin32);
-					ctfp_protect(inst, 0, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(mulmin32)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemin32);
-					ctfp_protect(inst, 1, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if((info.op == Op::Mul) && (info.type.kind == Kind::Flt) && (info.type.width == 64)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(mulmin64)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin64);
-					ctfp_protect(inst, 0, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(mulmin64)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemin64);
-					ctfp_protect(inst, 1, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if((info.op == Op::Div) && (info.type.kind == Kind::Flt) && (info.type.width == 32)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(mulmin32)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin32);
-					ctfp_protect(inst, 0, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(divmax32)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemax32);
-					ctfp_protect(inst, 1, safemax32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if((info.op == Op::Div) && (info.type.kind == Kind::Flt) && (info.type.width == 64)) {
-				llvm::Value *lhs = inst->getOperand(0);
-				if(!pass.GetRange(lhs).IsSafe(mulmin64)) {
-					Range safe = pass.map[lhs].Protect(info.type, safemin64);
-					ctfp_protect(inst, 0, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-
-				llvm::Value *rhs = inst->getOperand(1);
-				if(!pass.GetRange(rhs).IsSafe(divmax64)) {
-					Range safe = pass.map[rhs].Protect(info.type, safemax64);
-					ctfp_protect(inst, 1, safemax64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(1)] = safe;
-				}
-			}
-			else if((info.op == Op::Sqrt) && (info.type.kind == Kind::Flt) && (info.type.width == 32)) {
-				llvm::Value *in = inst->getOperand(0);
-				if(!pass.GetRange(in).IsSafe(FLT_MIN)) {
-					Range safe = pass.map[in].Protect(info.type, safemin64);
-					ctfp_protect(inst, 0, safemin32);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-			}
-			else if((info.op == Op::Sqrt) && (info.type.kind == Kind::Flt) && (info.type.width == 64)) {
-				llvm::Value *in = inst->getOperand(0);
-				if(!pass.GetRange(in).IsSafe(DBL_MIN)) {
-					Range safe = pass.map[in].Protect(info.type, safemin64);
-					ctfp_protect(inst, 0, safemin64);
-					//printf("Protect!\n");
-					pass.map[inst->getOperand(0)] = safe;
-				}
-			}
-
 			pass.Proc(*inst);
 			//pass.map[iter - 1] = pass.map[inst];
 
@@ -381,9 +1401,9 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 
 			if((op != nullptr) && (info.type.width > 0) && (inst->getNumUses() > 0)) {
 				llvm::Use *use = &*inst->use_begin();
-				Range range = pass.map[inst];
+				const Range *range = pass.map.Find(inst);
 				ctfp_replace(inst, (std::string("ctfp_fast_") + op + "_f" + std::to_string(info.type.width) + "v" + std::to_string(info.type.count)).data());
-				pass.map[use->get()] = range;
+				pass.map.Set(use->get(), range);
 			}
 		}
 		else if(ctfp_mode == rest_v) {
@@ -416,17 +1436,25 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 		else if(ctfp_mode == basic_v) {
 			if((op != nullptr) && (info.type.width > 0) && (inst->getNumUses() > 0)) {
 				llvm::Use *use = &*inst->use_begin();
-				Range range = pass.map[inst];
+				const Range *range = pass.map.Find(inst);
 				ctfp_replace(inst, (std::string("ctfp_fast_") + op + "_f" + std::to_string(info.type.width) + "v" + std::to_string(info.type.count)).data());
-				pass.map[use->get()] = range;
+				pass.map.Set(use->get(), range);
 			}
 		}
 		else if(ctfp_mode == flags_v) {
 			if((op != nullptr) && (info.type.width > 0) && (inst->getNumUses() > 0)) {
 				llvm::Use *use = &*inst->use_begin();
-				Range range = pass.map[inst];
+				const Range *range = pass.map.Find(inst);
 				ctfp_replace(inst, (std::string("ctfp_fast_") + op + "_f" + std::to_string(info.type.width) + "v" + std::to_string(info.type.count)).data());
-				pass.map[use->get()] = range;
+				pass.map.Set(use->get(), range);
+			}
+		}
+		else if(ctfp_mode == hybrid_v) {
+			if((op != nullptr) && ((info.type.width == 32) || (info.type.width == 64)) && ctfp_hybrid(*inst, pass)) {
+				llvm::Value *fix = ctfp_correct(inst, info);
+
+				pass.map.Set(fix, pass.map.Find(inst));
+				inst->replaceAllUsesWith(fix);
 			}
 		}
 		else if(ctfp_mode == stats_v) {
@@ -442,10 +1470,21 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 			}
 
 			if(name[0] != '\0') {
-				auto type = llvm::FunctionType::get(inst->getType(), { inst->getType(), inst->getType() }, false);
+				std::vector<llvm::Value*> ops;
+
+				if(llvm::isa<llvm::CallInst>(inst))
+					ops.assign(llvm::cast<llvm::CallInst>(inst)->arg_begin(), llvm::cast<llvm::CallInst>(inst)->arg_end());
+				else
+					ops.assign(inst->op_begin(), inst->op_end());
+
+				ops.push_back(llvm::ConstantInt::get(llvm::Type::getInt32Ty(mod->getContext()), ctfp_site(inst, name)));
+
+				std::vector<llvm::Type*> types;
+				for(llvm::Value *op : ops)
+					types.push_back(op->getType());
+
+				auto type = llvm::FunctionType::get(inst->getType(), types, false);
 				llvm::Constant *func = mod->getOrInsertFunction(name, type);
-				//std::vector<llvm::Value*> ops = { inst->getOperand(0), inst->getOperand(1) };
-				std::vector<llvm::Value*> ops(inst->op_begin(), inst->op_end());
 				llvm::CallInst *call = llvm::CallInst::Create(type, func, ops, "", inst);
 				inst->replaceAllUsesWith(call);
 			}
@@ -454,13 +1493,368 @@ void ctfp_block(llvm::BasicBlock& block, Pass& pass) {
 }
 
 /**
- * Protect an instruction operand.
+ * Emit the identifier of a stats-mode site. The site is named after its
+ * function, debug location and runtime call, and a `{ id, name }` entry is
+ * placed into the `ctfp_sites` section for the runtime to resolve. The
+ * identifier is the FNV-1a hash of the name; collisions are disambiguated
+ * with a counter, and zero and all ones are reserved.
  *   @inst: The instruction.
- *   @i: The operand index.
+ *   @id: The runtime function name.
+ *   &returns: The site identifier.
+ */
+uint32_t ctfp_site(llvm::Instruction *inst, const char *id) {
+	llvm::Module *mod = inst->getModule();
+	llvm::LLVMContext &ctx = mod->getContext();
+	std::string base = inst->getFunction()->getName().str();
+
+	if(inst->getDebugLoc())
+		base += " " + inst->getDebugLoc()->getFilename().str() + ":" + std::to_string(inst->getDebugLoc().getLine()) + ":" + std::to_string(inst->getDebugLoc().getCol());
+	else
+		base += " ?";
+
+	base += std::string(" ") + id;
+
+	std::string name;
+	uint32_t hash;
+
+	for(unsigned int n = 0; ; n++) {
+		name = (n == 0) ? base : (base + " #" + std::to_string(n));
+		hash = 2166136261u;
+
+		for(char c : name)
+			hash = (hash ^ (uint8_t)c) * 16777619u;
+
+		if((hash != 0) && (hash != UINT32_MAX) && ctfp_sites.insert(hash).second)
+			break;
+	}
+
+	llvm::Constant *str = llvm::ConstantDataArray::getString(ctx, name);
+	llvm::GlobalVariable *text = new llvm::GlobalVariable(*mod, str->getType(), true, llvm::GlobalValue::PrivateLinkage, str, "ctfp.site.name");
+
+	llvm::Type *i32 = llvm::Type::getInt32Ty(ctx);
+	llvm::Type *ptr = llvm::Type::getInt8PtrTy(ctx);
+	llvm::StructType *type = llvm::StructType::get(i32, ptr);
+	llvm::Constant *init = llvm::ConstantStruct::get(type, { llvm::ConstantInt::get(i32, hash), llvm::ConstantExpr::getPointerCast(text, ptr) });
+
+	llvm::GlobalVariable *site = new llvm::GlobalVariable(*mod, type, true, llvm::GlobalValue::PrivateLinkage, init, "ctfp.site");
+	site->setSection("ctfp_sites");
+	site->setAlignment(8);
+	llvm::appendToCompilerUsed(*mod, { site });
+
+	return hash;
+}
+
+/*
+ * hybrid-mode corrections
+ *   Hybrid functions run with FTZ/DAZ set, so subnormal operands read as
+ *   zero and subnormal results are flushed. The operations that the range
+ *   analysis cannot prove free of subnormals are rebuilt with only normal
+ *   intermediate values, in constant time, and return the IEEE result:
+ *   32-bit operations are computed exactly in double precision (the double
+ *   rounding is innocuous for 53 >= 2*24+2 bits), 64-bit additions are
+ *   scaled into the normal range, where tiny sums are exact, and 64-bit
+ *   products and quotients are split into mantissa and exponent, with the
+ *   exact `fma` error breaking the ties of subnormal rounding.
+ */
+
+/**
+ * Check if a hybrid-mode operation may read or produce subnormals, in which
+ * case it must be corrected.
+ *   @inst: The instruction.
+ *   @pass: The pass.
+ *   &returns: True if a correction is needed.
+ */
+bool ctfp_hybrid(llvm::Instruction const& inst, Pass& pass) {
+	unsigned int n = llvm::isa<llvm::CallInst>(inst) ? llvm::cast<llvm::CallInst>(inst).getNumArgOperands() : inst.getNumOperands();
+
+	for(unsigned int i = 0; i < n; i++) {
+		if(inst.getOperand(i)->getType()->isFPOrFPVectorTy() && pass.Get(inst, i).HasSubnorm())
+			return true;
+	}
+
+	return pass.map.Get(&inst).HasSubnorm();
+}
+
+/**
+ * Retrieve a type with the shape of another and a new element type.
+ *   @type: The shape.
+ *   @elem: The element type.
+ *   &returns: The type.
+ */
+llvm::Type *ctfp_shape(llvm::Type *type, llvm::Type *elem) {
+	return type->isVectorTy() ? llvm::VectorType::get(elem, type->getVectorNumElements()) : elem;
+}
+
+/**
+ * Retrieve the integer type with the shape and width of a float type.
+ *   @type: The float type.
+ *   &returns: The integer type.
+ */
+llvm::Type *ctfp_bits(llvm::Type *type) {
+	return ctfp_shape(type, llvm::IntegerType::get(type->getContext(), type->getScalarSizeInBits()));
+}
+
+/**
+ * Build a power of two from an integer exponent.
+ *   @irb: The builder.
+ *   @exp: The 64-bit exponent, within [-1022, 1023].
+ *   @type: The double type.
+ *   &returns: The power.
+ */
+llvm::Value *ctfp_pow2(llvm::IRBuilder<>& irb, llvm::Value *exp, llvm::Type *type) {
+	llvm::Value *bias = irb.CreateAdd(exp, llvm::ConstantInt::get(exp->getType(), 1023));
+
+	return irb.CreateBitCast(irb.CreateShl(bias, 52), type);
+}
+
+/**
+ * Clamp an integer value.
+ *   @irb: The builder.
+ *   @val: The value.
+ *   @lo: The lower bound.
+ *   @hi: The upper bound.
+ *   &returns: The clamped value.
+ */
+llvm::Value *ctfp_clamp(llvm::IRBuilder<>& irb, llvm::Value *val, int64_t lo, int64_t hi) {
+	llvm::Constant *min = llvm::ConstantInt::getSigned(val->getType(), lo);
+	llvm::Constant *max = llvm::ConstantInt::getSigned(val->getType(), hi);
+
+	val = irb.CreateSelect(irb.CreateICmpSLT(val, min), min, val);
+	val = irb.CreateSelect(irb.CreateICmpSGT(val, max), max, val);
+
+	return val;
+}
+
+/**
+ * Widen a float to double exactly, also for subnormals read under DAZ.
+ *   @irb: The builder.
+ *   @val: The float value.
+ *   &returns: The double value.
+ */
+llvm::Value *ctfp_widen(llvm::IRBuilder<>& irb, llvm::Value *val) {
+	llvm::Type *dbl = ctfp_shape(val->getType(), irb.getDoubleTy());
+	llvm::Type *i32 = ctfp_bits(val->getType()), *i64 = ctfp_bits(dbl);
+
+	llvm::Value *bits = irb.CreateBitCast(val, i32);
+	llvm::Value *sub = irb.CreateICmpEQ(irb.CreateAnd(bits, 0x7F800000), llvm::ConstantInt::get(i32, 0));
+	llvm::Value *mag = irb.CreateFMul(irb.CreateUIToFP(irb.CreateAnd(bits, 0x007FFFFF), dbl), llvm::ConstantFP::get(dbl, std::ldexp(1.0, -149)));
+	llvm::Value *sign = irb.CreateShl(irb.CreateZExt(irb.CreateAnd(bits, 0x80000000), i64), 32);
+	llvm::Value *tiny = irb.CreateBitCast(irb.CreateOr(irb.CreateBitCast(mag, i64), sign), dbl);
+
+	return irb.CreateSelect(sub, tiny, irb.CreateFPExt(val, dbl));
+}
+
+/**
+ * Round an exact non-negative double to the nearest integer, ties to even.
+ * If the double is itself a rounded value, the sign of its rounding error
+ * settles the ties.
+ *   @irb: The builder.
+ *   @val: The value, at most 2^52.
+ *   @err: The rounding error, or null if exact.
+ *   &returns: The integer, as a 64-bit integer.
+ */
+llvm::Value *ctfp_round(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Value *err) {
+	llvm::Type *type = val->getType();
+	llvm::Constant *big = llvm::ConstantFP::get(type, std::ldexp(1.0, 52));
+	llvm::Constant *one = llvm::ConstantFP::get(type, 1.0), *zero = llvm::ConstantFP::get(type, 0.0);
+	llvm::Value *near = irb.CreateFSub(irb.CreateFAdd(val, big), big);
+
+	if(err != nullptr) {
+		llvm::Value *diff = irb.CreateFSub(val, near);
+		llvm::Value *up = irb.CreateAnd(irb.CreateFCmpOEQ(diff, llvm::ConstantFP::get(type, 0.5)), irb.CreateFCmpOGT(err, zero));
+		llvm::Value *down = irb.CreateAnd(irb.CreateFCmpOEQ(diff, llvm::ConstantFP::get(type, -0.5)), irb.CreateFCmpOLT(err, zero));
+
+		near = irb.CreateFAdd(near, irb.CreateSelect(up, one, zero));
+		near = irb.CreateFSub(near, irb.CreateSelect(down, one, zero));
+	}
+
+	return irb.CreateFPToUI(near, ctfp_bits(type));
+}
+
+/**
+ * Narrow a double to float with IEEE rounding, also for subnormal results
+ * under FTZ.
+ *   @irb: The builder.
+ *   @val: The double value.
+ *   @type: The float type.
+ *   &returns: The float value.
+ */
+llvm::Value *ctfp_narrow(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Type *type) {
+	llvm::Type *i32 = ctfp_bits(type), *i64 = ctfp_bits(val->getType());
+	llvm::Value *bits = irb.CreateBitCast(val, i64);
+	llvm::Value *mag = irb.CreateBitCast(irb.CreateAnd(bits, 0x7FFFFFFFFFFFFFFF), val->getType());
+	llvm::Value *sub = irb.CreateFCmpOLT(mag, llvm::ConstantFP::get(val->getType(), std::ldexp(1.0, -126)));
+
+	llvm::Value *scale = irb.CreateFMul(mag, llvm::ConstantFP::get(val->getType(), std::ldexp(1.0, 149)));
+	llvm::Value *mant = irb.CreateTrunc(ctfp_round(irb, scale, nullptr), i32);
+	llvm::Value *sign = irb.CreateAnd(irb.CreateTrunc(irb.CreateLShr(bits, 32), i32), 0x80000000);
+	llvm::Value *tiny = irb.CreateBitCast(irb.CreateOr(mant, sign), type);
+
+	return irb.CreateSelect(sub, tiny, irb.CreateFPTrunc(val, type));
+}
+
+/**
+ * Scale a double by a power of two exactly, also for subnormals read under
+ * DAZ. The scaled magnitude must be finite.
+ *   @irb: The builder.
+ *   @val: The value.
+ *   @exp: The exponent, within [52, 1023].
+ *   &returns: The scaled value.
+ */
+llvm::Value *ctfp_scale(llvm::IRBuilder<>& irb, llvm::Value *val, int exp) {
+	llvm::Type *dbl = val->getType(), *i64 = ctfp_bits(dbl);
+	llvm::Value *bits = irb.CreateBitCast(val, i64);
+	llvm::Value *sub = irb.CreateICmpEQ(irb.CreateAnd(bits, 0x7FF0000000000000), llvm::ConstantInt::get(i64, 0));
+
+	llvm::Value *frac = irb.CreateBitCast(irb.CreateOr(irb.CreateAnd(bits, 0x000FFFFFFFFFFFFF), 0x3FF0000000000000), dbl);
+	llvm::Value *mag = irb.CreateFMul(irb.CreateFSub(frac, llvm::ConstantFP::get(dbl, 1.0)), llvm::ConstantFP::get(dbl, std::ldexp(1.0, exp - 1022)));
+	llvm::Value *tiny = irb.CreateBitCast(irb.CreateOr(irb.CreateBitCast(mag, i64), irb.CreateAnd(bits, 0x8000000000000000)), dbl);
+
+	return irb.CreateSelect(sub, tiny, irb.CreateFMul(val, llvm::ConstantFP::get(dbl, std::ldexp(1.0, exp))));
+}
+
+/**
+ * Split the magnitude of a finite, non-zero double into a mantissa in
+ * [1, 2) and an exponent, also for subnormals read under DAZ.
+ *   @irb: The builder.
+ *   @val: The value.
+ *   @exp: Output. The 64-bit exponent.
+ *   &returns: The mantissa.
+ */
+llvm::Value *ctfp_split(llvm::IRBuilder<>& irb, llvm::Value *val, llvm::Value **exp) {
+	llvm::Type *dbl = val->getType(), *i64 = ctfp_bits(dbl);
+	llvm::Value *bits = irb.CreateAnd(irb.CreateBitCast(val, i64), 0x7FFFFFFFFFFFFFFF);
+	llvm::Value *expo = irb.CreateLShr(bits, 52);
+	llvm::Value *sub = irb.CreateICmpEQ(expo, llvm::ConstantInt::get(i64, 0));
+
+	llvm::Value *frac = irb.CreateBitCast(irb.CreateOr(irb.CreateAnd(bits, 0x000FFFFFFFFFFFFF), 0x3FF0000000000000), dbl);
+	llvm::Value *norm = irb.CreateBitCast(irb.CreateFSub(frac, llvm::ConstantFP::get(dbl, 1.0)), i64);
+
+	llvm::Value *mant = irb.CreateSelect(sub, irb.CreateAnd(norm, 0x000FFFFFFFFFFFFF), irb.CreateAnd(bits, 0x000FFFFFFFFFFFFF));
+	*exp = irb.CreateSelect(sub, irb.CreateSub(irb.CreateLShr(norm, 52), llvm::ConstantInt::get(i64, 1023 + 1022)), irb.CreateSub(expo, llvm::ConstantInt::get(i64, 1023)));
+
+	return irb.CreateBitCast(irb.CreateOr(mant, 0x3FF0000000000000), dbl);
+}
+
+/**
+ * Join a rounded mantissa and an exponent into a double magnitude, with
+ * IEEE rounding of subnormal results under FTZ.
+ *   @irb: The builder.
+ *   @mant: The mantissa, within [0.5, 4).
+ *   @exp: The 64-bit exponent.
+ *   @err: The rounding error of the mantissa.
+ *   &returns: The magnitude.
+ */
+llvm::Value *ctfp_join(llvm::IRBuilder<>& irb, llvm::Value *mant, llvm::Value *exp, llvm::Value *err) {
+	llvm::Type *dbl = mant->getType();
+	llvm::Value *clamp = ctfp_clamp(irb, exp, -1024, 1025);
+	llvm::Value *half = irb.CreateAShr(clamp, 1);
+	llvm::Value *norm = irb.CreateFMul(irb.CreateFMul(mant, ctfp_pow2(irb, half, dbl)), ctfp_pow2(irb, irb.CreateSub(clamp, half), dbl));
+
+	llvm::Value *shift = ctfp_clamp(irb, irb.CreateAdd(exp, llvm::ConstantInt::get(exp->getType(), 1074)), -60, 60);
+	llvm::Value *scale = irb.CreateFMul(mant, ctfp_pow2(irb, shift, dbl));
+	llvm::Value *sub = irb.CreateFCmpOLT(scale, llvm::ConstantFP::get(dbl, std::ldexp(1.0, 52)));
+	llvm::Value *tiny = irb.CreateBitCast(ctfp_round(irb, scale, err), dbl);
+
+	return irb.CreateSelect(sub, tiny, norm);
+}
+
+/**
+ * Build the IEEE result of an operation under FTZ/DAZ.
+ *   @inst: The instruction, used as insertion point.
+ *   @info: The operation info.
+ *   &returns: The result.
+ */
+llvm::Value *ctfp_correct(llvm::Instruction *inst, Info const& info) {
+	llvm::IRBuilder<> irb(inst);
+	llvm::Module *mod = inst->getModule();
+	llvm::Type *type = inst->getType();
+	llvm::Value *a, *b = nullptr;
+
+	if(llvm::isa<llvm::CallInst>(inst))
+		a = llvm::cast<llvm::CallInst>(inst)->getArgOperand(0);
+	else
+		a = inst->getOperand(0), b = inst->getOperand(1);
+
+	auto apply = [&](llvm::Value *x, llvm::Value *y) -> llvm::Value * {
+		switch(info.op) {
+		case Op::Add: return irb.CreateFAdd(x, y);
+		case Op::Sub: return irb.CreateFSub(x, y);
+		case Op::Mul: return irb.CreateFMul(x, y);
+		case Op::Div: return irb.CreateFDiv(x, y);
+		case Op::Sqrt: return irb.CreateCall(llvm::Intrinsic::getDeclaration(mod, llvm::Intrinsic::sqrt, { x->getType() }), { x });
+		default: fatal("Invalid hybrid operation.");
+		}
+	};
+
+	if(info.type.width == 32)
+		return ctfp_narrow(irb, apply(ctfp_widen(irb, a), b ? ctfp_widen(irb, b) : nullptr), type);
+
+	llvm::Type *i64 = ctfp_bits(type);
+	auto abs = [&](llvm::Value *x) { return irb.CreateBitCast(irb.CreateAnd(irb.CreateBitCast(x, i64), 0x7FFFFFFFFFFFFFFF), type); };
+
+	if(info.op == Op::Sqrt) {
+		llvm::Value *bits = irb.CreateBitCast(a, i64);
+		llvm::Value *sub = irb.CreateAnd(irb.CreateICmpEQ(irb.CreateAnd(bits, 0x7FF0000000000000), llvm::ConstantInt::get(i64, 0)), irb.CreateICmpNE(irb.CreateAnd(bits, 0x000FFFFFFFFFFFFF), llvm::ConstantInt::get(i64, 0)));
+		llvm::Value *tiny = irb.CreateFMul(apply(ctfp_scale(irb, a, 128), nullptr), llvm::ConstantFP::get(type, std::ldexp(1.0, -64)));
+
+		return irb.CreateSelect(sub, tiny, apply(a, nullptr));
+	}
+	else if((info.op == Op::Add) || (info.op == Op::Sub)) {
+		llvm::Constant *lim = llvm::ConstantFP::get(type, std::ldexp(1.0, -900));
+		llvm::Value *small = irb.CreateAnd(irb.CreateFCmpOLT(abs(a), lim), irb.CreateFCmpOLT(abs(b), lim));
+		llvm::Value *res = apply(ctfp_scale(irb, a, 600), ctfp_scale(irb, b, 600));
+
+		llvm::Value *sub = irb.CreateFCmpOLT(abs(res), llvm::ConstantFP::get(type, std::ldexp(1.0, 600 - 1022)));
+		llvm::Value *mant = ctfp_round(irb, irb.CreateFMul(abs(res), llvm::ConstantFP::get(type, std::ldexp(1.0, 1074 - 600))), nullptr);
+		llvm::Value *tiny = irb.CreateBitCast(irb.CreateOr(mant, irb.CreateAnd(irb.CreateBitCast(res, i64), 0x8000000000000000)), type);
+		llvm::Value *norm = irb.CreateFMul(res, llvm::ConstantFP::get(type, std::ldexp(1.0, -600)));
+
+		return irb.CreateSelect(small, irb.CreateSelect(sub, tiny, norm), apply(a, b));
+	}
+
+	llvm::Function *fma = llvm::Intrinsic::getDeclaration(mod, llvm::Intrinsic::fma, { type });
+	llvm::Value *ea, *eb, *exp, *mant, *err;
+	llvm::Value *ma = ctfp_split(irb, a, &ea);
+	llvm::Value *mb = ctfp_split(irb, b, &eb);
+
+	if(info.op == Op::Mul) {
+		mant = irb.CreateFMul(ma, mb);
+		err = irb.CreateCall(fma, { ma, mb, irb.CreateFSub(llvm::ConstantFP::get(type, -0.0), mant) });
+		exp = irb.CreateAdd(ea, eb);
+	}
+	else {
+		mant = irb.CreateFDiv(ma, mb);
+		err = irb.CreateCall(fma, { irb.CreateFSub(llvm::ConstantFP::get(type, -0.0), mant), mb, ma });
+		exp = irb.CreateSub(ea, eb);
+	}
+
+	llvm::Value *sign = irb.CreateAnd(irb.CreateXor(irb.CreateBitCast(a, i64), irb.CreateBitCast(b, i64)), 0x8000000000000000);
+	llvm::Value *res = irb.CreateBitCast(irb.CreateOr(irb.CreateBitCast(ctfp_join(irb, mant, exp, err), i64), sign), type);
+
+	auto special = [&](llvm::Value *x) {
+		llvm::Value *bits = irb.CreateAnd(irb.CreateBitCast(x, i64), 0x7FFFFFFFFFFFFFFF);
+
+		return irb.CreateOr(irb.CreateICmpEQ(bits, llvm::ConstantInt::get(i64, 0)), irb.CreateICmpUGE(bits, llvm::ConstantInt::get(i64, 0x7FF0000000000000)));
+	};
+	auto stand = [&](llvm::Value *x) {
+		llvm::Value *bits = irb.CreateBitCast(x, i64);
+		llvm::Value *sub = irb.CreateICmpULT(irb.CreateSub(irb.CreateAnd(bits, 0x7FFFFFFFFFFFFFFF), llvm::ConstantInt::get(i64, 1)), llvm::ConstantInt::get(i64, 0x000FFFFFFFFFFFFF));
+
+		return irb.CreateSelect(sub, irb.CreateBitCast(irb.CreateOr(irb.CreateAnd(bits, 0x8000000000000000), 0x3FF0000000000000), type), x);
+	};
+
+	return irb.CreateSelect(irb.CreateOr(special(a), special(b)), apply(stand(a), stand(b)), res);
+}
+
+/**
+ * Protect a value by flushing its magnitudes beyond the safe value.
+ *   @op: The value.
  *   @safe: The safe value.
+ *   @inst: The insertion point.
+ *   &returns: The protected value.
  */
-void ctfp_protect(llvm::Instruction *inst, unsigned int i, double safe) {
-	llvm::Value *op = inst->getOperand(i);
+llvm::Value *ctfp_protect(llvm::Value *op, double safe, llvm::Instruction *inst) {
 	llvm::LLVMContext &ctx = inst->getContext();
 	llvm::Module *mod = inst->getParent()->getParent()->getParent();
 
@@ -468,28 +1862,28 @@ void ctfp_protect(llvm::Instruction *inst, unsigned int i, double safe) {
 	llvm::Constant *zero, *ones;
 	std::string post;
 
-	if(inst->getType()->isFloatTy()) {
+	if(op->getType()->isFloatTy()) {
 		post = ".f32";
 		cast = llvm::Type::getInt32Ty(ctx);
 		zero = llvm::ConstantInt::get(cast, 0);
 		ones = llvm::ConstantInt::get(cast, 0xFFFFFFFF);
 	}
-	else if(inst->getType()->isDoubleTy()) {
+	else if(op->getType()->isDoubleTy()) {
 		post = ".f64";
 		cast = llvm::Type::getInt64Ty(ctx);
 		zero = llvm::ConstantInt::get(cast, 0);
 		ones = llvm::ConstantInt::get(cast, 0xFFFFFFFFFFFFFFFF);
 	}
-	else if(inst->getType()->isVectorTy()) {
-		uint32_t cnt = inst->getType()->getVectorNumElements();
+	else if(op->getType()->isVectorTy()) {
+		uint32_t cnt = op->getType()->getVectorNumElements();
 
-		if(inst->getType()->getScalarType()->isFloatTy()) {
+		if(op->getType()->getScalarType()->isFloatTy()) {
 			post = ".f32";
 			cast = llvm::Type::getInt32Ty(ctx);
 			zero = llvm::ConstantInt::get(cast, 0);
 			ones = llvm::ConstantInt::get(cast, 0xFFFFFFFF);
 		}
-		else if(inst->getType()->getScalarType()->isDoubleTy()) {
+		else if(op->getType()->getScalarType()->isDoubleTy()) {
 			post = ".f64";
 			cast = llvm::Type::getInt64Ty(ctx);
 			zero = llvm::ConstantInt::get(cast, 0);
@@ -518,7 +1912,7 @@ void ctfp_protect(llvm::Instruction *inst, unsigned int i, double safe) {
 	llvm::Constant *copysign = mod->getOrInsertFunction("llvm.copysign" + post, llvm::FunctionType::get(op->getType(), { op->getType(), op->getType() }, false));
 	llvm::Instruction *done = llvm::CallInst::Create(llvm::cast<llvm::Function>(copysign)->getFunctionType(), copysign, { tofp, op }, "", inst);
 
-	inst->setOperand(i, done);
+	return done;
 }
 
 using namespace llvm;
@@ -527,7 +1921,7 @@ void ctfp_replace(Instruction *inst, const char *id) {
 	Module *mod = inst->getParent()->getParent()->getParent();
 	LLVMContext &ctx = mod->getContext();
 
-	Function *func = mod->getFunction(id);
+	Function *func = ctfp_kernel(*mod, id);
 	if(func == NULL)
 		fprintf(stderr, "Missing CTFP function '%s'.\n", id), abort();
 
@@ -625,28 +2019,33 @@ namespace {
 		static char ID;
 
 		CTFP() : FunctionPass(ID) {
-			if(strcmp(CTFP_MODE, "BASIC") == 0)
-				ctfp_mode = basic_v;
-			else if(strcmp(CTFP_MODE, "REST") == 0)
-				ctfp_mode = rest_v;
-			else if(strcmp(CTFP_MODE, "FULL") == 0)
-				ctfp_mode = full_v;
-			else if(strcmp(CTFP_MODE, "FAST") == 0)
-				ctfp_mode = fast_v;
-			else if(strcmp(CTFP_MODE, "FLAGS") == 0)
-				ctfp_mode = flags_v;
-			else if(strcmp(CTFP_MODE, "STATS") == 0)
-				ctfp_mode = stats_v;
-			else
+			const char *mode = getenv("CTFP_MODE");
+
+#ifdef CTFP_MODE
+			if(mode == nullptr)
+				mode = CTFP_MODE;
+#endif
+
+			if((mode == nullptr) || !ctfp_parse(mode, &ctfp_base))
 				fatal("Unknown or missing CTFP_MODE definition.");
+
+			ctfp_tainted = (getenv("CTFP_TAINT") != nullptr);
 		}
 
 		~CTFP() {
 		}
 
+		virtual bool doInitialization(Module &mod) {
+			return ctfp_init(mod);
+		}
+
 		virtual bool runOnFunction(Function &func) {
 			return ctfp_func(func);
 		}
+
+		virtual bool doFinalization(Module &mod) {
+			return ctfp_done(mod);
+		}
 	};
 
 	char CTFP::ID = 0;
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+/*
+ * scalar packing
+ *   Independent scalar operations of a block are packed into vector
+ *   operations, so that up to four floats or two doubles share one kernel
+ *   call. Shared by the plugins of `fast/` and `tool/`, which include it
+ *   after the LLVM headers.
+ */
+
+/**
+ * Check if an instruction is a scalar operation that can be packed.
+ *   @inst: The instruction.
+ *   &returns: True if packable.
+ */
+bool ctfp_packable(llvm::Instruction *inst) {
+	if((inst->getOpcode() != llvm::Instruction::FAdd) && (inst->getOpcode() != llvm::Instruction::FSub) && (inst->getOpcode() != llvm::Instruction::FMul) && (inst->getOpcode() != llvm::Instruction::FDiv))
+		return false;
+
+	return inst->getType()->isFloatTy() || inst->getType()->isDoubleTy();
+}
+
+/**
+ * Emit a pack of independent scalar operations as a single vector operation.
+ * The vector operation keeps only the flags, such as the fast-math flags,
+ * that every member of the pack has.
+ *   @pack: The scalar operations, all with the same opcode and type.
+ *   @before: The insertion point, dominated by every member of the pack.
+ */
+void ctfp_emit(std::vector<llvm::Instruction *> &pack, llvm::Instruction *before) {
+	llvm::Instruction *first = pack.front();
+	llvm::LLVMContext &ctx = first->getContext();
+
+	llvm::Type *itype = llvm::Type::getInt32Ty(ctx);
+	llvm::Type *type = llvm::VectorType::get(first->getType(), first->getType()->isFloatTy() ? 4 : 2);
+	llvm::Value *lhs = llvm::UndefValue::get(type), *rhs = llvm::UndefValue::get(type);
+
+	for(unsigned int i = 0; i < pack.size(); i++) {
+		lhs = llvm::InsertElementInst::Create(lhs, pack[i]->getOperand(0), llvm::ConstantInt::get(itype, i), "", before);
+		rhs = llvm::InsertElementInst::Create(rhs, pack[i]->getOperand(1), llvm::ConstantInt::get(itype, i), "", before);
+	}
+
+	llvm::Instruction *ret = llvm::BinaryOperator::Create(llvm::cast<llvm::BinaryOperator>(first)->getOpcode(), lhs, rhs, "", before);
+
+	ret->copyIRFlags(first);
+	for(unsigned int i = 1; i < pack.size(); i++)
+		ret->andIRFlags(pack[i]);
+
+	for(unsigned int i = 0; i < pack.size(); i++) {
+		llvm::Instruction *done = llvm::ExtractElementInst::Create(ret, llvm::ConstantInt::get(itype, i), "", before);
+		pack[i]->replaceAllUsesWith(done);
+		pack[i]->eraseFromParent();
+	}
+
+	pack.clear();
+}
+
+/**
+ * Pack independent scalar operations of a block into vector operations. Up to
+ * four floats or two doubles share one kernel call. A pack is emitted when it
+ * is full, right before the first instruction that uses one of its members,
+ * before any call, or at the end of the block. Secret and public operations
+ * are never packed together, so that the public lanes stay public.
+ *   @block: The block.
+ *   @secret: The secret taint of an operation, empty if not tracked.
+ */
+void ctfp_pack(llvm::BasicBlock& block, std::function<bool(llvm::Instruction const&)> const& secret) {
+	typedef std::tuple<unsigned int, llvm::Type *, bool> pack_key;
+
+	std::map<pack_key, std::vector<llvm::Instruction *>> packs;
+	std::map<llvm::Instruction *, pack_key> owner;
+
+	auto iter = block.begin();
+	while(iter != block.end()) {
+		llvm::Instruction *inst = &*iter++;
+		std::set<pack_key> flush;
+
+		if(llvm::isa<llvm::CallInst>(inst) || llvm::isa<llvm::InvokeInst>(inst) || inst->isTerminator()) {
+			for(auto &pack : packs)
+				flush.insert(pack.first);
+		}
+
+		for(llvm::Value *op : inst->operands()) {
+			auto find = llvm::isa<llvm::Instruction>(op) ? owner.find(llvm::cast<llvm::Instruction>(op)) : owner.end();
+			if(find != owner.end())
+				flush.insert(find->second);
+		}
+
+		for(pack_key const& key : flush) {
+			std::vector<llvm::Instruction *> &pack = packs[key];
+			if(pack.empty())
+				continue;
+
+			for(llvm::Instruction *member : pack)
+				owner.erase(member);
+
+			ctfp_emit(pack, inst);
+		}
+
+		if(!ctfp_packable(inst))
+			continue;
+
+		pack_key key = std::make_tuple(inst->getOpcode(), inst->getType(), secret ? secret(*inst) : false);
+		std::vector<llvm::Instruction *> &pack = packs[key];
+		pack.push_back(inst);
+		owner[inst] = key;
+
+		if(pack.size() == (inst->getType()->isFloatTy() ? 4u : 2u)) {
+			for(llvm::Instruction *member : pack)
+				owner.erase(member);
+
+			ctfp_emit(pack, inst);
+		}
+	}
+}
@@ -0,0 +1,278 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stats.h"
+
+
+/*
+ * local declarations
+ */
+static bool stats_load(const char *path, std::vector<fp_record>& recs);
+static void stats_merge(fp_record& dst, fp_record const& src);
+static double stats_min(fp_record const& rec);
+static std::string stats_exp(uint32_t wid, unsigned int i);
+static void stats_text(std::vector<fp_record> const& recs);
+static void stats_csv(std::vector<fp_record> const& recs);
+
+
+/**
+ * Main entry function. Merges the snapshot files of any number of
+ * processes, which may still be running, and prints the result as text or,
+ * with `-c`, as CSV.
+ *   @argc: The number of arguments.
+ *   @argv: The argument array.
+ *   &returns: The code.
+ */
+int main(int argc, char **argv)
+{
+	bool csv = false;
+	int opt;
+
+	while((opt = getopt(argc, argv, "c")) != -1) {
+		switch(opt) {
+		case 'c': csv = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-c] fp.stats.<pid>...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::map<std::pair<uint32_t, uint32_t>, fp_record> all;
+
+	for(int i = optind; i < argc; i++) {
+		std::vector<fp_record> recs;
+
+		if(!stats_load(argv[i], recs)) {
+			fprintf(stderr, "Skipping '%s'.\n", argv[i]);
+			continue;
+		}
+
+		for(fp_record const& rec : recs) {
+			auto key = std::make_pair(rec.id, rec.wid);
+			auto find = all.find(key);
+
+			if(find == all.end())
+				all[key] = rec;
+			else
+				stats_merge(find->second, rec);
+		}
+	}
+
+	std::vector<fp_record> recs;
+	for(auto const& entry : all)
+		recs.push_back(entry.second);
+
+	std::stable_sort(recs.begin(), recs.end(), [](fp_record const& a, fp_record const& b) {
+		if((a.id == 0) || (b.id == 0))
+			return (a.id == 0) && (b.id != 0);
+
+		return (a.stats.nsubs + a.stats.ninfs + a.stats.nnans) > (b.stats.nsubs + b.stats.ninfs + b.stats.nnans);
+	});
+
+	if(csv)
+		stats_csv(recs);
+	else
+		stats_text(recs);
+
+	return 0;
+}
+
+
+/**
+ * Load a consistent copy of the records of a snapshot file, retrying while
+ * its writer is updating it.
+ *   @path: The path.
+ *   @recs: Output. The records.
+ *   &returns: True on success.
+ */
+static bool stats_load(const char *path, std::vector<fp_record>& recs)
+{
+	int fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return false;
+
+	struct stat st;
+	if((fstat(fd, &st) < 0) || ((size_t)st.st_size < sizeof(fp_header))) {
+		close(fd);
+		return false;
+	}
+
+	void *ptr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if(ptr == MAP_FAILED)
+		return false;
+
+	const fp_header *hdr = (const fp_header *)ptr;
+	const fp_record *base = (const fp_record *)(hdr + 1);
+	size_t max = (st.st_size - sizeof(fp_header)) / sizeof(fp_record);
+	bool okay = false;
+
+	if((hdr->magic == FP_STATS_MAGIC) && (hdr->version == FP_STATS_VERSION)) {
+		for(unsigned int tries = 0; !okay && (tries < 1000); tries++) {
+			uint64_t seq = __atomic_load_n(&hdr->seq, __ATOMIC_ACQUIRE);
+
+			if(seq & 1) {
+				usleep(1000);
+				continue;
+			}
+
+			size_t n = std::min<size_t>(hdr->nrecs, max);
+			recs.assign(base, base + n);
+
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			okay = (__atomic_load_n(&hdr->seq, __ATOMIC_RELAXED) == seq);
+		}
+	}
+
+	munmap(ptr, st.st_size);
+
+	for(fp_record& rec : recs)
+		rec.name[FP_STATS_NAME - 1] = '\0';
+
+	return okay;
+}
+
+/**
+ * Accumulate a record into another.
+ *   @dst: The destination record.
+ *   @src: The source record.
+ */
+static void stats_merge(fp_record& dst, fp_record const& src)
+{
+	dst.stats.min = std::min(dst.stats.min, src.stats.min);
+	dst.stats.nsubs += src.stats.nsubs;
+	dst.stats.ninfs += src.stats.ninfs;
+	dst.stats.nnans += src.stats.nnans;
+
+	for(unsigned int i = 0; i < FP_STATS_HIST; i++) {
+		dst.ops[i] += src.ops[i];
+		dst.res[i] += src.res[i];
+	}
+}
+
+/**
+ * Decode the minimum magnitude of a record.
+ *   @rec: The record.
+ *   &returns: The minimum, infinity if none.
+ */
+static double stats_min(fp_record const& rec)
+{
+	if(rec.stats.min == UINT64_MAX)
+		return INFINITY;
+	else if(rec.wid == 32) {
+		uint32_t bits = rec.stats.min;
+		float val;
+
+		memcpy(&val, &bits, sizeof(val));
+		return val;
+	}
+	else {
+		double val;
+
+		memcpy(&val, &rec.stats.min, sizeof(val));
+		return val;
+	}
+}
+
+/**
+ * Retrieve the label of a histogram bucket: `sub` for the subnormals,
+ * otherwise the smallest unbiased exponent it covers.
+ *   @wid: The width, 32 or 64.
+ *   @i: The bucket index.
+ *   &returns: The label.
+ */
+static std::string stats_exp(uint32_t wid, unsigned int i)
+{
+	int step = (wid == 32) ? (256 / FP_STATS_HIST) : (2048 / FP_STATS_HIST);
+	int bias = (wid == 32) ? 127 : 1023;
+
+	if(i == 0)
+		return "sub";
+
+	return std::to_string(((i == 1) ? 1 : (int)i * step) - bias);
+}
+
+/**
+ * Print records in the format of the exit-time statistics file.
+ *   @recs: The records.
+ */
+static void stats_text(std::vector<fp_record> const& recs)
+{
+	for(fp_record const& rec : recs) {
+		if(rec.id == 0)
+			printf("# %u-bit\n", rec.wid);
+		else
+			printf("# site %08x %u-bit %s\n", rec.id, rec.wid, rec.name);
+
+		printf("min   %g\n", stats_min(rec));
+		printf("nsubs %lu\n", rec.stats.nsubs);
+		printf("ninfs %lu\n", rec.stats.ninfs);
+		printf("nnans %lu\n", rec.stats.nnans);
+
+		if(rec.id == 0)
+			continue;
+
+		printf("ops  ");
+		for(unsigned int i = 0; i < FP_STATS_HIST; i++) {
+			if(rec.ops[i] > 0)
+				printf(" %s:%lu", stats_exp(rec.wid, i).c_str(), rec.ops[i]);
+		}
+
+		printf("\nres  ");
+		for(unsigned int i = 0; i < FP_STATS_HIST; i++) {
+			if(rec.res[i] > 0)
+				printf(" %s:%lu", stats_exp(rec.wid, i).c_str(), rec.res[i]);
+		}
+
+		printf("\n");
+	}
+}
+
+/**
+ * Print records as CSV, one row per site with one column per histogram
+ * bucket. The totals have an empty identifier.
+ *   @recs: The records.
+ */
+static void stats_csv(std::vector<fp_record> const& recs)
+{
+	printf("id,width,name,min,nsubs,ninfs,nnans");
+	for(unsigned int i = 0; i < FP_STATS_HIST; i++)
+		printf(",ops%u", i);
+	for(unsigned int i = 0; i < FP_STATS_HIST; i++)
+		printf(",res%u", i);
+	printf("\n");
+
+	for(fp_record const& rec : recs) {
+		std::string name;
+
+		for(const char *str = rec.name; *str != '\0'; str++)
+			name += (*str == '"') ? std::string("\"\"") : std::string(1, *str);
+
+		if(rec.id == 0)
+			printf(",%u,\"%s\"", rec.wid, name.c_str());
+		else
+			printf("%08x,%u,\"%s\"", rec.id, rec.wid, name.c_str());
+
+		printf(",%g,%lu,%lu,%lu", stats_min(rec), rec.stats.nsubs, rec.stats.ninfs, rec.stats.nnans);
+
+		for(unsigned int i = 0; i < FP_STATS_HIST; i++)
+			printf(",%lu", rec.ops[i]);
+		for(unsigned int i = 0; i < FP_STATS_HIST; i++)
+			printf(",%lu", rec.res[i]);
+
+		printf("\n");
+	}
+}
@@ -6,6 +6,12 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "stats.h"
 
 
 /*
@@ -19,113 +25,719 @@ typedef double double2 __attribute__((vector_size(2*sizeof(double))));
 typedef double double4 __attribute__((vector_size(4*sizeof(double))));
 typedef double double8 __attribute__((vector_size(8*sizeof(double))));
 
+typedef uint32_t uint2 __attribute__((vector_size(2*sizeof(uint32_t))));
+typedef uint32_t uint4 __attribute__((vector_size(4*sizeof(uint32_t))));
+typedef uint32_t uint8 __attribute__((vector_size(8*sizeof(uint32_t))));
+typedef uint32_t uint16 __attribute__((vector_size(16*sizeof(uint32_t))));
+typedef uint64_t ulong2 __attribute__((vector_size(2*sizeof(uint64_t))));
+typedef uint64_t ulong4 __attribute__((vector_size(4*sizeof(uint64_t))));
+typedef uint64_t ulong8 __attribute__((vector_size(8*sizeof(uint64_t))));
+
+/*
+ * per-site counters
+ *   Every rewritten operation passes the site identifier emitted by the
+ *   plugin. A site keeps its statistics and two exponent histograms, one
+ *   for the operands and one for the results. Bucket 0 holds only the
+ *   subnormals; every other bucket covers a fixed slice of the biased
+ *   exponent, except that bucket 1 also takes the normals below its slice,
+ *   and the last one holds the infinities and NaNs with the largest finite
+ *   binades. Zeros are not counted. The minimum
+ *   is kept as the bits of the smallest finite, non-zero magnitude, which
+ *   orders the same as the value.
+ */
+#define HIST FP_STATS_HIST
+#define SITES 4096
+#define PROBE 16
+
+struct site {
+	uint32_t id, wid;
+	struct fp_stats stats;
+	uint64_t ops[HIST], res[HIST];
+};
+
 /*
- * statistics structure and declarations
+ * site names
+ *   The plugin places one entry per site into the `ctfp_sites` section, so
+ *   the linker collects the names of every instrumented object.
  */
-struct stats {
-	double min;
-	uint64_t nsubs, ninfs, nnans;
+struct info {
+	uint32_t id;
+	const char *name;
 };
 
-static struct stats stats32, stats64;
+extern const struct info __start_ctfp_sites[] __attribute__((weak));
+extern const struct info __stop_ctfp_sites[] __attribute__((weak));
+
+/*
+ * per-thread counter block
+ *   Each thread owns one block and is its only writer; blocks are pushed
+ *   onto a lock-free list on first use and never freed, so that the
+ *   counts of finished threads are still merged. Sites that do not fit in
+ *   the table are accumulated into an anonymous site per width.
+ */
+struct block {
+	struct site sites[SITES];
+	struct site other[2];
+	struct block *next;
+};
+
+static struct block *head = NULL;
+static __thread struct block *local = NULL;
+
+/*
+ * sampling state
+ *   With `CTFP_STATS_SAMPLE=N`, only one operation in N is classified and
+ *   its counts are weighted by N.
+ */
+static uint64_t period = 1;
+static __thread int64_t countdown = 0;
+
+/*
+ * snapshot state
+ *   The snapshot file is rewritten every `CTFP_STATS_PERIOD` milliseconds
+ *   (default 1000, zero to only write on exit) by a background thread.
+ *   Collection is off the hot path and serialized by `lock`.
+ */
+static struct fp_header *map = NULL;
+static size_t mapsz = 0;
+static uint64_t interval = 1000;
+static const struct info **names = NULL;
+static size_t nnames = 0;
 
 /*
  * synchronization structures
  */
 static pthread_once_t once = PTHREAD_ONCE_INIT;
-static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
 
 /*
  * function declarations
  */
 static void init(void);
 static void save(void);
-static void save1(FILE *file, struct stats *stats);
+static void save1(FILE *file, struct fp_stats *stats, int wid);
+static void saveh(FILE *file, const char *id, uint64_t *hist, int wid);
+static struct block *attach(void);
+static struct site *find(struct site *sites, struct site *other, uint32_t id, uint32_t wid);
+static const char *name(uint32_t id);
+static unsigned int collect(struct site *sites, struct site *all);
+static void snapshot(struct site *sites, struct site *all, unsigned int n);
+static void record(struct fp_record *rec, struct site *site, uint32_t id);
+static void mapopen(void);
+static void *writer(void *arg);
+static void prepare(void);
+static void parent(void);
+static void child(void);
+
+void fp_stats_save(void);
+
+/**
+ * Order the site names by identifier.
+ *   @lhs: The left entry.
+ *   @rhs: The right entry.
+ *   &returns: The comparison.
+ */
+static int byid(const void *lhs, const void *rhs)
+{
+	const struct info *a = *(const struct info **)lhs, *b = *(const struct info **)rhs;
+
+	return (a->id > b->id) - (a->id < b->id);
+}
 
 static void init(void)
 {
-	memset(&stats32, 0x00, sizeof(struct stats));
-	memset(&stats64, 0x00, sizeof(struct stats));
-	stats32.min = INFINITY;
-	stats64.min = INFINITY;
+	const char *env = getenv("CTFP_STATS_SAMPLE");
+	const struct info *info;
+	pthread_t thread;
+
+	if((env != NULL) && (strtoull(env, NULL, 0) > 0))
+		__atomic_store_n(&period, strtoull(env, NULL, 0), __ATOMIC_RELAXED);
+
+	env = getenv("CTFP_STATS_PERIOD");
+	if(env != NULL)
+		interval = strtoull(env, NULL, 0);
+
+	nnames = __stop_ctfp_sites - __start_ctfp_sites;
+	names = malloc((nnames + 1) * sizeof(*names));
+	if(names == NULL)
+		abort();
 
+	for(info = __start_ctfp_sites; info < __stop_ctfp_sites; info++)
+		names[info - __start_ctfp_sites] = info;
+
+	qsort(names, nnames, sizeof(*names), byid);
+
+	mapopen();
 	atexit(save);
+	pthread_atfork(prepare, parent, child);
+
+	if((interval > 0) && (pthread_create(&thread, NULL, writer, NULL) == 0))
+		pthread_detach(thread);
+}
+
+/**
+ * Create and map the snapshot file of the current process. On failure, no
+ * snapshots are written.
+ */
+static void mapopen(void)
+{
+	int fd;
+	char path[256];
+	const char *dir = getenv("CTFP_STATS_DIR");
+
+	snprintf(path, sizeof(path), "%s/fp.stats.%d", dir ? dir : "/tmp", (int)getpid());
+
+	map = NULL;
+	mapsz = sizeof(struct fp_header) + (SITES + 4) * sizeof(struct fp_record);
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(fd < 0)
+		return;
+
+	if(ftruncate(fd, mapsz) == 0) {
+		map = mmap(NULL, mapsz, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if(map == MAP_FAILED)
+			map = NULL;
+	}
+
+	close(fd);
+
+	if(map != NULL) {
+		map->magic = FP_STATS_MAGIC;
+		map->version = FP_STATS_VERSION;
+		map->pid = getpid();
+		map->cap = SITES + 4;
+	}
+}
+
+/**
+ * Background thread rewriting the snapshot file.
+ *   @arg: Unused.
+ *   &returns: Never returns.
+ */
+static void *writer(void *arg)
+{
+	struct timespec ts = { interval / 1000, (interval % 1000) * 1000000 };
+	struct site *sites = calloc(SITES + 2, sizeof(struct site));
+
+	(void)arg;
+
+	if(sites == NULL)
+		return NULL;
+
+	while(1) {
+		struct site all[2];
+		unsigned int n;
+
+		nanosleep(&ts, NULL);
+
+		pthread_mutex_lock(&lock);
+		n = collect(sites, all);
+		snapshot(sites, all, n);
+		pthread_mutex_unlock(&lock);
+	}
+
+	return NULL;
+}
+
+/*
+ * fork handlers
+ *   The child starts with empty counters, its own snapshot file and a new
+ *   writer thread. The blocks of threads that did not survive the fork
+ *   stay on the list, empty.
+ */
+static void prepare(void)
+{
+	pthread_mutex_lock(&lock);
+}
+static void parent(void)
+{
+	pthread_mutex_unlock(&lock);
+}
+static void child(void)
+{
+	struct block *block;
+	pthread_t thread;
+
+	for(block = head; block != NULL; block = block->next) {
+		memset(block->sites, 0, sizeof(block->sites));
+		memset(block->other, 0, sizeof(block->other));
+	}
+
+	if(map != NULL)
+		munmap(map, mapsz);
+
+	mapopen();
+	pthread_mutex_unlock(&lock);
+
+	if((interval > 0) && (pthread_create(&thread, NULL, writer, NULL) == 0))
+		pthread_detach(thread);
+}
+
+/**
+ * Attach a counter block to the calling thread. The site table is only
+ * backed by memory once touched.
+ *   &returns: The block.
+ */
+static struct block *attach(void)
+{
+	struct block *block;
+
+	pthread_once(&once, init);
+
+	block = calloc(1, sizeof(struct block));
+	if(block == NULL)
+		abort();
+
+	block->next = __atomic_load_n(&head, __ATOMIC_RELAXED);
+	while(!__atomic_compare_exchange_n(&head, &block->next, block, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+	local = block;
+
+	return block;
+}
+
+/**
+ * Retrieve the counter block of the calling thread.
+ *   &returns: The block.
+ */
+static inline struct block *get(void)
+{
+	struct block *block = local;
+
+	return __builtin_expect(block != NULL, 1) ? block : attach();
+}
+
+/**
+ * Find or claim the entry of a site in a table.
+ *   @sites: The table of `SITES` entries.
+ *   @other: The two overflow entries.
+ *   @id: The site identifier, never zero; all ones names the overflow.
+ *   @wid: The width, 32 or 64.
+ *   &returns: The entry.
+ */
+static struct site *find(struct site *sites, struct site *other, uint32_t id, uint32_t wid)
+{
+	struct site *site;
+	uint32_t i, hash = id * 2654435761u;
+
+	for(i = 0; i < PROBE; i++) {
+		site = &sites[(hash + i) % SITES];
+		uint32_t cur = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+
+		if((cur == id) && (site->wid == wid))
+			return site;
+		else if(cur == 0) {
+			site->wid = wid;
+			site->stats.min = UINT64_MAX;
+			__atomic_store_n(&site->id, id, __ATOMIC_RELEASE);
+
+			return site;
+		}
+	}
+
+	site = &other[wid == 64];
+	if(site->wid == 0) {
+		site->stats.min = UINT64_MAX;
+		site->wid = wid;
+	}
+
+	return site;
+}
+
+/**
+ * Check if the current operation is sampled. The countdown is only reloaded
+ * once the initialization has set the period.
+ *   &returns: True if sampled.
+ */
+static inline int sample(void)
+{
+	if(__builtin_expect(--countdown > 0, 1))
+		return 0;
+
+	pthread_once(&once, init);
+	countdown = __atomic_load_n(&period, __ATOMIC_RELAXED);
+
+	return 1;
 }
 
-static void save1(FILE *file, struct stats *stats)
+/**
+ * Add to a counter owned by the calling thread. The relaxed load/store pair
+ * compiles to a plain add while keeping concurrent merges well defined.
+ *   @cnt: The counter.
+ *   @n: The increment.
+ */
+static inline void bump(uint64_t *cnt, uint64_t n)
 {
-	fprintf(file, "min   %g\n", stats->min);
+	if(n > 0)
+		__atomic_store_n(cnt, __atomic_load_n(cnt, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+/**
+ * Retrieve the histogram bucket of a non-zero magnitude.
+ *   @a: The magnitude bits.
+ *   @man: The number of mantissa bits.
+ *   @sh: The log2 of the number of exponents per bucket.
+ *   &returns: The bucket.
+ */
+static inline unsigned int bucket(uint64_t a, int man, int sh)
+{
+	uint64_t e = a >> man;
+
+	if(e == 0)
+		return 0;
+
+	return ((e >> sh) > 1) ? (e >> sh) : 1;
+}
+
+/**
+ * Lower the minimum owned by the calling thread.
+ *   @min: The minimum.
+ *   @val: The candidate bits.
+ */
+static inline void lower(uint64_t *min, uint64_t val)
+{
+	if(val < __atomic_load_n(min, __ATOMIC_RELAXED))
+		__atomic_store_n(min, val, __ATOMIC_RELAXED);
+}
+
+/**
+ * Accumulate a site into another.
+ *   @dst: The destination site.
+ *   @src: The source site, possibly being written.
+ */
+static void merge(struct site *dst, struct site *src)
+{
+	unsigned int i;
+	uint64_t min = __atomic_load_n(&src->stats.min, __ATOMIC_RELAXED);
+
+	if(min < dst->stats.min)
+		dst->stats.min = min;
+
+	dst->stats.nsubs += __atomic_load_n(&src->stats.nsubs, __ATOMIC_RELAXED);
+	dst->stats.ninfs += __atomic_load_n(&src->stats.ninfs, __ATOMIC_RELAXED);
+	dst->stats.nnans += __atomic_load_n(&src->stats.nnans, __ATOMIC_RELAXED);
+
+	for(i = 0; i < HIST; i++) {
+		dst->ops[i] += __atomic_load_n(&src->ops[i], __ATOMIC_RELAXED);
+		dst->res[i] += __atomic_load_n(&src->res[i], __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * Retrieve the name of a site.
+ *   @id: The site identifier.
+ *   &returns: The name, or null if unknown.
+ */
+static const char *name(uint32_t id)
+{
+	size_t lo = 0, hi = nnames;
+
+	if(id == UINT32_MAX)
+		return "(overflow)";
+
+	while(lo < hi) {
+		size_t mid = (lo + hi) / 2;
+
+		if(names[mid]->id < id)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return ((lo < nnames) && (names[lo]->id == id)) ? names[lo]->name : NULL;
+}
+
+static void save1(FILE *file, struct fp_stats *stats, int wid)
+{
+	double min = INFINITY;
+
+	if((stats->min != UINT64_MAX) && (wid == 32)) {
+		uint32_t bits = stats->min;
+		float val;
+
+		memcpy(&val, &bits, sizeof(val));
+		min = val;
+	}
+	else if(stats->min != UINT64_MAX)
+		memcpy(&min, &stats->min, sizeof(min));
+
+	fprintf(file, "min   %g\n", min);
 	fprintf(file, "nsubs %lu\n", stats->nsubs);
 	fprintf(file, "ninfs %lu\n", stats->ninfs);
 	fprintf(file, "nnans %lu\n", stats->nnans);
 }
 
+/**
+ * Write the non-empty buckets of a histogram, each labelled with the
+ * smallest unbiased exponent it covers, or `sub` for the subnormals.
+ *   @file: The file.
+ *   @id: The histogram label.
+ *   @hist: The histogram.
+ *   @wid: The width, 32 or 64.
+ */
+static void saveh(FILE *file, const char *id, uint64_t *hist, int wid)
+{
+	unsigned int i;
+	int step = (wid == 32) ? (256 / HIST) : (2048 / HIST);
+	int bias = (wid == 32) ? 127 : 1023;
+
+	fprintf(file, "%s", id);
+
+	for(i = 0; i < HIST; i++) {
+		if(hist[i] == 0)
+			continue;
+
+		if(i == 0)
+			fprintf(file, " sub:%lu", hist[i]);
+		else
+			fprintf(file, " %d:%lu", ((i == 1) ? 1 : (int)i * step) - bias, hist[i]);
+	}
+
+	fprintf(file, "\n");
+}
+
+/**
+ * Order sites by decreasing number of special values.
+ *   @lhs: The left site.
+ *   @rhs: The right site.
+ *   &returns: The comparison.
+ */
+static int order(const void *lhs, const void *rhs)
+{
+	const struct site *a = lhs, *b = rhs;
+	uint64_t x = a->stats.nsubs + a->stats.ninfs + a->stats.nnans;
+	uint64_t y = b->stats.nsubs + b->stats.ninfs + b->stats.nnans;
+
+	return (x < y) ? 1 : ((x > y) ? -1 : ((a->id > b->id) - (a->id < b->id)));
+}
+
+/**
+ * Merge the counter blocks of all threads into a compacted table, ordered
+ * by decreasing number of special values.
+ *   @sites: Output. The table of `SITES + 2` entries.
+ *   @all: Output. The 32- and 64-bit totals.
+ *   &returns: The number of sites.
+ */
+static unsigned int collect(struct site *sites, struct site *all)
+{
+	struct block *block;
+	unsigned int i, n;
+
+	memset(sites, 0, (SITES + 2) * sizeof(struct site));
+	memset(all, 0, 2 * sizeof(struct site));
+	all[0].wid = 32, all[0].stats.min = UINT64_MAX;
+	all[1].wid = 64, all[1].stats.min = UINT64_MAX;
+
+	for(block = __atomic_load_n(&head, __ATOMIC_ACQUIRE); block != NULL; block = block->next) {
+		for(i = 0; i < SITES + 2; i++) {
+			struct site *site = (i < SITES) ? &block->sites[i] : &block->other[i - SITES];
+			uint32_t id = __atomic_load_n(&site->id, __ATOMIC_ACQUIRE);
+
+			if((id == 0) && ((i < SITES) || (site->wid == 0)))
+				continue;
+
+			merge(&all[site->wid == 64], site);
+			merge(find(sites, sites + SITES, id ? id : UINT32_MAX, site->wid), site);
+		}
+	}
+
+	for(i = n = 0; i < SITES + 2; i++) {
+		if(sites[i].wid != 0)
+			sites[n++] = sites[i];
+	}
+
+	qsort(sites, n, sizeof(struct site), order);
+
+	return n;
+}
+
+/**
+ * Write a site into a snapshot record.
+ *   @rec: The record.
+ *   @site: The site.
+ *   @id: The identifier, zero for the totals.
+ */
+static void record(struct fp_record *rec, struct site *site, uint32_t id)
+{
+	const char *str = id ? name(id) : "(total)";
+
+	rec->id = id;
+	rec->wid = site->wid;
+	rec->stats = site->stats;
+	memcpy(rec->ops, site->ops, sizeof(rec->ops));
+	memcpy(rec->res, site->res, sizeof(rec->res));
+	snprintf(rec->name, sizeof(rec->name), "%s", str ? str : "?");
+}
+
+/**
+ * Rewrite the snapshot file under its sequence lock.
+ *   @sites: The collected sites.
+ *   @all: The totals.
+ *   @n: The number of sites.
+ */
+static void snapshot(struct site *sites, struct site *all, unsigned int n)
+{
+	unsigned int i;
+	struct timespec ts;
+	struct fp_record *recs;
+
+	if(map == NULL)
+		return;
+
+	recs = (struct fp_record *)(map + 1);
+	if(n > map->cap - 2)
+		n = map->cap - 2;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+
+	__atomic_store_n(&map->seq, map->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	record(&recs[0], &all[0], 0);
+	record(&recs[1], &all[1], 0);
+
+	for(i = 0; i < n; i++)
+		record(&recs[i + 2], &sites[i], sites[i].id);
+
+	map->nrecs = n + 2;
+	map->time = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+
+	__atomic_store_n(&map->seq, map->seq + 1, __ATOMIC_RELEASE);
+}
+
 static void save(void)
 {
 	FILE *file;
 	char path[256];
+	struct site *sites, all[2];
+	unsigned int i, n;
+
+	sites = calloc(SITES + 2, sizeof(struct site));
+	if(sites == NULL)
+		return;
+
+	pthread_mutex_lock(&lock);
+	n = collect(sites, all);
+	snapshot(sites, all, n);
+
+	if(map != NULL)
+		msync(map, mapsz, MS_ASYNC);
+
+	pthread_mutex_unlock(&lock);
 
 	snprintf(path, 256, "/tmp/fp.stats");
 	file = fopen(path, "w");
 	if(file != NULL) {
 		fprintf(file, "# 32-bit\n");
-		save1(file, &stats32);
+		save1(file, &all[0].stats, 32);
 		fprintf(file, "# 64-bit\n");
-		save1(file, &stats64);
+		save1(file, &all[1].stats, 64);
+
+		for(i = 0; i < n; i++) {
+			const char *str = name(sites[i].id);
+
+			fprintf(file, "# site %08x %d-bit %s\n", sites[i].id, sites[i].wid, str ? str : "?");
+			save1(file, &sites[i].stats, sites[i].wid);
+			saveh(file, "ops  ", sites[i].ops, sites[i].wid);
+			saveh(file, "res  ", sites[i].res, sites[i].wid);
+		}
+
+		fclose(file);
 	}
+
+	free(sites);
 }
 
-static void fp32v1_proc(float f)
+/**
+ * Merge the per-thread counters, and rewrite the snapshot and statistics
+ * files on demand.
+ */
+void fp_stats_save(void)
 {
 	pthread_once(&once, init);
-	if(0)pthread_mutex_lock(&mutex);
+	save();
+}
 
-	f = fabsf(f);
+/*
+ * lane classification
+ *   Magnitudes are classified on their exponent and mantissa bits; the
+ *   vector versions compare all lanes at once and reduce the masks. The
+ *   histogram bucket is the biased exponent, sliced as in `bucket`.
+ */
+static void fp32v1_proc(struct site *site, uint64_t *hist, float f, uint64_t n)
+{
+	uint32_t a;
 
-	if((f > 0.0f) && (f < stats32.min))
-		stats32.min = f;
+	memcpy(&a, &f, sizeof(a));
+	a &= 0x7FFFFFFF;
 
-	if(fpclassify(f) == FP_SUBNORMAL)
-		stats32.nsubs++;
-	else if(fpclassify(f) == FP_INFINITE)
-		stats32.ninfs++;
-	else if(fpclassify(f) == FP_NAN)
-		stats32.nnans++;
+	if(a == 0)
+		return;
 
-	if(0)pthread_mutex_unlock(&mutex);
+	bump(&hist[bucket(a, 23, 2)], n);
+
+	if(a < 0x7F800000)
+		lower(&site->stats.min, a);
+
+	if((a & 0x7F800000) == 0)
+		bump(&site->stats.nsubs, n);
+	else if(a == 0x7F800000)
+		bump(&site->stats.ninfs, n);
+	else if(a > 0x7F800000)
+		bump(&site->stats.nnans, n);
 }
-static void fp64v1_proc(double f)
+static void fp64v1_proc(struct site *site, uint64_t *hist, double f, uint64_t n)
 {
-	pthread_once(&once, init);
-	if(1)pthread_mutex_lock(&mutex);
+	uint64_t a;
 
-	f = fabs(f);
+	memcpy(&a, &f, sizeof(a));
+	a &= 0x7FFFFFFFFFFFFFFF;
 
-	if((f > 0.0) && (f < stats64.min))
-		stats64.min = f;
+	if(a == 0)
+		return;
 
-	if(fpclassify(f) == FP_SUBNORMAL)
-		stats64.nsubs++;
-	else if(fpclassify(f) == FP_INFINITE)
-		stats64.ninfs++;
-	else if(fpclassify(f) == FP_NAN)
-		stats64.nnans++;
+	bump(&hist[bucket(a, 52, 5)], n);
 
-	if(1)pthread_mutex_unlock(&mutex);
+	if(a < 0x7FF0000000000000)
+		lower(&site->stats.min, a);
+
+	if((a & 0x7FF0000000000000) == 0)
+		bump(&site->stats.nsubs, n);
+	else if(a == 0x7FF0000000000000)
+		bump(&site->stats.ninfs, n);
+	else if(a > 0x7FF0000000000000)
+		bump(&site->stats.nnans, n);
 }
 
-#define PROC32(TY, WID, SZ) \
-	static void fp##WID##v##SZ##_proc(TY##SZ f) { \
-		for(int i = 0; i < SZ; i++) fp##WID##v1_proc(f[i]); \
+#define PROCV(TY, UT, WID, SZ, ABS, INF, MAN, SH) \
+	static void fp##WID##v##SZ##_proc(struct site *site, uint64_t *hist, TY##SZ f, uint64_t n) { \
+		UT##SZ a = (UT##SZ)f & ABS; \
+		UT##SZ fin = (UT##SZ)((a != 0) & (a < INF)); \
+		UT##SZ sub = (UT##SZ)((a != 0) & ((a & INF) == 0)); \
+		UT##SZ inf = (UT##SZ)(a == INF); \
+		UT##SZ nan = (UT##SZ)(a > INF); \
+		uint64_t min = UINT64_MAX, nsubs = 0, ninfs = 0, nnans = 0; \
+		for(int i = 0; i < SZ; i++) { \
+			if(fin[i] && (a[i] < min)) min = a[i]; \
+			if(a[i] != 0) bump(&hist[bucket(a[i], MAN, SH)], n); \
+			nsubs += sub[i] & 1; \
+			ninfs += inf[i] & 1; \
+			nnans += nan[i] & 1; \
+		} \
+		lower(&site->stats.min, min); \
+		bump(&site->stats.nsubs, nsubs * n); \
+		bump(&site->stats.ninfs, ninfs * n); \
+		bump(&site->stats.nnans, nnans * n); \
 	}
 
-PROC32(float, 32, 2)
-PROC32(float, 32, 4)
-PROC32(float, 32, 8)
-PROC32(float, 32, 16)
-PROC32(double, 64, 2)
-PROC32(double, 64, 4)
-PROC32(double, 64, 8)
+PROCV(float, uint, 32, 2, 0x7FFFFFFF, 0x7F800000, 23, 2)
+PROCV(float, uint, 32, 4, 0x7FFFFFFF, 0x7F800000, 23, 2)
+PROCV(float, uint, 32, 8, 0x7FFFFFFF, 0x7F800000, 23, 2)
+PROCV(float, uint, 32, 16, 0x7FFFFFFF, 0x7F800000, 23, 2)
+PROCV(double, ulong, 64, 2, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, 52, 5)
+PROCV(double, ulong, 64, 4, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, 52, 5)
+PROCV(double, ulong, 64, 8, 0x7FFFFFFFFFFFFFFF, 0x7FF0000000000000, 52, 5)
 
 #define MKSQRT(TY, FUN, SZ) \
 	static TY##SZ FUN##SZ(TY##SZ f) { \
@@ -144,17 +756,29 @@ MKSQRT(double, sqrt, 8)
 
 
 #define fp_un(TY, WID, SZ, FUN, NAM) \
-	TY fp##WID##v##SZ##_##NAM(TY a) { \
-		fp##WID##v##SZ##_proc(a); \
-		return FUN(a); \
+	TY fp##WID##v##SZ##_##NAM(TY a, uint32_t id) { \
+		TY r = FUN(a); \
+		if(sample()) { \
+			struct block *block = get(); \
+			struct site *site = find(block->sites, block->other, id, WID); \
+			uint64_t n = __atomic_load_n(&period, __ATOMIC_RELAXED); \
+			fp##WID##v##SZ##_proc(site, site->ops, a, n); \
+			fp##WID##v##SZ##_proc(site, site->res, r, n); \
+		} \
+		return r; \
 	}
 
 #define fp_bin(TY, WID, SZ, OP, NAM) \
-	TY fp##WID##v##SZ##_##NAM(TY a, TY b) { \
+	TY fp##WID##v##SZ##_##NAM(TY a, TY b, uint32_t id) { \
 		TY r = a OP b; \
-		fp##WID##v##SZ##_proc(a); \
-		fp##WID##v##SZ##_proc(b); \
-		fp##WID##v##SZ##_proc(r); \
+		if(sample()) { \
+			struct block *block = get(); \
+			struct site *site = find(block->sites, block->other, id, WID); \
+			uint64_t n = __atomic_load_n(&period, __ATOMIC_RELAXED); \
+			fp##WID##v##SZ##_proc(site, site->ops, a, n); \
+			fp##WID##v##SZ##_proc(site, site->ops, b, n); \
+			fp##WID##v##SZ##_proc(site, site->res, r, n); \
+		} \
 		return r; \
 	}
 
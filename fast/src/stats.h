@@ -0,0 +1,39 @@
+#ifndef CTFP_STATS_H
+#define CTFP_STATS_H
+
+#include <stdint.h>
+
+/*
+ * stats snapshot file
+ *   Every instrumented process maps `fp.stats.<pid>` in `CTFP_STATS_DIR`
+ *   (default `/tmp`) and periodically rewrites it with the merged counters.
+ *   The file is a header followed by `cap` records, of which the first
+ *   `nrecs` are valid; records 0 and 1 hold the 32- and 64-bit totals and
+ *   have a zero identifier. Writers make `seq` odd while updating, so a
+ *   reader retries until it observes the same even value on both sides of
+ *   its copy.
+ */
+#define FP_STATS_MAGIC   0x53504643
+#define FP_STATS_VERSION 1
+#define FP_STATS_HIST    64
+#define FP_STATS_NAME    112
+
+struct fp_stats {
+	uint64_t min;
+	uint64_t nsubs, ninfs, nnans;
+};
+
+struct fp_record {
+	uint32_t id, wid;
+	struct fp_stats stats;
+	uint64_t ops[FP_STATS_HIST], res[FP_STATS_HIST];
+	char name[FP_STATS_NAME];
+};
+
+struct fp_header {
+	uint32_t magic, version;
+	uint64_t pid, seq, time;
+	uint32_t nrecs, cap;
+};
+
+#endif
@@ -145,6 +145,120 @@ template<class T> T fp_max(T a, T b) {
 		return fp_gte(a, b) ? a : b;
 }
 
+/**
+ * Add two intervals, rounding outward.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_iadd(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_iadd`.", typeid(T).name());
+}
+template<> void fp_iadd<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(0.0, 0.0, ahi, -alo), r = _mm_set_ps(0.0, 0.0, bhi, -blo);
+
+	fp_pin(l);
+	__m128 res = _mm_add_ps(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_iadd<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	fp_pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Subtract two intervals, rounding outward. The lower bound is `alo - bhi`
+ * and the upper bound `ahi - blo`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_isub(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_isub`.", typeid(T).name());
+}
+template<> void fp_isub<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(0.0, 0.0, ahi, -alo), r = _mm_set_ps(0.0, 0.0, -blo, bhi);
+
+	fp_pin(l);
+	__m128 res = _mm_add_ps(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_isub<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(-blo, bhi);
+
+	fp_pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Multiply two intervals, rounding outward. The four cross products are
+ * computed with each sign, the negated ones bounding `-lo` and the others
+ * bounding `hi`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+template<class T> void fp_imul(T alo, T ahi, T blo, T bhi, T *lo, T *hi) {
+	fatal("Unsupported type '%s' for `fp_imul`.", typeid(T).name());
+}
+template<> void fp_imul<float>(float alo, float ahi, float blo, float bhi, float *lo, float *hi) {
+	FpRound round;
+	__m128 l = _mm_set_ps(-ahi, alo, ahi, -alo), r = _mm_set_ps(-blo, bhi, bhi, -blo);
+
+	fp_pin(l);
+	__m128 up = fp_num(_mm_mul_ps(l, r));
+	__m128 dn = fp_num(_mm_mul_ps(_mm_xor_ps(l, _mm_set1_ps(-0.0)), r));
+	__m128 max = _mm_max_ps(_mm_shuffle_ps(dn, up, _MM_SHUFFLE(1, 0, 1, 0)), _mm_shuffle_ps(dn, up, _MM_SHUFFLE(3, 2, 3, 2)));
+	__m128 res = _mm_max_ps(_mm_shuffle_ps(max, max, _MM_SHUFFLE(2, 0, 2, 0)), _mm_shuffle_ps(max, max, _MM_SHUFFLE(3, 1, 3, 1)));
+	fp_pin(res);
+
+	*lo = -_mm_cvtss_f32(res);
+	*hi = _mm_cvtss_f32(_mm_shuffle_ps(res, res, 1));
+}
+template<> void fp_imul<double>(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	fp_pin(l);
+	__m128d nl = _mm_xor_pd(l, _mm_set1_pd(-0.0)), sr = _mm_shuffle_pd(r, r, 1);
+	__m128d up = _mm_max_pd(fp_num(_mm_mul_pd(l, r)), fp_num(_mm_mul_pd(nl, sr)));
+	__m128d dn = _mm_max_pd(fp_num(_mm_mul_pd(nl, r)), fp_num(_mm_mul_pd(l, sr)));
+	__m128d res = _mm_max_pd(_mm_unpacklo_pd(dn, up), _mm_unpackhi_pd(dn, up));
+	fp_pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
 template bool fp_eq<double>(double a, double b);
 template bool fp_gte<double>(double a, double b);
 template bool fp_lte<double>(double a, double b);
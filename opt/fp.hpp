@@ -22,6 +22,50 @@ template<class T> T fp_min(T a, T b);
 template<class T> T fp_max(T a, T b);
 //template double fp_max<double>(double a, double b);
 
+template<class T> void fp_iadd(T alo, T ahi, T blo, T bhi, T *lo, T *hi);
+template<class T> void fp_isub(T alo, T ahi, T blo, T bhi, T *lo, T *hi);
+template<class T> void fp_imul(T alo, T ahi, T blo, T bhi, T *lo, T *hi);
+
+
+/*
+ * rounding class
+ *   Switches SSE arithmetic to round upward, with subnormals enabled, for
+ *   the lifetime of the object. The interval kernels carry an interval as
+ *   the pair `-lo, hi`, so that one upward rounding mode rounds both bounds
+ *   outward. Nested instances find the mode already set and leave it alone,
+ *   so a loop can hold one around many interval operations.
+ */
+class FpRound {
+public:
+	FpRound() { csr = _mm_getcsr(); if(csr != Up(csr)) _mm_setcsr(Up(csr)); }
+	~FpRound() { if(csr != Up(csr)) _mm_setcsr(csr); }
+
+	FpRound(FpRound const&) = delete;
+	FpRound& operator=(FpRound const&) = delete;
+
+private:
+	unsigned int csr;
+
+	static unsigned int Up(unsigned int csr) { return (csr & ~0xE040) | 0x4000; }
+};
+
+/**
+ * Pin a vector in a register, so that the arithmetic producing or using it
+ * is not moved across a change of the rounding mode.
+ *   @v: The vector.
+ */
+static inline void fp_pin(__m128 &v) { __asm__ volatile("" : "+x"(v)); }
+static inline void fp_pin(__m128d &v) { __asm__ volatile("" : "+x"(v)); }
+
+/**
+ * Replace NaN lanes with zero. Products of a zero and an infinite bound are
+ * taken as zero, their limit over the interval.
+ *   @v: The vector.
+ *   &returns: The vector without NaNs.
+ */
+static inline __m128 fp_num(__m128 v) { return _mm_andnot_ps(_mm_cmpunord_ps(v, v), v); }
+static inline __m128d fp_num(__m128d v) { return _mm_andnot_pd(_mm_cmpunord_pd(v, v), v); }
+
 
 template <class T> T fp_lsb(T v) {
 	int exp;
@@ -11,6 +11,7 @@
 #include <variant>
 #include <vector>
 
+#include <emmintrin.h>
 #include <float.h>
 #include <math.h>
 #include <stdint.h>
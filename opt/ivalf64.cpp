@@ -54,38 +54,45 @@ template <class T> IvalFlt<T> IvalFlt<T>::Abs(IvalFlt const& in) {
 }
 
 /**
- * Add two float intervals.
+ * Add two float intervals, rounding outward.
  *   @lhs: The left-hand side.
  *   @rhs: The right-hand side.
  *   &returns: The result interval.
  */
 template <class T> IvalFlt<T> IvalFlt<T>::Add(IvalFlt const& lhs, IvalFlt const& rhs) {
-	return IvalFlt(lhs.lo + rhs.lo, lhs.hi + rhs.hi, std::min(lhs.lsb, rhs.lsb));
+	T lo, hi;
+
+	fp_iadd<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
+
+	return IvalFlt(lo, hi, std::min(lhs.lsb, rhs.lsb));
 }
 
 /**
- * Subtract two float intervals.
+ * Subtract two float intervals, rounding outward.
  *   @lhs: The left-hand side.
  *   @rhs: The right-hand side.
  *   &returns: The result interval.
  */
 template <class T> IvalFlt<T> IvalFlt<T>::Sub(IvalFlt const& lhs, IvalFlt const& rhs) {
-	return IvalFlt(lhs.lo - rhs.lo, lhs.hi - rhs.hi, std::min(lhs.lsb, rhs.lsb));
+	T lo, hi;
+
+	fp_isub<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
+
+	return IvalFlt(lo, hi, std::min(lhs.lsb, rhs.lsb));
 }
 
 /**
- * Multiply two float intervals.
+ * Multiply two float intervals, rounding outward.
  *   @lhs: The left-hand side.
  *   @rhs: The right-hand side.
  *   &returns: The result interval.
  */
 template <class T> IvalFlt<T> IvalFlt<T>::Mul(IvalFlt const& lhs, IvalFlt const& rhs) {
-	double a = lhs.lo * rhs.lo;
-	double b = lhs.hi * rhs.lo;
-	double c = lhs.lo * rhs.hi;
-	double d = lhs.hi * rhs.hi;
+	T lo, hi;
+
+	fp_imul<T>(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &lo, &hi);
 
-	return IvalFlt(std::min({ a, b, c, d }), std::max({ a, b, c, d }), lhs.lsb + rhs.lsb);
+	return IvalFlt(lo, hi, lhs.lsb + rhs.lsb);
 }
 
 
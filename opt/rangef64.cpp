@@ -196,6 +196,8 @@ template <class T> RangeFlt<T> RangeFlt<T>::Add(const RangeFlt<T> &lhs, const Ra
 	res.nan |= lhs.Contains(-INFINITY) && rhs.Contains(INFINITY);
 	res.nan |= lhs.Contains(INFINITY) && rhs.Contains(-INFINITY);
 
+	FpRound round;
+
 	for(auto &x : lhs.ivals) {
 		for(auto &y: rhs.ivals)
 			res.ivals.push_back(IvalFlt<T>::Add(x, y));
@@ -216,6 +218,8 @@ template <class T> RangeFlt<T> RangeFlt<T>::Sub(const RangeFlt<T> &lhs, const Ra
 	res.nan |= lhs.Contains(INFINITY) && rhs.Contains(INFINITY);
 	res.nan |= lhs.Contains(-INFINITY) && rhs.Contains(-INFINITY);
 
+	FpRound round;
+
 	for(auto &x : lhs.ivals) {
 		for(auto &y: rhs.ivals)
 			res.ivals.push_back(IvalFlt<T>::Sub(x, y));
@@ -236,6 +240,8 @@ template <class T> RangeFlt<T> RangeFlt<T>::Mul(const RangeFlt<T> &lhs, const Ra
 	res.nan |= (lhs.Contains(INFINITY) || lhs.Contains(-INFINITY)) && (rhs.Contains(0.0) || rhs.Contains(-0.0));
 	res.nan |= (lhs.Contains(0.0) || lhs.Contains(-0.0)) && (rhs.Contains(INFINITY) || rhs.Contains(-INFINITY));
 
+	FpRound round;
+
 	for(auto &x : lhs.ivals) {
 		for(auto &y: rhs.ivals)
 			res.ivals.push_back(IvalFlt<T>::Mul(x, y));
@@ -0,0 +1,292 @@
+#include "inc.hpp"
+
+
+/** BddNode class **/
+
+/**
+ * Construct a leaf.
+ *   @range: The range.
+ */
+BddNode::BddNode(Range const &_range) {
+	level = Bdd::Leaf;
+	lo = hi = nullptr;
+	range = _range;
+}
+
+/**
+ * Check if the node is a leaf.
+ *   &returns: True if a leaf.
+ */
+bool BddNode::IsLeaf() const {
+	return level == Bdd::Leaf;
+}
+
+
+/** Bdd class **/
+
+/**
+ * Retrieve the leaf of a range, adding it if new.
+ *   @range: The range.
+ *   &returns: The leaf.
+ */
+const BddNode *Bdd::Get(Range const &range) {
+	size_t hash = range.Hash();
+	auto find = leaves.equal_range(hash);
+
+	for(auto iter = find.first; iter != find.second; iter++) {
+		if(Range::Equal(iter->second->range, range))
+			return iter->second;
+	}
+
+	arena.push_back(BddNode(range));
+	leaves.insert({ hash, &arena.back() });
+
+	return &arena.back();
+}
+
+/**
+ * Retrieve the inner node testing a level, adding it if new. A test with
+ * equal branches is redundant and reduces to the branch.
+ *   @level: The level.
+ *   @lo: The node taken if false.
+ *   @hi: The node taken if true.
+ *   &returns: The node.
+ */
+const BddNode *Bdd::Get(uint32_t level, const BddNode *lo, const BddNode *hi) {
+	if(lo == hi)
+		return lo;
+
+	auto key = std::make_tuple(level, lo, hi);
+	auto find = inner.find(key);
+	if(find != inner.end())
+		return find->second;
+
+	arena.push_back(BddNode(level, lo, hi));
+	inner[key] = &arena.back();
+
+	return &arena.back();
+}
+
+/**
+ * Retrieve the level of a variable, ordering it last if new.
+ *   @var: The variable.
+ *   &returns: The level.
+ */
+uint32_t Bdd::Level(const llvm::Value *var) {
+	auto ins = levels.insert({ var, (uint32_t)vars.size() });
+	if(ins.second)
+		vars.push_back(var);
+
+	return ins.first->second;
+}
+
+
+/**
+ * Apply a function to every leaf of a diagram. Infeasible leaves are kept.
+ *   @in: The diagram.
+ *   @func: The function.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Map(const BddNode *in, std::function<Range(Range const &)> const &func) {
+	Memo memo;
+
+	return Apply(std::vector<const BddNode *>{ in }, true, [&func](std::vector<const Range *> const &args) { return func(*args[0]); }, memo);
+}
+
+/**
+ * Apply a function to every pair of leaves reached by the same path. A
+ * path infeasible in either diagram is infeasible in the result.
+ *   @lhs: The left-hand diagram.
+ *   @rhs: The right-hand diagram.
+ *   @func: The function.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Apply(const BddNode *lhs, const BddNode *rhs, std::function<Range(Range const &, Range const &)> const &func) {
+	Memo memo;
+
+	return Apply(std::vector<const BddNode *>{ lhs, rhs }, true, [&func](std::vector<const Range *> const &args) { return func(*args[0], *args[1]); }, memo);
+}
+
+/**
+ * Apply a function to the leaves reached by the same path through any
+ * number of diagrams. A path infeasible in any of them is infeasible in
+ * the result.
+ *   @in: The diagrams.
+ *   @func: The function.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Apply(std::vector<const BddNode *> const &in, std::function<Range(std::vector<const Range *> const &)> const &func) {
+	Memo memo;
+
+	return Apply(in, true, func, memo);
+}
+
+/**
+ * Apply a function to the leaves of a condition and its two choices. The
+ * function sees infeasible leaves, as a choice is only infeasible where
+ * it is taken.
+ *   @cond: The condition diagram.
+ *   @ontrue: The true diagram.
+ *   @onfalse: The false diagram.
+ *   @func: The function.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Select(const BddNode *cond, const BddNode *ontrue, const BddNode *onfalse, std::function<Range(Range const &, Range const &, Range const &)> const &func) {
+	Memo memo;
+
+	return Apply(std::vector<const BddNode *>{ cond, ontrue, onfalse }, false, [&func](std::vector<const Range *> const &args) { return func(*args[0], *args[1], *args[2]); }, memo);
+}
+
+/**
+ * Build a diagram that takes one diagram when a variable holds and another
+ * otherwise.
+ *   @var: The variable.
+ *   @hi: The true diagram.
+ *   @lo: The false diagram.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Branch(const llvm::Value *var, const BddNode *hi, const BddNode *lo) {
+	const BddNode *test = Get(Level(var), Get(RangeBool::Const(false)), Get(RangeBool::Const(true)));
+
+	return Select(test, hi, lo, [](Range const &cond, Range const &ontrue, Range const &onfalse) {
+		return std::get<RangeBool>(cond.var).istrue ? ontrue : onfalse;
+	});
+}
+
+/**
+ * Eliminate a variable by joining its branches.
+ *   @in: The diagram.
+ *   @level: The level of the variable.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Exists(const BddNode *in, uint32_t level) {
+	std::map<const BddNode *, const BddNode *> memo;
+	std::function<const BddNode *(const BddNode *)> rec = [&](const BddNode *node) -> const BddNode * {
+		if(node->level > level)
+			return node;
+
+		auto find = memo.find(node);
+		if(find != memo.end())
+			return find->second;
+
+		Memo join;
+		const BddNode *res;
+
+		if(node->level == level)
+			res = Apply(std::vector<const BddNode *>{ node->lo, node->hi }, false, [](std::vector<const Range *> const &args) { return Range::Union(*args[0], *args[1]); }, join);
+		else
+			res = Get(node->level, rec(node->lo), rec(node->hi));
+
+		return memo[node] = res;
+	};
+
+	return rec(in);
+}
+
+/**
+ * Bound the number of variables of a diagram by the cap, eliminating the
+ * variables tested by the fewest nodes, the latest first on a tie. Such a
+ * variable separates few subgraphs, so joining it loses the least.
+ *   @in: The diagram.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Limit(const BddNode *in) {
+	std::map<uint32_t, uint32_t> support = Support(in);
+
+	while(support.size() > cap) {
+		auto least = support.begin();
+
+		for(auto iter = support.begin(); iter != support.end(); iter++) {
+			if(iter->second <= least->second)
+				least = iter;
+		}
+
+		in = Exists(in, least->first);
+		support = Support(in);
+	}
+
+	return in;
+}
+
+
+/**
+ * Retrieve the nodes of a diagram, each once, children first.
+ *   @in: The diagram.
+ *   &returns: The nodes.
+ */
+std::vector<const BddNode *> Bdd::Nodes(const BddNode *in) const {
+	std::vector<const BddNode *> res;
+	std::set<const BddNode *> seen;
+	std::function<void(const BddNode *)> rec = [&](const BddNode *node) {
+		if(!seen.insert(node).second)
+			return;
+
+		if(!node->IsLeaf())
+			rec(node->lo), rec(node->hi);
+
+		res.push_back(node);
+	};
+
+	rec(in);
+
+	return res;
+}
+
+/**
+ * Retrieve the variables tested by a diagram.
+ *   @in: The diagram.
+ *   &returns: The number of nodes testing each level.
+ */
+std::map<uint32_t, uint32_t> Bdd::Support(const BddNode *in) const {
+	std::map<uint32_t, uint32_t> res;
+
+	for(auto node : Nodes(in)) {
+		if(!node->IsLeaf())
+			res[node->level]++;
+	}
+
+	return res;
+}
+
+
+/**
+ * Apply a function to the leaves reached by the same path through several
+ * diagrams, recursing on the topmost level tested by any of them.
+ *   @in: The diagrams.
+ *   @strict: Make a path infeasible if any of its leaves is.
+ *   @func: The function.
+ *   @memo: The results of the nodes visited so far.
+ *   &returns: The diagram.
+ */
+const BddNode *Bdd::Apply(std::vector<const BddNode *> const &in, bool strict, std::function<Range(std::vector<const Range *> const &)> const &func, Memo &memo) {
+	uint32_t top = Leaf;
+
+	for(auto node : in)
+		top = std::min(top, node->level);
+
+	if(top == Leaf) {
+		std::vector<const Range *> args;
+
+		for(auto node : in) {
+			if(strict && node->range.IsNone())
+				return node;
+
+			args.push_back(&node->range);
+		}
+
+		return Get(func(args));
+	}
+
+	auto find = memo.find(in);
+	if(find != memo.end())
+		return find->second;
+
+	std::vector<const BddNode *> lo, hi;
+
+	for(auto node : in) {
+		lo.push_back((node->level == top) ? node->lo : node);
+		hi.push_back((node->level == top) ? node->hi : node);
+	}
+
+	return memo[in] = Get(top, Apply(lo, strict, func, memo), Apply(hi, strict, func, memo));
+}
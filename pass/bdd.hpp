@@ -0,0 +1,81 @@
+#ifndef BDD_HPP
+#define BDD_HPP
+
+/*
+ * class prototypes
+ */
+class Bdd;
+class BddNode;
+
+/*
+ * decision diagram node
+ *   Inner nodes test the condition variable of their level, taking `hi`
+ *   when it holds and `lo` otherwise. Leaves have the level `Bdd::Leaf`
+ *   and hold a range; the empty range marks an infeasible path.
+ */
+class BddNode {
+public:
+	uint32_t level;
+	const BddNode *lo, *hi;
+	Range range;
+
+	BddNode(uint32_t _level, const BddNode *_lo, const BddNode *_hi) { level = _level; lo = _lo; hi = _hi; }
+	BddNode(Range const &_range);
+	~BddNode() { }
+
+	bool IsLeaf() const;
+};
+
+/*
+ * decision diagram class
+ *
+ * Reduced ordered multi-terminal decision diagrams over the condition
+ * variables of a function, with range leaves. Nodes are hash-consed, so
+ * equal subgraphs are shared and compared by address. Variables are
+ * ordered by first use, which is program order for the comparisons. Once
+ * a diagram tests more than `cap` variables, the least used ones are
+ * merged away by joining their branches.
+ */
+class Bdd {
+public:
+	static constexpr uint32_t Leaf = UINT32_MAX;
+
+	uint32_t cap;
+
+	Bdd(uint32_t _cap = 12) { cap = _cap; }
+	~Bdd() { }
+
+	Bdd(Bdd const&) = delete;
+	Bdd& operator=(Bdd const&) = delete;
+
+	const BddNode *Get(Range const &range);
+	const BddNode *Get(uint32_t level, const BddNode *lo, const BddNode *hi);
+
+	uint32_t Level(const llvm::Value *var);
+	const llvm::Value *Var(uint32_t level) const { return vars[level]; }
+
+	const BddNode *Map(const BddNode *in, std::function<Range(Range const &)> const &func);
+	const BddNode *Apply(const BddNode *lhs, const BddNode *rhs, std::function<Range(Range const &, Range const &)> const &func);
+	const BddNode *Apply(std::vector<const BddNode *> const &in, std::function<Range(std::vector<const Range *> const &)> const &func);
+	const BddNode *Select(const BddNode *cond, const BddNode *ontrue, const BddNode *onfalse, std::function<Range(Range const &, Range const &, Range const &)> const &func);
+	const BddNode *Branch(const llvm::Value *var, const BddNode *hi, const BddNode *lo);
+	const BddNode *Exists(const BddNode *in, uint32_t level);
+	const BddNode *Limit(const BddNode *in);
+
+	std::vector<const BddNode *> Nodes(const BddNode *in) const;
+	std::map<uint32_t, uint32_t> Support(const BddNode *in) const;
+
+private:
+	std::deque<BddNode> arena;
+	std::multimap<size_t, const BddNode *> leaves;
+	std::map<std::tuple<uint32_t, const BddNode *, const BddNode *>, const BddNode *> inner;
+
+	std::vector<const llvm::Value *> vars;
+	std::map<const llvm::Value *, uint32_t> levels;
+
+	typedef std::map<std::vector<const BddNode *>, const BddNode *> Memo;
+
+	const BddNode *Apply(std::vector<const BddNode *> const &in, bool strict, std::function<Range(std::vector<const Range *> const &)> const &func, Memo &memo);
+};
+
+#endif
@@ -4,30 +4,226 @@
 /** Fact class **/
 
 /**
- * Propagate facts backwards.
+ * Propagate facts backwards, narrowing the arguments by the inverse of the
+ * operation along every path. Arguments that narrow propagate in turn.
  */
 void Fact::InvProp() {
+	std::vector<const BddNode *> prev;
+
+	for(auto arg : args)
+		prev.push_back(arg->root);
+
 	switch(op) {
 	case Op::ConstI64:
 	case Op::ConstF64:
 		break;
 
 	case Op::AbsF64:
-		args[0]->vars = vars;
-		args[0]->ranges.clear();
+		Narrow(*args[0], { root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::AbsInv(in[1]->GetF64());
+		});
 
-		for(auto &range : ranges) {
-			if(std::holds_alternative<RangeF64>(range.var))
-				args[0]->ranges.push_back(RangeF64::AbsInv(std::get<RangeF64>(range.var)));
-			else
-				fatal("AbsF64 must be applied to RangeF64.");
+		break;
+
+	case Op::AddF64:
+		Narrow(*args[0], { root, args[1]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::AddInv(in[1]->GetF64(), in[2]->GetF64());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::AddInv(in[1]->GetF64(), in[2]->GetF64());
+		});
+
+		break;
+
+	case Op::SubF64:
+		Narrow(*args[0], { root, args[1]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::SubInvL(in[1]->GetF64(), in[2]->GetF64());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::SubInvR(in[1]->GetF64(), in[2]->GetF64());
+		});
+
+		break;
+
+	case Op::MulF64:
+		Narrow(*args[0], { root, args[1]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::MulInv(in[1]->GetF64(), in[2]->GetF64());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::MulInv(in[1]->GetF64(), in[2]->GetF64());
+		});
+
+		break;
+
+	case Op::CopySignF64:
+		Narrow(*args[0], { root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::AbsInv(RangeF64::Abs(in[1]->GetF64()));
+		});
+		Narrow(*args[1], { root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::CopySignInv(in[1]->GetF64());
+		});
+
+		break;
+
+	case Op::CmpOltF64:
+	case Op::CmpOgtF64:
+		{
+			/* swapping the operands of a greater than gives a less than */
+			bool gt = (op == Op::CmpOgtF64);
+			Fact &lhs = *args[gt ? 1 : 0], &rhs = *args[gt ? 0 : 1];
+
+			/* taken, `lhs < rhs` and neither is NaN; not taken, `lhs >= rhs` unless either is NaN */
+			Narrow(lhs, { root, rhs.root }, [](std::vector<const Range *> const &in) -> Range {
+				RangeBool const &cond = in[1]->GetBool();
+				RangeF64 const &x = in[0]->GetF64(), &y = in[2]->GetF64();
+
+				if(cond.istrue && !cond.isfalse)
+					return x.Below(Fact::Prev64(y.Upper()), false);
+				else if(cond.isfalse && !cond.istrue && !y.nan)
+					return x.Above(y.Lower(), true);
+				else
+					return RangeF64::All();
+			});
+			Narrow(rhs, { root, lhs.root }, [](std::vector<const Range *> const &in) -> Range {
+				RangeBool const &cond = in[1]->GetBool();
+				RangeF64 const &y = in[0]->GetF64(), &x = in[2]->GetF64();
+
+				if(cond.istrue && !cond.isfalse)
+					return y.Above(Fact::Next64(x.Lower()), false);
+				else if(cond.isfalse && !cond.istrue && !x.nan)
+					return y.Below(x.Upper(), true);
+				else
+					return RangeF64::All();
+			});
 		}
 
 		break;
 
+	case Op::SelectI64:
+		/* a choice that cannot produce the result is not taken */
+		Narrow(*args[0], { root, args[1]->root, args[2]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeBool(!Range::Inter(*in[1], *in[2]).IsNone(), !Range::Inter(*in[1], *in[3]).IsNone());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return in[2]->GetBool().isfalse ? *in[0] : *in[1];
+		});
+		Narrow(*args[2], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return in[2]->GetBool().istrue ? *in[0] : *in[1];
+		});
+
+		break;
+
+	case Op::AndI64:
+		Narrow(*args[0], { root, args[1]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeI64::AndInv(in[1]->GetI64(), in[2]->GetI64());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeI64::AndInv(in[1]->GetI64(), in[2]->GetI64());
+		});
+
+		break;
+
+	case Op::XorI64:
+		Narrow(*args[0], { root, args[1]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeI64::Xor(in[1]->GetI64(), in[2]->GetI64());
+		});
+		Narrow(*args[1], { root, args[0]->root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeI64::Xor(in[1]->GetI64(), in[2]->GetI64());
+		});
+
+		break;
+
+	case Op::CastF64toI64:
+		Narrow(*args[0], { root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeF64::FromI64(in[1]->GetI64());
+		});
+
+		break;
+
+	case Op::CastI64toF64:
+		Narrow(*args[0], { root }, [](std::vector<const Range *> const &in) -> Range {
+			return RangeI64::CastF64(in[1]->GetF64());
+		});
+
+		break;
+
 	default:
 		fatal("stub %d", op);
 	}
+
+	for(unsigned int i = 0; i < args.size(); i++) {
+		if(args[i]->root != prev[i])
+			args[i]->InvProp();
+	}
+}
+
+/**
+ * Recompute the fact from its arguments, keeping what is already known.
+ * Comparisons only lose the outcomes their operands rule out.
+ *   &returns: True if the fact narrowed.
+ */
+bool Fact::Eval() {
+	const BddNode *next;
+
+	switch(op) {
+	case Op::ConstI64:
+	case Op::ConstF64:
+		return false;
+
+	case Op::AbsF64: next = Fact::AbsF64(*args[0]).root; break;
+	case Op::AddF64: next = Fact::AddF64(*args[0], *args[1], nullptr).root; break;
+	case Op::SubF64: next = Fact::SubF64(*args[0], *args[1], nullptr).root; break;
+	case Op::MulF64: next = Fact::MulF64(*args[0], *args[1], nullptr).root; break;
+	case Op::CopySignF64: next = Fact::CopySignF64(*args[0], *args[1]).root; break;
+	case Op::AndI64: next = Fact::AndI64(*args[0], *args[1]).root; break;
+	case Op::XorI64: next = Fact::XorI64(*args[0], *args[1]).root; break;
+	case Op::SelectI64: next = Fact::SelectI64(*args[0], *args[1], *args[2]).root; break;
+	case Op::CastF64toI64: next = Fact::CastF64toI64(*args[0]).root; break;
+	case Op::CastI64toF64: next = Fact::CastI64toF64(*args[0]).root; break;
+
+	case Op::CmpOltF64:
+	case Op::CmpOgtF64:
+		{
+			bool gt = (op == Op::CmpOgtF64);
+
+			next = bdd->Apply(args[gt ? 1 : 0]->root, args[gt ? 0 : 1]->root, [](Range const &lhs, Range const &rhs) -> Range {
+				RangeF64 const &x = lhs.GetF64(), &y = rhs.GetF64();
+				bool istrue = !x.ivals.empty() && !y.ivals.empty() && (x.Lower() < y.Upper());
+				bool isfalse = x.nan || y.nan || (x.Upper() >= y.Lower());
+
+				return RangeBool(istrue, isfalse);
+			});
+		}
+
+		break;
+
+	default:
+		fatal("stub %d", op);
+	}
+
+	next = bdd->Limit(bdd->Apply(root, next, Range::Inter));
+	if(next == root)
+		return false;
+
+	root = next;
+
+	return true;
+}
+
+/**
+ * Narrow an argument by intersecting it with a function of its leaves and
+ * the leaves of other diagrams along the same path.
+ *   @arg: The argument fact.
+ *   @in: The other diagrams.
+ *   @func: The function, given the argument leaf first and then the others.
+ */
+void Fact::Narrow(Fact &arg, std::vector<const BddNode *> const &in, std::function<Range(std::vector<const Range *> const &)> const &func) {
+	std::vector<const BddNode *> all{ arg.root };
+
+	all.insert(all.end(), in.begin(), in.end());
+	arg.root = bdd->Limit(bdd->Apply(all, [&func](std::vector<const Range *> const &leaves) {
+		return Range::Inter(*leaves[0], func(leaves));
+	}));
 }
 
 /**
@@ -37,8 +233,10 @@ void Fact::InvProp() {
 double Fact::LowerF64() const {
 	double min = DBL_MAX;
 
-	for(auto const &range : ranges)
-		min = fmin(min, range.LowerF64());
+	for(auto node : bdd->Nodes(root)) {
+		if(node->IsLeaf() && !node->range.IsNone())
+			min = fmin(min, node->range.LowerF64());
+	}
 
 	return min;
 }
@@ -50,54 +248,28 @@ double Fact::LowerF64() const {
 double Fact::UpperF64() const {
 	double max = -DBL_MAX;
 
-	for(auto const &range : ranges)
-		max = fmax(max, range.UpperF64());
+	for(auto node : bdd->Nodes(root)) {
+		if(node->IsLeaf() && !node->range.IsNone())
+			max = fmax(max, node->range.UpperF64());
+	}
 
 	return max;
 }
 
 
 /**
- * Retrieve the variable index limit.
- *   &returns: The limit.
+ * Join the ranges of every feasible path.
+ *   &returns: The range, empty if no path is feasible.
  */
-uint64_t Fact::Limit() const
-{
-	return 1 << vars.size();
-}
+Range Fact::Join() const {
+	Range res;
 
-/**
- * Retrieve the index of a variable.
- *   @var: The variable.
- *   &returns: The index, or negative zero if not found.
- */
-int32_t Fact::Index(const llvm::Value *var) const {
-	for(uint32_t i = 0; i < vars.size(); i++) {
-		if(vars[i] == var)
-			return i;
+	for(auto node : bdd->Nodes(root)) {
+		if(node->IsLeaf())
+			res = Range::Union(res, node->range);
 	}
 
-	return -1;
-}
-
-/**
- * Given a set of variables an index, retrieve the range it maps to.
- *   @vars: The variable array.
- *   @idx: The index.
- *   &returns: The range.
- */
-Range &Fact::Map(const std::vector<const llvm::Value *> &vars, uint64_t idx) {
-	uint64_t out = 0;
-
-	for(uint32_t i = 0; i < vars.size(); i++) {
-		int32_t k = Index(vars[i]);
-		if((k >= 0) && ((idx & (1 << i)) != 0))
-			out |= 1 << k;
-	}
-
-	assert(out < ranges.size());
-
-	return ranges[out];
+	return res;
 }
 
 
@@ -106,25 +278,28 @@ Range &Fact::Map(const std::vector<const llvm::Value *> &vars, uint64_t idx) {
  *   &returns: The string.
  */
 std::string Fact::Str() const {
-	if(ranges.size() > 1) {
+	if(!root->IsLeaf()) {
 		std::string str = "";
+		std::map<const BddNode *, unsigned int> ids;
+
+		for(auto node : bdd->Nodes(root))
+			ids.insert({ node, ids.size() });
 
-		unsigned int i = 0;
-		for(auto const &iter : ranges) {
-			str += "    ";
+		for(auto node : bdd->Nodes(root)) {
+			str += "    #" + std::to_string(ids[node]) + " ";
 
-			unsigned int k = 0;
-			for(auto var : vars) 
-				str += llvm_name(var) + std::string(((1 << k++) & i) ? "✔" : "✘");
+			if(node->IsLeaf())
+				str += node->range.IsNone() ? "∅" : node->range.Str();
+			else
+				str += llvm_name(bdd->Var(node->level)) + " ✔ #" + std::to_string(ids[node->hi]) + " ✘ #" + std::to_string(ids[node->lo]);
 
-			i++;
-			str += " " + iter.Str() + "\n";
+			str += "\n";
 		}
 
 		return str;
 	}
 	else
-		return "    " + ranges.front().Str() + "\n";
+		return "    " + (root->range.IsNone() ? std::string("∅") : root->range.Str()) + "\n";
 }
 
 /**
@@ -141,16 +316,14 @@ void Fact::Dump() const {
  *   @out: The output fact.
  */
 Fact Fact::AbsF64(Fact &in) {
-	Fact res(Op::AbsF64, std::vector<Fact *>{ &in }, in.vars);
+	Bdd &bdd = *in.bdd;
 
-	for(auto const &range : in.ranges) {
-		if(std::holds_alternative<RangeF64>(range.var))
-			res.ranges.push_back(RangeF64::Abs(std::get<RangeF64>(range.var)));
-		else
+	return Fact(Op::AbsF64, std::vector<Fact *>{ &in }, bdd, bdd.Map(in.root, [](Range const &range) -> Range {
+		if(!std::holds_alternative<RangeF64>(range.var))
 			fatal("AbsF64 must be applied to RangeF64.");
-	}
 
-	return res;
+		return RangeF64::Abs(std::get<RangeF64>(range.var));
+	}));
 }
 
 /**
@@ -161,19 +334,14 @@ Fact Fact::AbsF64(Fact &in) {
  *   &returns: The result fact.
  */
 Fact Fact::AddF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
-	Fact res(Op::AddF64, std::vector<Fact *>{ &lhs, &rhs, }, Fact::Cross(lhs.vars, rhs.vars));
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = lhs.Map(res.vars, i);
-		Range &y = rhs.Map(res.vars, i);
+	Bdd &bdd = *lhs.bdd;
 
+	return Fact(Op::AddF64, std::vector<Fact *>{ &lhs, &rhs, }, bdd, bdd.Apply(lhs.root, rhs.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeF64>(x.var) || !std::holds_alternative<RangeF64>(y.var))
 			fatal("AddF64 must be applied to RangeF64.");
 
-		res.ranges.push_back(RangeF64::Add(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var)));
-	}
-
-	return res;
+		return RangeF64::Add(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var));
+	}));
 }
 
 /**
@@ -184,19 +352,14 @@ Fact Fact::AddF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
  *   &returns: The result fact.
  */
 Fact Fact::SubF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
-	Fact res(Op::SubF64, std::vector<Fact *>{ &lhs, &rhs, }, Fact::Cross(lhs.vars, rhs.vars));
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = lhs.Map(res.vars, i);
-		Range &y = rhs.Map(res.vars, i);
+	Bdd &bdd = *lhs.bdd;
 
+	return Fact(Op::SubF64, std::vector<Fact *>{ &lhs, &rhs, }, bdd, bdd.Apply(lhs.root, rhs.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeF64>(x.var) || !std::holds_alternative<RangeF64>(y.var))
 			fatal("SubF64 must be applied to RangeF64.");
 
-		res.ranges.push_back(RangeF64::Sub(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var)));
-	}
-
-	return res;
+		return RangeF64::Sub(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var));
+	}));
 }
 
 /**
@@ -207,19 +370,14 @@ Fact Fact::SubF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
  *   &returns: The result fact.
  */
 Fact Fact::MulF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
-	Fact res(Op::MulF64, std::vector<Fact *>{ &lhs, &rhs, }, Fact::Cross(lhs.vars, rhs.vars));
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = lhs.Map(res.vars, i);
-		Range &y = rhs.Map(res.vars, i);
+	Bdd &bdd = *lhs.bdd;
 
+	return Fact(Op::MulF64, std::vector<Fact *>{ &lhs, &rhs, }, bdd, bdd.Apply(lhs.root, rhs.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeF64>(x.var) || !std::holds_alternative<RangeF64>(y.var))
 			fatal("MulF64 must be applied to RangeF64.");
 
-		res.ranges.push_back(RangeF64::Mul(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var)));
-	}
-
-	return res;
+		return RangeF64::Mul(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var));
+	}));
 }
 
 /**
@@ -230,30 +388,10 @@ Fact Fact::MulF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
  *   &returns: The fact.
  */
 Fact Fact::CmpOltF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
-	Fact res(Op::CmpOltF64, std::vector<Fact *>{ &lhs, &rhs }, var);
-
-	res.ranges.push_back(Range(RangeBool::Const(false)));
-	res.ranges.push_back(Range(RangeBool::Const(true)));
-
-	unsigned int len;
-	double rlo = rhs.LowerF64(), rhi = rhs.UpperF64();
-	double llo = lhs.LowerF64(), lhi = lhs.UpperF64();
+	Bdd &bdd = *lhs.bdd;
+	Fact res(Op::CmpOltF64, std::vector<Fact *>{ &lhs, &rhs }, bdd, bdd.Branch(var, bdd.Get(RangeBool::Const(true)), bdd.Get(RangeBool::Const(false))));
 
-	lhs.vars.push_back(var);
-	len = lhs.ranges.size();
-	for(unsigned int i = 0; i < len; i++) {
-		lhs.ranges.push_back(lhs.ranges[i].BelowF64(rhi, false));
-		lhs.ranges[i] = lhs.ranges[i].AboveF64(Fact::Next64(rlo), true);
-	}
-	lhs.InvProp();
-
-	rhs.vars.push_back(var);
-	len = rhs.ranges.size();
-	for(unsigned int i = 0; i < len; i++) {
-		rhs.ranges.push_back(rhs.ranges[i].AboveF64(Fact::Prev64(llo), true));
-		rhs.ranges[i] = rhs.ranges[i].BelowF64(lhi, false);
-	}
-	rhs.InvProp();
+	res.InvProp();
 
 	return res;
 }
@@ -266,30 +404,10 @@ Fact Fact::CmpOltF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
  *   &returns: The fact.
  */
 Fact Fact::CmpOgtF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
-	Fact res(Op::CmpOltF64, std::vector<Fact *>{ &lhs, &rhs }, var);
-
-	res.ranges.push_back(Range(RangeBool::Const(false)));
-	res.ranges.push_back(Range(RangeBool::Const(true)));
+	Bdd &bdd = *lhs.bdd;
+	Fact res(Op::CmpOgtF64, std::vector<Fact *>{ &lhs, &rhs }, bdd, bdd.Branch(var, bdd.Get(RangeBool::Const(true)), bdd.Get(RangeBool::Const(false))));
 
-	unsigned int len;
-	double rlo = rhs.LowerF64(), rhi = rhs.UpperF64();
-	double llo = lhs.LowerF64(), lhi = lhs.UpperF64();
-
-	lhs.vars.push_back(var);
-	len = lhs.ranges.size();
-	for(unsigned int i = 0; i < len; i++) {
-		lhs.ranges.push_back(lhs.ranges[i].AboveF64(rhi, false));
-		lhs.ranges[i] = lhs.ranges[i].BelowF64(Fact::Prev64(rlo), true);
-	}
-	lhs.InvProp();
-
-	rhs.vars.push_back(var);
-	len = rhs.ranges.size();
-	for(unsigned int i = 0; i < len; i++) {
-		rhs.ranges.push_back(rhs.ranges[i].BelowF64(Fact::Next64(llo), true));
-		rhs.ranges[i] = rhs.ranges[i].AboveF64(lhi, false);
-	}
-	rhs.InvProp();
+	res.InvProp();
 
 	return res;
 }
@@ -302,19 +420,14 @@ Fact Fact::CmpOgtF64(Fact &lhs, Fact &rhs, const llvm::Value *var) {
  */
 Fact Fact::CopySignF64(Fact &mag, Fact &sign)
 {
-	Fact res(Op::CopySignF64, std::vector<Fact *>{ &mag, &sign }, Fact::Cross(mag.vars, sign.vars));
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = mag.Map(res.vars, i);
-		Range &y = sign.Map(res.vars, i);
+	Bdd &bdd = *mag.bdd;
 
+	return Fact(Op::CopySignF64, std::vector<Fact *>{ &mag, &sign }, bdd, bdd.Apply(mag.root, sign.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeF64>(x.var) || !std::holds_alternative<RangeF64>(y.var))
 			fatal("CopySignF64 must be applied to RangeF64.");
 
-		res.ranges.push_back(RangeF64::CopySign(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var)));
-	}
-
-	return res;
+		return RangeF64::CopySign(std::get<RangeF64>(x.var), std::get<RangeF64>(y.var));
+	}));
 }
 
 /**
@@ -324,19 +437,14 @@ Fact Fact::CopySignF64(Fact &mag, Fact &sign)
  *   &returns: The fact.
  */
 Fact Fact::AndI64(Fact &lhs, Fact &rhs) {
-	Fact res(Op::AndI64, std::vector<Fact *>{ &lhs, &rhs }, Fact::Cross(lhs.vars, rhs.vars));
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = lhs.Map(res.vars, i);
-		Range &y = rhs.Map(res.vars, i);
+	Bdd &bdd = *lhs.bdd;
 
+	return Fact(Op::AndI64, std::vector<Fact *>{ &lhs, &rhs }, bdd, bdd.Apply(lhs.root, rhs.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeI64>(x.var) || !std::holds_alternative<RangeI64>(y.var))
 			fatal("AndI64 must be applied to RangeI64.");
 
-		res.ranges.push_back(RangeI64::And(std::get<RangeI64>(x.var), std::get<RangeI64>(y.var)));
-	}
-
-	return res;
+		return RangeI64::And(std::get<RangeI64>(x.var), std::get<RangeI64>(y.var));
+	}));
 }
 
 /**
@@ -346,52 +454,37 @@ Fact Fact::AndI64(Fact &lhs, Fact &rhs) {
  *   &returns: The fact.
  */
 Fact Fact::XorI64(Fact &lhs, Fact &rhs) {
-	Fact res(Op::XorI64, std::vector<Fact *>{ &lhs, &rhs });
-
-	res.vars = Fact::Cross(lhs.vars, rhs.vars);
-
-	for(uint64_t i = 0; i < res.Limit(); i++) {
-		Range &x = lhs.Map(res.vars, i);
-		Range &y = rhs.Map(res.vars, i);
+	Bdd &bdd = *lhs.bdd;
 
+	return Fact(Op::XorI64, std::vector<Fact *>{ &lhs, &rhs }, bdd, bdd.Apply(lhs.root, rhs.root, [](Range const &x, Range const &y) -> Range {
 		if(!std::holds_alternative<RangeI64>(x.var) || !std::holds_alternative<RangeI64>(y.var))
 			fatal("XorI64 must be applied to RangeI64.");
 
-		res.ranges.push_back(RangeI64::Xor(std::get<RangeI64>(x.var), std::get<RangeI64>(y.var)));
-	}
-
-	return res;
+		return RangeI64::Xor(std::get<RangeI64>(x.var), std::get<RangeI64>(y.var));
+	}));
 }
 
 /**
- * Compute a 64-bit float select.
+ * Compute a 64-bit float select. Along each path, the result is the choice
+ * the condition allows, or the union of both if it may go either way.
  *   @cond: The conditional fact.
  *   @ontrue: The on true fact.
  *   @onfalse: The on false fact.
  *   &returns: The selected fact.
  */
 Fact Fact::SelectI64(Fact &cond, Fact &ontrue, Fact &onfalse) {
-	Fact res(Op::SelectI64, std::vector<Fact *>{ &cond });
-	res.vars = cond.vars;
+	Bdd &bdd = *cond.bdd;
 
-	for(auto const &range : cond.ranges) {
-		if(!std::holds_alternative<RangeBool>(range.var))
+	return Fact(Op::SelectI64, std::vector<Fact *>{ &cond, &ontrue, &onfalse }, bdd, bdd.Select(cond.root, ontrue.root, onfalse.root, [](Range const &c, Range const &t, Range const &f) -> Range {
+		if(c.IsNone())
+			return Range();
+		else if(!std::holds_alternative<RangeBool>(c.var))
 			fatal("SelectI64 must be applied to RangeBool.");
 
-		RangeBool const &get = std::get<RangeBool>(range.var);
-
-		if(get.istrue) {
-			for(auto const &iter : ontrue.ranges)
-				res.ranges.push_back(iter);
-		}
-		
-		if(get.isfalse) {
-			for(auto const &iter : onfalse.ranges)
-				res.ranges.push_back(iter);
-		}
-	}
+		RangeBool const &get = std::get<RangeBool>(c.var);
 
-	return res;
+		return Range::Union(get.istrue ? t : Range(), get.isfalse ? f : Range());
+	}));
 }
 
 /**
@@ -400,16 +493,14 @@ Fact Fact::SelectI64(Fact &cond, Fact &ontrue, Fact &onfalse) {
  *   &returns: The output fact.
  */
 Fact Fact::CastF64toI64(Fact &in) {
-	Fact res(Op::CastF64toI64, std::vector<Fact *>{ &in }, in.vars);
+	Bdd &bdd = *in.bdd;
 
-	for(auto const &range : in.ranges) {
+	return Fact(Op::CastF64toI64, std::vector<Fact *>{ &in }, bdd, bdd.Map(in.root, [](Range const &range) -> Range {
 		if(!std::holds_alternative<RangeF64>(range.var))
 			fatal("CastF64toI64 must be applied to RangeF64.");
 
-		res.ranges.push_back(RangeI64::CastF64(std::get<RangeF64>(range.var)));
-	}
-
-	return res;
+		return RangeI64::CastF64(std::get<RangeF64>(range.var));
+	}));
 }
 
 /**
@@ -418,32 +509,12 @@ Fact Fact::CastF64toI64(Fact &in) {
  *   &returns: The output fact.
  */
 Fact Fact::CastI64toF64(Fact &in) {
-	Fact res(Op::CastI64toF64, std::vector<Fact *>{ &in }, in.vars);
+	Bdd &bdd = *in.bdd;
 
-	for(auto const &range : in.ranges) {
+	return Fact(Op::CastI64toF64, std::vector<Fact *>{ &in }, bdd, bdd.Map(in.root, [](Range const &range) -> Range {
 		if(!std::holds_alternative<RangeI64>(range.var))
 			fatal("CastI64toF64 must be applied to RangeI64.");
 
-		res.ranges.push_back(RangeF64::FromI64(std::get<RangeI64>(range.var)));
-	}
-
-	return res;
-}
-
-
-/**
- * Compute the cross-product of variables.
- *   @lhs: The left vector.
- *   @rhs: The right vector.
- *   &returns: The summed vector.
- */
-std::vector<const llvm::Value *> Fact::Cross(std::vector<const llvm::Value *> const &lhs, std::vector<const llvm::Value *> const &rhs) {
-	std::vector<const llvm::Value *> res(lhs);
-
-	for(auto const &var : rhs) {
-		if(std::find(lhs.begin(), lhs.end(), var) == lhs.end())
-			res.push_back(var);
-	}
-
-	return res;
+		return RangeF64::FromI64(std::get<RangeI64>(range.var));
+	}));
 }
@@ -27,14 +27,18 @@ enum class Op {
  */
 class Pass {
 public:
+	Bdd bdd;
 	std::map<const llvm::Value *, Fact> map;
 
 	Pass() { }
+	Pass(uint32_t cap) : bdd(cap) { }
 	~Pass() { }
 
 	void Run(const llvm::Function &func, std::vector<Range> const &args);
+	void Revise(const llvm::Function &func);
 	void Inst(const llvm::Instruction &inst);
 	void Dump(const llvm::Function &func) const;
+	std::string Str(const llvm::Function &func) const;
 
 	Fact& Get(llvm::Value *value);
 	std::pair<Op, std::vector<Fact *>> Info(const llvm::Instruction &inst);
@@ -42,32 +46,28 @@ public:
 
 /*
  * fact class
+ *   The ranges of a value under each outcome of the comparisons it depends
+ *   on, as a decision diagram over the comparisons.
  */
 class Fact {
 public:
 	Op op;
 	std::vector<Fact *> args;
 
-	std::vector<const llvm::Value *> vars;
-	std::vector<Range> ranges;
+	Bdd *bdd;
+	const BddNode *root;
 
-	Fact() { op = Op::None; ranges.push_back(Range(RangeNone())); }
-	Fact(Op _op, std::vector<Fact *> _args) { op = _op; args = _args; }
-	Fact(Op _op, std::vector<Fact *> _args, const llvm::Value *_var) { op = _op; args = _args; vars = std::vector<const llvm::Value *>{ _var }; }
-	Fact(Op _op, std::vector<Fact *> _args, std::vector<const llvm::Value *> const &_vars) { op = _op; args = _args; vars = _vars; }
-	Fact(Op _op, std::vector<Fact *> _args, Range _range) { op = _op; args = _args; ranges.push_back(_range); }
-	Fact(Op _op, std::vector<Fact *> _args, RangeBool _range) { op = _op; args = _args; ranges.push_back(Range(_range)); }
-	Fact(Op _op, std::vector<Fact *> _args, RangeF64 _range) { op = _op; args = _args; ranges.push_back(Range(_range)); }
-	Fact(Op _op, std::vector<Fact *> _args, RangeI64 _range) { op = _op; args = _args; ranges.push_back(Range(_range)); }
+	Fact() { op = Op::None; bdd = nullptr; root = nullptr; }
+	Fact(Op _op, std::vector<Fact *> _args, Bdd &_bdd, const BddNode *_root) { op = _op; args = _args; bdd = &_bdd; root = _bdd.Limit(_root); }
+	Fact(Op _op, std::vector<Fact *> _args, Bdd &_bdd, Range const &_range) { op = _op; args = _args; bdd = &_bdd; root = _bdd.Get(_range); }
 	~Fact() { }
 
 	void InvProp();
+	bool Eval();
+	void Narrow(Fact &arg, std::vector<const BddNode *> const &in, std::function<Range(std::vector<const Range *> const &)> const &func);
 	double LowerF64() const;
 	double UpperF64() const;
-
-	uint64_t Limit() const;
-	int32_t Index(const llvm::Value *var) const;
-	Range &Map(const std::vector<const llvm::Value *> &vars, uint64_t idx);
+	Range Join() const;
 
 	std::string Str() const;
 	void Dump() const;
@@ -85,8 +85,6 @@ public:
 	static Fact CastF64toI64(Fact &in);
 	static Fact CastI64toF64(Fact &in);
 
-	static std::vector<const llvm::Value *> Cross(std::vector<const llvm::Value *> const &lhs, std::vector<const llvm::Value *> const &rhs);
-
 	static double Next64(double val) { return std::nextafter(val, INFINITY); }
 	static double Prev64(double val) { return std::nextafter(val, -INFINITY); }
 };
@@ -5,14 +5,19 @@
  * common headers
  */
 #include <assert.h>
+#include <emmintrin.h>
 #include <float.h>
 #include <math.h>
 #include <stdint.h>
 #include <string.h>
 
 #include <algorithm>
+#include <deque>
+#include <functional>
 #include <map>
+#include <set>
 #include <string>
+#include <tuple>
 #include <variant>
 #include <vector>
 
@@ -30,6 +35,7 @@ namespace llvm {
  */
 #include "ival.hpp"
 #include "range.hpp"
+#include "bdd.hpp"
 #include "fact.hpp"
 
 
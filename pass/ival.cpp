@@ -75,40 +75,61 @@ bool IvalF64::HasNeg() const {
 
 
 /**
- * Compute an addition of intervals.
+ * Compute an addition of intervals, rounding outward.
  *   @lhs: The left-hand interval.
  *   @rhs: The right-hand interval.
  *   &returns: The result interval.
  */
 IvalF64 IvalF64::Add(IvalF64 const &lhs, IvalF64 const &rhs) {
-	return IvalF64(lhs.lo + rhs.lo, lhs.hi + rhs.hi);
+	IvalF64 res;
+
+	f64iadd(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &res.lo, &res.hi);
+
+	return res;
 }
 
 /**
- * Compute a subraction of intervals.
+ * Compute a subraction of intervals, rounding outward.
  *   @lhs: The left-hand interval.
  *   @rhs: The right-hand interval.
  *   &returns: The result interval.
  */
 IvalF64 IvalF64::Sub(IvalF64 const &lhs, IvalF64 const &rhs) {
-	return IvalF64(lhs.lo - rhs.lo, lhs.hi - rhs.hi);
+	IvalF64 res;
+
+	f64isub(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &res.lo, &res.hi);
+
+	return res;
 }
 
 /**
- * Compute a multiply of intervals.
+ * Compute a multiply of intervals, rounding outward.
  *   @lhs: The left-hand interval.
  *   @rhs: The right-hand interval.
  *   &returns: The result interval.
  */
 IvalF64 IvalF64::Mul(IvalF64 const &lhs, IvalF64 const &rhs) {
-	double a, b, c, d;
+	IvalF64 res;
+
+	f64imul(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &res.lo, &res.hi);
+
+	return res;
+}
+
+
+/**
+ * Compute a division of intervals, rounding outward. The divisor must be
+ * finite and exclude zero.
+ *   @lhs: The left-hand interval.
+ *   @rhs: The right-hand interval.
+ *   &returns: The result interval.
+ */
+IvalF64 IvalF64::Div(IvalF64 const &lhs, IvalF64 const &rhs) {
+	IvalF64 res;
 
-	a = lhs.lo * rhs.lo;
-	b = lhs.lo * rhs.hi;
-	c = lhs.hi * rhs.lo;
-	d = lhs.hi * rhs.hi;
+	f64idiv(lhs.lo, lhs.hi, rhs.lo, rhs.hi, &res.lo, &res.hi);
 
-	return IvalF64(f64min(f64min(a, b), f64min(c, d)), f64max(f64max(a, b), f64max(c, d)));
+	return res;
 }
 
 
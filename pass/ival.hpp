@@ -71,6 +71,137 @@ static inline double f64max(double a, double b) {
 		return f64gte(a, b) ? a : b;
 }
 
+/*
+ * rounding class
+ *   Switches SSE arithmetic to round upward, with subnormals enabled, for
+ *   the lifetime of the object. The interval kernels carry an interval as
+ *   the pair `-lo, hi`, so that one upward rounding mode rounds both bounds
+ *   outward. Nested instances find the mode already set and leave it alone,
+ *   so a loop can hold one around many interval operations.
+ */
+class FpRound {
+public:
+	FpRound() { csr = _mm_getcsr(); if(csr != Up(csr)) _mm_setcsr(Up(csr)); }
+	~FpRound() { if(csr != Up(csr)) _mm_setcsr(csr); }
+
+	FpRound(FpRound const&) = delete;
+	FpRound& operator=(FpRound const&) = delete;
+
+private:
+	unsigned int csr;
+
+	static unsigned int Up(unsigned int csr) { return (csr & ~0xE040) | 0x4000; }
+};
+
+/**
+ * Pin a vector in a register, so that the arithmetic producing or using it
+ * is not moved across a change of the rounding mode.
+ *   @v: The vector.
+ */
+static inline void f64pin(__m128d &v) { __asm__ volatile("" : "+x"(v)); }
+
+/**
+ * Replace NaN lanes with zero. Products of a zero and an infinite bound are
+ * taken as zero, their limit over the interval.
+ *   @v: The vector.
+ *   &returns: The vector without NaNs.
+ */
+static inline __m128d f64num(__m128d v) { return _mm_andnot_pd(_mm_cmpunord_pd(v, v), v); }
+
+/**
+ * Add two intervals, rounding outward.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+static inline void f64iadd(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	f64pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	f64pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Subtract two intervals, rounding outward. The lower bound is `alo - bhi`
+ * and the upper bound `ahi - blo`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+static inline void f64isub(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(-blo, bhi);
+
+	f64pin(l);
+	__m128d res = _mm_add_pd(l, r);
+	f64pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Multiply two intervals, rounding outward. The four cross products are
+ * computed with each sign, the negated ones bounding `-lo` and the others
+ * bounding `hi`.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+static inline void f64imul(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, -alo), r = _mm_set_pd(bhi, -blo);
+
+	f64pin(l);
+	__m128d nl = _mm_xor_pd(l, _mm_set1_pd(-0.0)), sr = _mm_shuffle_pd(r, r, 1);
+	__m128d up = _mm_max_pd(f64num(_mm_mul_pd(l, r)), f64num(_mm_mul_pd(nl, sr)));
+	__m128d dn = _mm_max_pd(f64num(_mm_mul_pd(nl, r)), f64num(_mm_mul_pd(l, sr)));
+	__m128d res = _mm_max_pd(_mm_unpacklo_pd(dn, up), _mm_unpackhi_pd(dn, up));
+	f64pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
+/**
+ * Divide two intervals, rounding outward. The divisor must be finite and
+ * exclude zero, so the bounds are among the four corner quotients.
+ *   @alo: The lower bound of the left-hand side.
+ *   @ahi: The upper bound of the left-hand side.
+ *   @blo: The lower bound of the right-hand side.
+ *   @bhi: The upper bound of the right-hand side.
+ *   @lo: Output. The lower bound.
+ *   @hi: Output. The upper bound.
+ */
+static inline void f64idiv(double alo, double ahi, double blo, double bhi, double *lo, double *hi) {
+	FpRound round;
+	__m128d l = _mm_set_pd(ahi, alo), r0 = _mm_set1_pd(blo), r1 = _mm_set1_pd(bhi);
+
+	f64pin(l);
+	__m128d nl = _mm_xor_pd(l, _mm_set1_pd(-0.0));
+	__m128d up = _mm_max_pd(_mm_div_pd(l, r0), _mm_div_pd(l, r1));
+	__m128d dn = _mm_max_pd(_mm_div_pd(nl, r0), _mm_div_pd(nl, r1));
+	__m128d res = _mm_max_pd(_mm_unpacklo_pd(dn, up), _mm_unpackhi_pd(dn, up));
+	f64pin(res);
+
+	*lo = -_mm_cvtsd_f64(res);
+	*hi = _mm_cvtsd_f64(_mm_unpackhi_pd(res, res));
+}
+
 /*
  * class prototypes
  */
@@ -123,6 +254,7 @@ public:
 	~IvalF64() { }
 
 	IvalF64 Neg() const { return IvalF64(-hi, -lo); }
+	IvalF64 Unsigned() const { return IvalF64((lo == 0.0) ? -0.0 : lo, (hi == 0.0) ? 0.0 : hi); }
 	bool IsZero() const { return (lo == 0.0) && (hi == 0.0); }
 	bool IsInf() const { return ((lo == INFINITY) && (hi == INFINITY)) || ((lo == -INFINITY) && (hi == -INFINITY)); }
 	bool IsPos() const { return !signbit(lo); }
@@ -140,6 +272,7 @@ public:
 	static IvalF64 Add(IvalF64 const &lhs, IvalF64 const &rhs);
 	static IvalF64 Sub(IvalF64 const &lhs, IvalF64 const &rhs);
 	static IvalF64 Mul(IvalF64 const &lhs, IvalF64 const &rhs);
+	static IvalF64 Div(IvalF64 const &lhs, IvalF64 const &rhs);
 
 	static std::string StrVal(double val);
 
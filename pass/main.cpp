@@ -1,78 +1,505 @@
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdlib.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 #include "inc.hpp"
 
 
+/*
+ * prove job structure
+ *   @path: The module path.
+ *   @name: The function name, or `#index` if unnamed.
+ *   @index: The position of the function in its module.
+ *   @status: The verdict, `free`, `subnormal`, `unsupported` or `error`.
+ *   @json: The report object of the function.
+ *   @dump: The facts of the function, if requested.
+ */
+struct prove_job {
+	std::string path, name;
+	size_t index;
+	std::string status, json, dump;
+};
+
+/*
+ * spec file
+ *   One line per function, `name range...`, giving the ranges of its float
+ *   arguments in order, with `*` naming the default for all functions. A
+ *   range is a comma-separated list of `normal`, `all`, `nan`, a value, or
+ *   `lo:hi`. Missing ranges are `normal`, and `#` starts a comment line.
+ */
+typedef std::map<std::string, std::vector<RangeF64>> prove_spec;
+
+
 /*
  * local declarations
  */
-static llvm::LLVMContext llvm_ctx;
+static std::unique_ptr<llvm::Module> llvm_load(const char *path, llvm::LLVMContext &ctx, std::string &err);
+
+static prove_spec spec_load(const char *path);
+static RangeF64 spec_range(std::string const &str);
+static std::vector<Range> spec_args(prove_spec const &spec, const llvm::Function &func);
 
-static std::unique_ptr<llvm::Module> llvm_load(const char *path);
+static bool prove_check(const llvm::Function &func, std::string &err);
+static void prove_func(prove_job &job, llvm::Function &func, prove_spec const &spec, uint32_t cap, bool dump);
+static void prove_error(prove_job &job, std::string const &err);
+static std::string json_str(std::string const &str);
 
 
 /**
- * Main entry function.
+ * Main entry function. Analyses every function of the given `.ll` or `.bc`
+ * modules on a pool of `-j` workers (all cores by default), each with its
+ * own LLVM context, and writes a JSON report to `-o` (standard out by
+ * default). Argument ranges come from the `-s` spec file, `-v` caps the
+ * number of comparisons a fact distinguishes, and `-d` dumps the facts of
+ * every function to standard error. A module that cannot be loaded is
+ * reported as an `error` entry and the others are still analysed.
  *   @argc: The number of arguments.
  *   @argv: The argument array.
- *   &returns: The code.
+ *   &returns: The code, nonzero if a function may produce a subnormal or a
+ *     module cannot be loaded.
  */
 int main(int argc, char **argv)
 {
+	uint32_t cap = 12;
+	unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+	const char *out = NULL, *spec_path = NULL;
+	bool dump = false;
+	int opt;
+
 	setbuf(stdout, NULL);
 	setbuf(stderr, NULL);
 
-	//printf("%s\n", IvalF64::Mul(IvalF64(-0, -INFINITY), IvalF64(-1, -DBL_MIN)).Str().c_str());
-	//printf("max: %e\n", f64min(-1, -INFINITY));
-	//return 0;
+	while((opt = getopt(argc, argv, "v:j:s:o:d")) != -1) {
+		switch(opt) {
+		case 'v': cap = atoi(optarg); break;
+		case 'j': nthreads = std::max(1, atoi(optarg)); break;
+		case 's': spec_path = optarg; break;
+		case 'o': out = optarg; break;
+		case 'd': dump = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-v vars] [-j threads] [-s spec] [-o report.json] [-d] module...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	prove_spec spec;
+	if(spec_path != NULL)
+		spec = spec_load(spec_path);
+
+	std::vector<prove_job> jobs;
 
-	std::unique_ptr<llvm::Module> mod = llvm_load("test2.ll");
-	for(auto func = mod->begin(); func != mod->end(); func++) {
-		int idx = 0;
+	for(int i = optind; i < argc; i++) {
+		llvm::LLVMContext ctx;
+		std::string err;
+		std::unique_ptr<llvm::Module> mod = llvm_load(argv[i], ctx, err);
 
-		if(func->size() != 1)
+		if(mod == nullptr) {
+			fprintf(stderr, "%s\n", err.c_str());
+
+			prove_job job;
+			job.path = argv[i];
+			job.index = 0;
+			prove_error(job, err);
+			jobs.push_back(job);
 			continue;
+		}
 
-		for(auto &block : *func) {
-			for(auto &inst : block) {
-				if(!inst.hasName())
-					inst.setName("v" + std::to_string(idx++));
+		size_t index = 0;
+		for(auto const &func : *mod) {
+			if(!func.isDeclaration()) {
+				prove_job job;
+				job.path = argv[i];
+				job.name = func.hasName() ? func.getName().str() : ("#" + std::to_string(index));
+				job.index = index;
+				jobs.push_back(job);
 			}
+
+			index++;
 		}
+	}
 
-		Pass pass;
-		pass.Run(*func, std::vector<Range>{ Range(RangeF64::Normal()), Range(RangeF64::Normal()) });
-		pass.Dump(*func);
+	/* jobs of a module are adjacent, so workers mostly reuse their copy */
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> pool;
+
+	for(unsigned int i = 0; i < std::min<size_t>(nthreads, jobs.size()); i++) {
+		pool.push_back(std::thread([&]() {
+			llvm::LLVMContext ctx;
+			std::map<std::string, std::unique_ptr<llvm::Module>> mods;
+			std::map<std::string, std::vector<llvm::Function *>> funcs;
+
+			for(size_t n = next++; n < jobs.size(); n = next++) {
+				prove_job &job = jobs[n];
+				std::string err;
+
+				if(!job.status.empty())
+					continue;
+
+				if(mods.count(job.path) == 0) {
+					mods[job.path] = llvm_load(job.path.c_str(), ctx, err);
+
+					if(mods[job.path] != nullptr) {
+						for(auto &func : *mods[job.path])
+							funcs[job.path].push_back(&func);
+					}
+				}
+
+				if(mods[job.path] == nullptr)
+					prove_error(job, err.empty() ? "Cannot load module." : err);
+				else if(job.index >= funcs[job.path].size())
+					prove_error(job, "Function not found.");
+				else
+					prove_func(job, *funcs[job.path][job.index], spec, cap, dump);
+			}
+		}));
+	}
 
-		break;
+	for(auto &thread : pool)
+		thread.join();
+
+	std::map<std::string, unsigned int> count;
+	std::string json = "{\n\t\"functions\": [";
+
+	for(size_t i = 0; i < jobs.size(); i++) {
+		json += std::string((i > 0) ? "," : "") + "\n\t\t" + jobs[i].json;
+		count[jobs[i].status]++;
+
+		if(dump && (jobs[i].status != "error"))
+			fprintf(stderr, "; %s: %s\n%s", jobs[i].path.c_str(), jobs[i].name.c_str(), jobs[i].dump.c_str());
 	}
 
-	return 0;
+	json += "\n\t],\n\t\"summary\": { \"functions\": " + std::to_string(jobs.size());
+	for(auto status : { "free", "subnormal", "unsupported", "error" })
+		json += std::string(", \"") + status + "\": " + std::to_string(count[status]);
+	json += " }\n}\n";
+
+	FILE *file = (out != NULL) ? fopen(out, "w") : stdout;
+	if(file == NULL)
+		fatal("Cannot write '%s'.", out);
+
+	fputs(json.c_str(), file);
+	if(file != stdout)
+		fclose(file);
+
+	fprintf(stderr, "%zu functions, %u free, %u subnormal, %u unsupported, %u errors\n", jobs.size(), count["free"], count["subnormal"], count["unsupported"], count["error"]);
+
+	return ((count["subnormal"] > 0) || (count["error"] > 0)) ? 1 : 0;
 }
 
 
 /**
  * Load a module from a path.
  *   @path: The path.
- *   &returns: The module.
+ *   @ctx: The context.
+ *   @err: Output. The reason on failure.
+ *   &returns: The module, or null on failure.
  */
-static std::unique_ptr<llvm::Module> llvm_load(const char *path)
+static std::unique_ptr<llvm::Module> llvm_load(const char *path, llvm::LLVMContext &ctx, std::string &err)
 {
-	llvm::SMDiagnostic err;
+	llvm::SMDiagnostic diag;
 	std::unique_ptr<llvm::Module> mod;
 
-	mod = parseIRFile(path, err, llvm_ctx);
-	if(mod == nullptr) {
-		llvm::raw_fd_ostream stream(STDERR_FILENO, false);
-		err.print("llvm", stream);
-		fatal("Cannot open '%s'. %s", path, err.getMessage().data());
-	}
+	mod = parseIRFile(path, diag, ctx);
+	if(mod == nullptr)
+		err = std::string("Cannot open '") + path + "'. " + diag.getMessage().str();
 
 	return mod;
 }
 
+
+/**
+ * Load a spec file.
+ *   @path: The path.
+ *   &returns: The argument ranges of each function.
+ */
+static prove_spec spec_load(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	if(file == NULL)
+		fatal("Cannot open '%s'.", path);
+
+	prove_spec spec;
+	char line[4096];
+
+	while(fgets(line, sizeof(line), file) != NULL) {
+		std::vector<std::string> toks;
+
+		for(char *tok = strtok(line, " \t\r\n"); tok != NULL; tok = strtok(NULL, " \t\r\n"))
+			toks.push_back(tok);
+
+		if(toks.empty() || (toks[0][0] == '#'))
+			continue;
+
+		std::vector<RangeF64> &args = spec[toks[0]];
+		for(size_t i = 1; i < toks.size(); i++)
+			args.push_back(spec_range(toks[i]));
+	}
+
+	fclose(file);
+
+	return spec;
+}
+
+/**
+ * Parse a range of a spec file.
+ *   @str: The string.
+ *   &returns: The range.
+ */
+static RangeF64 spec_range(std::string const &str)
+{
+	RangeF64 res(false);
+	size_t pos = 0;
+
+	while(pos <= str.size()) {
+		size_t end = str.find(',', pos);
+		std::string part = str.substr(pos, (end == std::string::npos) ? std::string::npos : (end - pos));
+
+		if(part == "normal")
+			res = Range::Union(res, RangeF64::Normal()).GetF64();
+		else if(part == "all")
+			res = Range::Union(res, RangeF64::All()).GetF64();
+		else if(part == "nan")
+			res.nan = true;
+		else {
+			const char *ptr = part.c_str();
+			char *rest;
+			double lo, hi;
+
+			lo = hi = strtod(ptr, &rest);
+			if((rest != ptr) && (*rest == ':'))
+				hi = strtod(ptr = rest + 1, &rest);
+
+			if((rest == ptr) || (*rest != '\0') || !f64lte(lo, hi))
+				fatal("Invalid range '%s'.", part.c_str());
+
+			res = Range::Union(res, RangeF64(false, IvalF64(lo, hi))).GetF64();
+		}
+
+		if(end == std::string::npos)
+			break;
+
+		pos = end + 1;
+	}
+
+	return res;
+}
+
+/**
+ * Retrieve the argument ranges of a function from the spec.
+ *   @spec: The spec.
+ *   @func: The function.
+ *   &returns: The ranges.
+ */
+static std::vector<Range> spec_args(prove_spec const &spec, const llvm::Function &func)
+{
+	static const std::vector<RangeF64> none;
+	auto find = spec.find(func.getName().str());
+
+	if(find == spec.end())
+		find = spec.find("*");
+
+	std::vector<RangeF64> const &list = (find != spec.end()) ? find->second : none;
+	std::vector<Range> res;
+	unsigned int i = 0;
+
+	for(auto const &arg : func.args()) {
+		if(!arg.getType()->isDoubleTy())
+			res.push_back(RangeI64::All());
+		else if(i < list.size())
+			res.push_back(list[i++]);
+		else
+			res.push_back(RangeF64::Normal()), i++;
+	}
+
+	return res;
+}
+
+
+/**
+ * Check that the pass handles every argument and instruction of a
+ * function, as it stops on anything else.
+ *   @func: The function.
+ *   @err: Output. The reason on failure.
+ *   &returns: True if handled.
+ */
+static bool prove_check(const llvm::Function &func, std::string &err)
+{
+	static const std::set<std::string> calls = { "llvm.fabs.f64", "llvm.copysign.f64" };
+
+	if(func.size() != 1) {
+		err = "Function has more than one basic block.";
+		return false;
+	}
+
+	for(auto const &arg : func.args()) {
+		if(!arg.getType()->isDoubleTy() && !arg.getType()->isIntegerTy(64)) {
+			err = "Unhandled argument type.";
+			return false;
+		}
+	}
+
+	for(auto const &inst : func.front()) {
+		bool okay;
+
+		switch(inst.getOpcode()) {
+		case llvm::Instruction::FAdd:
+		case llvm::Instruction::FSub:
+		case llvm::Instruction::FMul:
+			okay = inst.getType()->isDoubleTy();
+			break;
+
+		case llvm::Instruction::And:
+		case llvm::Instruction::Xor:
+		case llvm::Instruction::Select:
+			okay = inst.getType()->isIntegerTy(64);
+			break;
+
+		case llvm::Instruction::BitCast:
+			okay = (inst.getType()->isDoubleTy() && inst.getOperand(0)->getType()->isIntegerTy(64)) || (inst.getType()->isIntegerTy(64) && inst.getOperand(0)->getType()->isDoubleTy());
+			break;
+
+		case llvm::Instruction::FCmp:
+			okay = inst.getOperand(0)->getType()->isDoubleTy() && ((llvm::cast<llvm::FCmpInst>(inst).getPredicate() == llvm::CmpInst::FCMP_OLT) || (llvm::cast<llvm::FCmpInst>(inst).getPredicate() == llvm::CmpInst::FCMP_OGT));
+			break;
+
+		case llvm::Instruction::Call:
+			okay = (llvm::cast<llvm::CallInst>(inst).getCalledFunction() != nullptr) && (calls.count(llvm::cast<llvm::CallInst>(inst).getCalledFunction()->getName().str()) > 0);
+			break;
+
+		case llvm::Instruction::Ret:
+			okay = true;
+			break;
+
+		default:
+			okay = false;
+		}
+
+		for(unsigned int i = 0; okay && (i < inst.getNumOperands()); i++) {
+			const llvm::Value *val = inst.getOperand(i);
+
+			if(llvm::isa<llvm::ConstantFP>(val))
+				okay = val->getType()->isDoubleTy();
+			else if(llvm::isa<llvm::ConstantInt>(val))
+				okay = val->getType()->isIntegerTy(64);
+			else
+				okay = llvm::isa<llvm::Argument>(val) || llvm::isa<llvm::Instruction>(val) || llvm::isa<llvm::Function>(val);
+		}
+
+		if(!okay) {
+			err = std::string("Unhandled instruction '") + inst.getOpcodeName() + "'.";
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Analyse a function, filling in the verdict and report of its job. The
+ * function is free of subnormals if no float instruction may produce one.
+ *   @job: The job.
+ *   @func: The function.
+ *   @spec: The spec.
+ *   @cap: The variable cap.
+ *   @dump: Dump the facts.
+ */
+static void prove_func(prove_job &job, llvm::Function &func, prove_spec const &spec, uint32_t cap, bool dump)
+{
+	auto start = std::chrono::steady_clock::now();
+	std::string err, values;
+
+	job.json = "{ \"file\": " + json_str(job.path) + ", \"name\": " + json_str(job.name);
+
+	if(!prove_check(func, err)) {
+		job.status = "unsupported";
+		job.json += ", \"status\": \"unsupported\", \"reason\": " + json_str(err) + " }";
+		return;
+	}
+
+	int idx = 0;
+	for(auto &inst : func.front()) {
+		if(!inst.hasName() && !inst.getType()->isVoidTy())
+			inst.setName("v" + std::to_string(idx++));
+	}
+
+	Pass pass(cap);
+	pass.Run(func, spec_args(spec, func));
+
+	double msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	bool sub = false;
+
+	std::vector<const llvm::Value *> list;
+	for(auto const &arg : func.args())
+		list.push_back(&arg);
+	for(auto const &inst : func.front())
+		list.push_back(&inst);
+
+	for(auto val : list) {
+		auto find = pass.map.find(val);
+		if(find == pass.map.end())
+			continue;
+
+		Range range = find->second.Join();
+		bool has = std::holds_alternative<RangeF64>(range.var) && std::get<RangeF64>(range.var).HasSub();
+
+		if(llvm::isa<llvm::Instruction>(val))
+			sub |= has;
+
+		values += std::string(values.empty() ? "" : ", ") + "{ \"name\": " + json_str(llvm_name(val)) + ", \"range\": " + json_str(range.IsNone() ? "∅" : range.Str()) + ", \"subnormal\": " + (has ? "true" : "false") + " }";
+	}
+
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%.3f", msec);
+
+	job.status = sub ? "subnormal" : "free";
+	job.json += ", \"status\": \"" + job.status + "\", \"time_ms\": " + buf + ", \"values\": [ " + values + " ] }";
+
+	if(dump)
+		job.dump = pass.Str(func);
+}
+
+/**
+ * Mark a job as failed, filling in its report.
+ *   @job: The job.
+ *   @err: The reason.
+ */
+static void prove_error(prove_job &job, std::string const &err)
+{
+	job.status = "error";
+	job.json = "{ \"file\": " + json_str(job.path) + (job.name.empty() ? "" : (", \"name\": " + json_str(job.name))) + ", \"status\": \"error\", \"reason\": " + json_str(err) + " }";
+}
+
+/**
+ * Quote a string for JSON.
+ *   @str: The string.
+ *   &returns: The quoted string.
+ */
+static std::string json_str(std::string const &str)
+{
+	std::string res = "\"";
+
+	for(unsigned char ch : str) {
+		if((ch == '"') || (ch == '\\'))
+			res += std::string("\\") + (char)ch;
+		else if(ch < 0x20) {
+			char buf[8];
+
+			snprintf(buf, sizeof(buf), "\\u%04x", ch);
+			res += buf;
+		}
+		else
+			res += ch;
+	}
+
+	return res + "\"";
+}
+
+
 /**
  * Retrieve the string name.
  *   @value: The value.
@@ -115,13 +542,51 @@ void dbg_fatal(const char *file, unsigned long line, const char *fmt, ...)
  */
 void Pass::Run(const llvm::Function &func, std::vector<Range> const &args) {
 	int i = 0;
-	for(auto const &arg : func.args())
-		map[&arg] = Fact(Op::ConstF64, std::vector<Fact *>{}, args[i++]);
+	for(auto const &arg : func.args()) {
+		Op op = std::holds_alternative<RangeI64>(args[i].var) ? Op::ConstI64 : Op::ConstF64;
 
-	for(auto const &inst : func.front()) {
+		map[&arg] = Fact(op, std::vector<Fact *>{}, bdd, args[i++]);
+	}
+
+	for(auto const &inst : func.front())
 		Inst(inst);
-		printf("----------------\n");
-		Dump(func);
+
+	Revise(func);
+}
+
+/**
+ * Narrow the facts of a function to a fixpoint, alternating a forward
+ * sweep in program order with a backward sweep in reverse (HC4-revise).
+ * Facts only ever narrow, so the number of sweeps is bounded as well.
+ *   @func: The function.
+ */
+void Pass::Revise(const llvm::Function &func) {
+	for(unsigned int i = 0; i < 32; i++) {
+		std::vector<const BddNode *> prev;
+
+		for(auto const &entry : map)
+			prev.push_back(entry.second.root);
+
+		for(auto const &inst : func.front()) {
+			auto find = map.find(&inst);
+			if(find != map.end())
+				find->second.Eval();
+		}
+
+		for(auto inst = func.front().rbegin(); inst != func.front().rend(); inst++) {
+			auto find = map.find(&*inst);
+			if(find != map.end())
+				find->second.InvProp();
+		}
+
+		unsigned int n = 0;
+		bool changed = false;
+
+		for(auto const &entry : map)
+			changed |= (entry.second.root != prev[n++]);
+
+		if(!changed)
+			break;
 	}
 }
 
@@ -194,21 +659,35 @@ void Pass::Inst(const llvm::Instruction &inst) {
  *   @func: The function.
  */
 void Pass::Dump(const llvm::Function &func) const {
+	printf("%s", Str(func).c_str());
+}
+
+/**
+ * Retrieve the string of a function with its facts.
+ *   @func: The function.
+ *   &returns: The string.
+ */
+std::string Pass::Str(const llvm::Function &func) const {
+	std::string str;
+	llvm::raw_string_ostream os(str);
+
 	for(auto const &arg : func.args()) {
-		arg.print(llvm::outs(), false);
-		printf("\n");
+		arg.print(os, false);
+		os << "\n";
 
 		if(map.find(&arg) != map.end())
-			map.find(&arg)->second.Dump();
+			os << map.find(&arg)->second.Str();
 	}
 
 	for(auto const &inst : func.front()) {
-		inst.print(llvm::outs(), false);
-		printf("\n");
+		inst.print(os, false);
+		os << "\n";
 
 		if(map.find(&inst) != map.end())
-			map.find(&inst)->second.Dump();
+			os << map.find(&inst)->second.Str();
 	}
+
+	return os.str();
 }
 
 
@@ -229,7 +708,7 @@ Fact& Pass::Get(llvm::Value *value) {
 			fatal("stub"); // float val = 
 		}
 		else if(value->getType()->isDoubleTy())
-			map[value] = Fact(Op::ConstF64, std::vector<Fact *>{}, RangeF64::Const(fp->getValueAPF().convertToDouble()));
+			map[value] = Fact(Op::ConstF64, std::vector<Fact *>{}, bdd, RangeF64::Const(fp->getValueAPF().convertToDouble()));
 		else
 			fatal("Unknown type.");
 
@@ -241,7 +720,7 @@ Fact& Pass::Get(llvm::Value *value) {
 		if(value->getType()->isIntegerTy(32))
 			fatal("stub"); // float val = 
 		else if(value->getType()->isIntegerTy(64))
-			map[value] = Fact(Op::ConstI64, std::vector<Fact *>{}, RangeI64::Const(ival->getZExtValue()));
+			map[value] = Fact(Op::ConstI64, std::vector<Fact *>{}, bdd, RangeI64::Const(ival->getZExtValue()));
 		else
 			fatal("Unknown type.");
 
@@ -326,6 +805,10 @@ std::pair<Op, std::vector<Fact *>> Pass::Info(const llvm::Instruction &inst) {
 		}
 		break;
 
+	case llvm::Instruction::Ret:
+		op = Op::None;
+		break;
+
 	case llvm::Instruction::Select:
 		if(inst.getType()->isIntegerTy(32))
 			op = Op::SelectI32;
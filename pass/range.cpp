@@ -248,6 +248,7 @@ RangeF64 RangeF64::AbsInv(RangeF64 const &in) {
  */
 RangeF64 RangeF64::Add(RangeF64 const &lhs, RangeF64 const &rhs) {
 	RangeF64 res(lhs.nan || rhs.nan);
+	FpRound round;
 
 	for(auto const &x : lhs.ivals) {
 		for(auto const &y : rhs.ivals)
@@ -265,6 +266,7 @@ RangeF64 RangeF64::Add(RangeF64 const &lhs, RangeF64 const &rhs) {
  */
 RangeF64 RangeF64::Sub(RangeF64 const &lhs, RangeF64 const &rhs) {
 	RangeF64 res(lhs.nan || rhs.nan);
+	FpRound round;
 
 	for(auto const &x : lhs.ivals) {
 		for(auto const &y : rhs.ivals)
@@ -282,6 +284,7 @@ RangeF64 RangeF64::Sub(RangeF64 const &lhs, RangeF64 const &rhs) {
  */
 RangeF64 RangeF64::Mul(RangeF64 const &lhs, RangeF64 const &rhs) {
 	RangeF64 res(lhs.nan || rhs.nan);
+	FpRound round;
 
 	for(auto const &x : lhs.Split().ivals) {
 		for(auto const &y : rhs.Split().ivals) {
@@ -361,6 +364,188 @@ RangeF64 RangeF64::FromI64(RangeI64 const &in)
 }
 
 
+/**
+ * Check if the range only has finite values.
+ *   &returns: True if finite.
+ */
+bool RangeF64::IsFinite() const {
+	if(nan)
+		return false;
+
+	for(auto const &ival : ivals) {
+		if(std::isinf(ival.lo) || std::isinf(ival.hi))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Check if the range has a subnormal value.
+ *   &returns: True if possibly subnormal.
+ */
+bool RangeF64::HasSub() const {
+	static const IvalF64 pos(F64MIN, Fact::Prev64(DBL_MIN)), neg(-Fact::Prev64(DBL_MIN), -F64MIN);
+
+	for(auto const &ival : ivals) {
+		if(IvalF64::Overlap(ival, pos) || IvalF64::Overlap(ival, neg))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Compute an intersection.
+ *   @lhs: The left-hand range.
+ *   @rhs: The right-hand range.
+ *   &returns: The result range.
+ */
+RangeF64 RangeF64::Inter(RangeF64 const &lhs, RangeF64 const &rhs) {
+	RangeF64 res(lhs.nan && rhs.nan);
+
+	for(auto const &x : lhs.ivals) {
+		for(auto const &y : rhs.ivals) {
+			IvalF64 ival(f64max(x.lo, y.lo), f64min(x.hi, y.hi));
+
+			if(f64lte(ival.lo, ival.hi))
+				res.ivals.push_back(ival);
+		}
+	}
+
+	res.Simplify();
+
+	return res;
+}
+
+/**
+ * Compute the exact values that round into a range, widening every bound
+ * by one unit in the last place.
+ *   @in: The input range.
+ *   &returns: The output range.
+ */
+RangeF64 RangeF64::Unround(RangeF64 const &in) {
+	RangeF64 res(in.nan);
+
+	for(auto const &ival : in.ivals)
+		res.ivals.push_back(IvalF64(Fact::Prev64(ival.lo), Fact::Next64(ival.hi)));
+
+	return res;
+}
+
+/**
+ * Compute the inverse of an addition, bounding an operand from the result
+ * and the other operand. A NaN operand makes the result NaN, so a result
+ * without NaN rules it out; the bounds are only narrowed when all values
+ * are finite.
+ *   @res: The result range.
+ *   @rhs: The other operand range.
+ *   &returns: The operand range.
+ */
+RangeF64 RangeF64::AddInv(RangeF64 const &res, RangeF64 const &rhs) {
+	if(res.nan)
+		return RangeF64::All();
+	else if(!res.IsFinite() || !rhs.IsFinite())
+		return RangeF64(false, IvalF64::All());
+
+	RangeF64 out = RangeF64::Sub(RangeF64::Unround(res), rhs);
+
+	for(auto &ival : out.ivals)
+		ival = ival.Unsigned();
+
+	return out;
+}
+
+/**
+ * Compute the inverse of a subtraction for the left-hand operand.
+ *   @res: The result range.
+ *   @rhs: The right-hand range.
+ *   &returns: The left-hand range.
+ */
+RangeF64 RangeF64::SubInvL(RangeF64 const &res, RangeF64 const &rhs) {
+	if(res.nan)
+		return RangeF64::All();
+	else if(!res.IsFinite() || !rhs.IsFinite())
+		return RangeF64(false, IvalF64::All());
+
+	RangeF64 out = RangeF64::Add(RangeF64::Unround(res), rhs);
+
+	for(auto &ival : out.ivals)
+		ival = ival.Unsigned();
+
+	return out;
+}
+
+/**
+ * Compute the inverse of a subtraction for the right-hand operand.
+ *   @res: The result range.
+ *   @lhs: The left-hand range.
+ *   &returns: The right-hand range.
+ */
+RangeF64 RangeF64::SubInvR(RangeF64 const &res, RangeF64 const &lhs) {
+	if(res.nan)
+		return RangeF64::All();
+	else if(!res.IsFinite() || !lhs.IsFinite())
+		return RangeF64(false, IvalF64::All());
+
+	RangeF64 out = RangeF64::Sub(lhs, RangeF64::Unround(res));
+
+	for(auto &ival : out.ivals)
+		ival = ival.Unsigned();
+
+	return out;
+}
+
+/**
+ * Compute the inverse of a multiply, bounding an operand from the result
+ * and the other operand. The bounds are only narrowed when the other
+ * operand is finite and excludes zero.
+ *   @res: The result range.
+ *   @rhs: The other operand range.
+ *   &returns: The operand range.
+ */
+RangeF64 RangeF64::MulInv(RangeF64 const &res, RangeF64 const &rhs) {
+	if(res.nan)
+		return RangeF64::All();
+	else if(!res.IsFinite() || !rhs.IsFinite())
+		return RangeF64(false, IvalF64::All());
+
+	for(auto const &ival : rhs.ivals) {
+		if((ival.lo == 0.0) || (ival.hi == 0.0) || (signbit(ival.lo) != signbit(ival.hi)))
+			return RangeF64(false, IvalF64::All());
+	}
+
+	RangeF64 out(false);
+	FpRound round;
+
+	for(auto const &x : RangeF64::Unround(res).ivals) {
+		for(auto const &y : rhs.ivals)
+			out.ivals.push_back(IvalF64::Div(x, y).Unsigned());
+	}
+
+	out.Simplify();
+
+	return out;
+}
+
+/**
+ * Compute the inverse of copysign for the sign operand. Without a NaN
+ * result, the sign of the result is the sign of the operand.
+ *   @res: The result range.
+ *   &returns: The sign range.
+ */
+RangeF64 RangeF64::CopySignInv(RangeF64 const &res) {
+	if(res.nan || (res.HasPos() && res.HasNeg()))
+		return RangeF64::All();
+	else if(res.HasPos())
+		return RangeF64(true, IvalF64(0.0, INFINITY));
+	else if(res.HasNeg())
+		return RangeF64(true, IvalF64(-INFINITY, -0.0));
+	else
+		return RangeF64(false);
+}
+
+
 /** RangeI64 class **/
 
 /**
@@ -485,6 +670,47 @@ RangeI64 RangeI64::Xor(RangeI64 const &lhs, RangeI64 const &rhs)
 }
 
 
+/**
+ * Compute an intersection.
+ *   @lhs: The left-hand range.
+ *   @rhs: The right-hand range.
+ *   &returns: The result range.
+ */
+RangeI64 RangeI64::Inter(RangeI64 const &lhs, RangeI64 const &rhs)
+{
+	RangeI64 res;
+
+	for(auto const &x : lhs.ivals) {
+		for(auto const &y : rhs.ivals) {
+			if(IvalI64::Overlap(x, y))
+				res.ivals.push_back(IvalI64::Inter(x, y));
+		}
+	}
+
+	res.Simplify();
+
+	return res;
+}
+
+/**
+ * Compute the inverse of a bitwise AND, bounding an operand from the
+ * result and the other operand. Only an all-ones mask passes the operand
+ * through unchanged.
+ *   @res: The result range.
+ *   @rhs: The other operand range.
+ *   &returns: The operand range.
+ */
+RangeI64 RangeI64::AndInv(RangeI64 const &res, RangeI64 const &rhs)
+{
+	for(auto const &ival : rhs.ivals) {
+		if(!ival.IsOnes())
+			return RangeI64::All();
+	}
+
+	return res;
+}
+
+
 /** Range class **/
 
 /**
@@ -509,6 +735,39 @@ double Range::UpperF64() const {
 		fatal("UpperF64 called on non-F64 range.");
 }
 
+/**
+ * Retrieve the boolean range.
+ *   &returns: The boolean range.
+ */
+RangeBool const &Range::GetBool() const {
+	if(!std::holds_alternative<RangeBool>(var))
+		fatal("GetBool called on non-boolean range.");
+
+	return std::get<RangeBool>(var);
+}
+
+/**
+ * Retrieve the 64-bit float range.
+ *   &returns: The float range.
+ */
+RangeF64 const &Range::GetF64() const {
+	if(!std::holds_alternative<RangeF64>(var))
+		fatal("GetF64 called on non-F64 range.");
+
+	return std::get<RangeF64>(var);
+}
+
+/**
+ * Retrieve the 64-bit integer range.
+ *   &returns: The integer range.
+ */
+RangeI64 const &Range::GetI64() const {
+	if(!std::holds_alternative<RangeI64>(var))
+		fatal("GetI64 called on non-I64 range.");
+
+	return std::get<RangeI64>(var);
+}
+
 /**
  * Compute a range below a 64-bit floating-point bound.
  *   @bound: The bound.
@@ -536,6 +795,157 @@ Range Range::AboveF64(double bound, bool nan) const {
 }
 
 
+/**
+ * Compute the hash of a range, consistent with `Equal`.
+ *   &returns: The hash.
+ */
+size_t Range::Hash() const {
+	uint64_t hash = 0xcbf29ce484222325 ^ var.index();
+	auto mix = [&hash](uint64_t val) { hash = (hash ^ val) * 0x100000001b3; };
+
+	if(std::holds_alternative<RangeBool>(var)) {
+		RangeBool const &get = std::get<RangeBool>(var);
+
+		mix(get.istrue + 2 * get.isfalse);
+	}
+	else if(std::holds_alternative<RangeF64>(var)) {
+		RangeF64 const &get = std::get<RangeF64>(var);
+
+		mix(get.nan);
+		for(auto const &ival : get.ivals) {
+			uint64_t lo, hi;
+
+			memcpy(&lo, &ival.lo, 8);
+			memcpy(&hi, &ival.hi, 8);
+			mix(lo), mix(hi);
+		}
+	}
+	else if(std::holds_alternative<RangeI64>(var)) {
+		for(auto const &ival : std::get<RangeI64>(var).ivals)
+			mix(ival.lo), mix(ival.hi);
+	}
+
+	return hash;
+}
+
+/**
+ * Check if two ranges are identical, interval by interval.
+ *   @lhs: The left-hand range.
+ *   @rhs: The right-hand range.
+ *   &returns: True if equal.
+ */
+bool Range::Equal(Range const &lhs, Range const &rhs) {
+	if(lhs.var.index() != rhs.var.index())
+		return false;
+
+	if(std::holds_alternative<RangeBool>(lhs.var)) {
+		RangeBool const &x = std::get<RangeBool>(lhs.var), &y = std::get<RangeBool>(rhs.var);
+
+		return (x.istrue == y.istrue) && (x.isfalse == y.isfalse);
+	}
+	else if(std::holds_alternative<RangeF64>(lhs.var)) {
+		RangeF64 const &x = std::get<RangeF64>(lhs.var), &y = std::get<RangeF64>(rhs.var);
+
+		if((x.nan != y.nan) || (x.ivals.size() != y.ivals.size()))
+			return false;
+
+		for(size_t i = 0; i < x.ivals.size(); i++) {
+			if(!f64eq(x.ivals[i].lo, y.ivals[i].lo) || !f64eq(x.ivals[i].hi, y.ivals[i].hi))
+				return false;
+		}
+
+		return true;
+	}
+	else if(std::holds_alternative<RangeI64>(lhs.var)) {
+		RangeI64 const &x = std::get<RangeI64>(lhs.var), &y = std::get<RangeI64>(rhs.var);
+
+		if(x.ivals.size() != y.ivals.size())
+			return false;
+
+		for(size_t i = 0; i < x.ivals.size(); i++) {
+			if((x.ivals[i].lo != y.ivals[i].lo) || (x.ivals[i].hi != y.ivals[i].hi))
+				return false;
+		}
+
+		return true;
+	}
+	else
+		return true;
+}
+
+/**
+ * Compute the union of two ranges. The empty range is the identity.
+ *   @lhs: The left-hand range.
+ *   @rhs: The right-hand range.
+ *   &returns: The union range.
+ */
+Range Range::Union(Range const &lhs, Range const &rhs) {
+	if(lhs.IsNone())
+		return rhs;
+	else if(rhs.IsNone())
+		return lhs;
+	else if(lhs.var.index() != rhs.var.index())
+		fatal("Union of mismatched ranges.");
+
+	if(std::holds_alternative<RangeBool>(lhs.var)) {
+		RangeBool const &x = std::get<RangeBool>(lhs.var), &y = std::get<RangeBool>(rhs.var);
+
+		return RangeBool(x.istrue || y.istrue, x.isfalse || y.isfalse);
+	}
+	else if(std::holds_alternative<RangeF64>(lhs.var)) {
+		RangeF64 res = std::get<RangeF64>(lhs.var);
+		RangeF64 const &y = std::get<RangeF64>(rhs.var);
+
+		res.nan |= y.nan;
+		res.ivals.insert(res.ivals.end(), y.ivals.begin(), y.ivals.end());
+		res.Simplify();
+
+		return res;
+	}
+	else {
+		RangeI64 res = std::get<RangeI64>(lhs.var);
+		RangeI64 const &y = std::get<RangeI64>(rhs.var);
+
+		res.ivals.insert(res.ivals.end(), y.ivals.begin(), y.ivals.end());
+		res.Simplify();
+
+		return res;
+	}
+}
+
+
+/**
+ * Compute the intersection of two ranges. An empty intersection is the
+ * empty range, marking the path infeasible.
+ *   @lhs: The left-hand range.
+ *   @rhs: The right-hand range.
+ *   &returns: The intersection range.
+ */
+Range Range::Inter(Range const &lhs, Range const &rhs) {
+	if(lhs.IsNone() || rhs.IsNone())
+		return Range();
+	else if(lhs.var.index() != rhs.var.index())
+		fatal("Intersection of mismatched ranges.");
+
+	if(std::holds_alternative<RangeBool>(lhs.var)) {
+		RangeBool const &x = std::get<RangeBool>(lhs.var), &y = std::get<RangeBool>(rhs.var);
+		RangeBool res(x.istrue && y.istrue, x.isfalse && y.isfalse);
+
+		return (res.istrue || res.isfalse) ? Range(res) : Range();
+	}
+	else if(std::holds_alternative<RangeF64>(lhs.var)) {
+		RangeF64 res = RangeF64::Inter(std::get<RangeF64>(lhs.var), std::get<RangeF64>(rhs.var));
+
+		return res.IsEmpty() ? Range() : Range(res);
+	}
+	else {
+		RangeI64 res = RangeI64::Inter(std::get<RangeI64>(lhs.var), std::get<RangeI64>(rhs.var));
+
+		return res.ivals.empty() ? Range() : Range(res);
+	}
+}
+
+
 /**
  * Retrieve the string from the range.
  *   &returns: The string.
@@ -51,6 +51,9 @@ public:
 
 	bool HasPos() const;
 	bool HasNeg() const;
+	bool IsEmpty() const { return !nan && ivals.empty(); }
+	bool IsFinite() const;
+	bool HasSub() const;
 	double Lower() const;
 	double Upper() const;
 	RangeF64 Below(double bound, bool nan) const;
@@ -73,6 +76,14 @@ public:
 	static RangeF64 Mul(RangeF64 const &lhs, RangeF64 const &rhs);
 	static RangeF64 FromI64(RangeI64 const &in);
 	static RangeF64 CopySign(RangeF64 const &mag, RangeF64 const &sign);
+
+	static RangeF64 Inter(RangeF64 const &lhs, RangeF64 const &rhs);
+	static RangeF64 Unround(RangeF64 const &in);
+	static RangeF64 AddInv(RangeF64 const &res, RangeF64 const &rhs);
+	static RangeF64 SubInvL(RangeF64 const &res, RangeF64 const &rhs);
+	static RangeF64 SubInvR(RangeF64 const &res, RangeF64 const &lhs);
+	static RangeF64 MulInv(RangeF64 const &res, RangeF64 const &rhs);
+	static RangeF64 CopySignInv(RangeF64 const &res);
 };
 
 /*
@@ -97,6 +108,9 @@ public:
 
 	static RangeI64 And(RangeI64 const &lhs, RangeI64 const &rhs);
 	static RangeI64 Xor(RangeI64 const &lhs, RangeI64 const &rhs);
+
+	static RangeI64 Inter(RangeI64 const &lhs, RangeI64 const &rhs);
+	static RangeI64 AndInv(RangeI64 const &res, RangeI64 const &rhs);
 };
 
 /*
@@ -118,7 +132,17 @@ public:
 	Range BelowF64(double bound, bool nan) const;
 	Range AboveF64(double bound, bool nan) const;
 
+	bool IsNone() const { return std::holds_alternative<RangeNone>(var); }
+	RangeBool const &GetBool() const;
+	RangeF64 const &GetF64() const;
+	RangeI64 const &GetI64() const;
+	size_t Hash() const;
+
 	std::string Str() const;
+
+	static bool Equal(Range const &lhs, Range const &rhs);
+	static Range Union(Range const &lhs, Range const &rhs);
+	static Range Inter(Range const &lhs, Range const &rhs);
 };
 
 #endif
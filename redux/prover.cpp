@@ -2,116 +2,140 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/stat.h>
 
+#include <atomic>
 #include <map>
+#include <string>
+#include <thread>
 #include <vector>
 
 #include <z3.h>
 
 
 /*
- * local declarations
+ * prover job structure
+ *   A job proves one lane of a function. Vector functions get one job per
+ *   lane, unless they are uniform, in which case lane 0 stands for all.
+ *   @func: The function.
+ *   @name: The function name.
+ *   @pre: The precondition, an SMT-LIB term over the arguments.
+ *   @post: The postcondition, an SMT-LIB term over the arguments and `ret`.
+ *   @key: The cache key.
+ *   @res: The result, `verified`, `sat` with a model, or `error`.
+ *   @cached: Whether the result came from the cache.
+ *   @lane: The lane.
+ *   @lanes: The number of lanes of the function.
+ *   @uniform: Whether the lane is proven for all lanes.
  */
-static llvm::LLVMContext llvm_ctx;
-static Z3_context z3;
-static Z3_solver solver;
-
-static std::unique_ptr<llvm::Module> llvm_load(const char *fmt, ...);
-
-#define getstr(v) (llvm_str(v).c_str())
-
-static void fatal(const char *str, ...);
-
+struct prover_job {
+	llvm::Function *func;
+	std::string name, pre, post, key, res;
+	bool cached;
+	unsigned int lane, lanes;
+	bool uniform;
+};
 
-std::string llvm_str(llvm::Value *value)
-{
-	if(llvm::isa<llvm::ConstantInt>(value)) {
-		llvm::ConstantInt *ival = llvm::cast<llvm::ConstantInt>(value);
-		uint32_t bits = ival->getZExtValue();
+/*
+ * z3 worker structure
+ *   Every worker thread owns a context. The sorts, the rounding mode and
+ *   the solver are built once, and each function is solved between a push
+ *   and a pop on that solver.
+ */
+struct z3_worker {
+	Z3_context ctx;
+	Z3_solver solver;
+	Z3_sort f32, f64, i32, i64;
+	Z3_ast rne;
+};
 
-		char buf[32];
-		sprintf(buf, "#x%08x", bits);
+/*
+ * lane map
+ *   The terms of the lanes of the values translated so far.
+ */
+typedef std::map<std::pair<llvm::Value *, unsigned int>, Z3_ast> z3_map;
 
-		return std::string(buf);
-	}
-	else if(llvm::isa<llvm::ConstantFP>(value)) {
-		llvm::ConstantFP *fp = llvm::cast<llvm::ConstantFP>(value);
+/*
+ * element map
+ *   The lanes of the vector constants of the module, and the lanes of the
+ *   shuffle masks. Retrieving an element may create and unique a constant in
+ *   the LLVM context, so they are all retrieved before the workers start.
+ */
+typedef std::map<std::pair<llvm::Constant *, unsigned int>, llvm::Constant *> llvm_elems;
+typedef std::map<std::pair<llvm::Instruction *, unsigned int>, int> llvm_masks;
 
-		float val = fp->getValueAPF().convertToFloat();
-		uint32_t bits;
-		memcpy(&bits, &val, 4);
 
-		char buf[32];
-		sprintf(buf, "#x%08x", bits);
+/*
+ * local declarations
+ */
+static llvm::LLVMContext llvm_ctx;
+static llvm_elems llvm_elem;
+static llvm_masks llvm_mask;
 
-		return std::string(buf);
-	}
-	else
-		return value->getName().str();
-}
+static std::unique_ptr<llvm::Module> llvm_load(const char *fmt, ...);
+static std::string llvm_str(llvm::Value *value);
+static unsigned int llvm_lanes(llvm::Type *type);
+static bool llvm_uniform(llvm::Function &func);
+static void llvm_elements(llvm::Function &func);
+
+static void z3_init(z3_worker &z3);
+static void z3_done(z3_worker &z3);
+static Z3_sort z3_sort(z3_worker &z3, llvm::Type *type);
+static Z3_ast z3_lane(z3_worker &z3, z3_map &map, llvm::Value *value, unsigned int lane, std::string &err);
+static bool z3_contract(z3_worker &z3, z3_map &map, llvm::Function &func, unsigned int lane, Z3_ast ret, std::string const& str, bool neg, std::string &err);
+static std::string z3_prove(z3_worker &z3, prover_job const& job);
+
+static uint64_t cache_hash(std::string const& str);
+static std::string cache_path(prover_job const& job);
+static bool cache_load(prover_job &job);
+static void cache_save(prover_job const& job);
 
-void z3_eq(Z3_ast a, Z3_ast b)
-{
-	Z3_solver_assert(z3, solver, Z3_mk_fpa_eq(z3, a, Z3_mk_fpa_abs(z3, b)));
-}
+static void fatal(const char *str, ...);
 
-const char *prelude =
-	"(set-logic QF_FPBV)\n"
-	"\n"
-	"(define-sort Int32 () (_ BitVec 32))\n"
-	"(define-sort Int64 () (_ BitVec 64))\n"
-	"\n"
-	"(define-fun to_fp_32 ((a Int32)) Float32\n"
-	"	((_ to_fp 8 24) a)\n"
-	")\n"
-	"\n"
-	"(define-fun fp_copysign_f32 ((a Float32) (b Float32)) Float32\n"
-  	"	(to_fp_32 (bvor\n"
-	"		(bvand (to_ieee_bv a) #x7fffffff)\n"
-	"		(bvand (to_ieee_bv b) #x80000000))\n"
-	"	)\n"
-	")\n"
-	"\n"
-	;
-
-
-void gofile(const char *path)
-{
-	FILE *pipe;
-	char buf[256];
 
-	std::string cmd = std::string("z3 ") + path;
-	pipe = popen(cmd.c_str(), "r");
+/**
+ * Version of the query encoding, part of every cache key. Bump it when the
+ * translation of instructions or contracts changes.
+ */
+static const char *prover_version = "prover-2";
 
-	fgets(buf, sizeof(buf), pipe);
-	if(strcmp(buf, "sat\n") == 0) {
-		printf("sat\n");
-		while(fgets(buf, sizeof(buf), pipe))
-			fputs(buf, stdout);
-	}
-	else if(strcmp(buf, "unsat\n") == 0) {
-		printf("verified\n");
-	}
-	else {
-		printf("error\n");
-		while(fgets(buf, sizeof(buf), pipe))
-			fputs(buf, stdout);
-	}
+/**
+ * Directory of the result cache, overridden by `CTFP_PROVER_CACHE`.
+ */
+static std::string prover_cache = ".prover-cache";
 
-	fclose(pipe);
-}
 
 /**
- * Main entry point.
+ * Main entry point. Verifies every function of a module, `foo.ll` by
+ * default, on a pool of `-j` workers (all cores by default). The lanes of
+ * a vector function are independent obligations, solved in parallel.
+ * Results are printed in module order.
+ *   @argc: The number of arguments.
+ *   @argv: The argument array.
+ *   &returns: The code.
  */
-int main()
+int main(int argc, char **argv)
 {
+	unsigned int nthreads = std::max(1u, std::thread::hardware_concurrency());
+	int opt;
+
 	setbuf(stdout, NULL);
 	setbuf(stderr, NULL);
 
-	std::unique_ptr<llvm::Module> mod = llvm_load("foo.ll");
+	while((opt = getopt(argc, argv, "j:")) != -1) {
+		switch(opt) {
+		case 'j': nthreads = std::max(1, atoi(optarg)); break;
+		default:
+			fprintf(stderr, "usage: %s [-j threads] [module.ll]\n", argv[0]);
+			return 1;
+		}
+	}
 
+	if(getenv("CTFP_PROVER_CACHE") != NULL)
+		prover_cache = getenv("CTFP_PROVER_CACHE");
 
+	std::unique_ptr<llvm::Module> mod = llvm_load("%s", (optind < argc) ? argv[optind] : "foo.ll");
+	std::vector<prover_job> jobs;
 
 	for(auto func = mod->begin(); func != mod->end(); func++) {
 		/* there is no function body, skip */
@@ -125,256 +149,695 @@ int main()
 
 		llvm::MDNode *node = func->getMetadata(fn);
 		if(node == nullptr)
-			fatal("Function '%s' missing metadata.");
+			fatal("Function '%s' missing metadata.", fn.c_str());
 
 		if(node->getNumOperands() != 2)
-			fatal("Function '%s' must have a pre- and post- condition.");
+			fatal("Function '%s' must have a pre- and post- condition.", fn.c_str());
+
+		prover_job job;
+		job.func = &*func;
+		job.name = fn;
+		job.cached = false;
+		job.lanes = llvm_lanes(func->getReturnType());
+
+		for(unsigned int i = 0; i < 2; i++) {
+			llvm::MDString *str = llvm::dyn_cast<llvm::MDString>(node->getOperand(i).get());
+			if(str == nullptr)
+				fatal("Function '%s' has a non-string condition.", fn.c_str());
+
+			(i == 0 ? job.pre : job.post) = str->getString().str();
+		}
+
+		/* all vectors of the signature must agree on the lane count */
+		for(auto arg = func->arg_begin(); arg != func->arg_end(); arg++) {
+			unsigned int lanes = llvm_lanes(arg->getType());
 
-		printf("%p : %d\n", node, node->getNumOperands());
-		for(auto op = node->op_begin(); op != node->op_end(); op++) {
-			llvm::MDString *str = llvm::dyn_cast<llvm::MDString>(op->get());
-			if(0)printf(":: %s\n", str->getString().str().c_str());
+			if((lanes > 1) && (job.lanes > 1) && (lanes != job.lanes))
+				fatal("Function '%s' mixes vector widths.", fn.c_str());
+			else if(lanes > 1)
+				job.lanes = lanes;
 		}
-		//func->getMetadata();
-		//llvm::dyn_cast<llvm::ValueAsMetadata>(&*func);
-		printf("fn: %s\n", fn.c_str());
-	
-		/* write to the target smt2 file */
-		std::string path = fn + std::string(".smt2");
-		FILE *file = fopen(path.c_str(), "w");
-		assert(file != nullptr);
-
-		fprintf(file, "%s\n", prelude);
-
-		/* write arguments as constants */
-		auto block = func->begin();
-		for(auto arg = func->arg_begin(); arg != func->arg_end(); arg++)
-			fprintf(file, "(declare-const %s Float32)\n", arg->getName().str().c_str());
-
-		/* give names to all instructions */
+
+		job.uniform = (job.lanes == 1) || llvm_uniform(*func);
+		llvm_elements(*func);
+
+		/* give names to all arguments and instructions, so that the key is stable */
 		int idx = 1;
-		for(auto inst = block->begin(); inst != block->end(); inst++) {
-			if(!inst->hasName())
+		for(auto arg = func->arg_begin(); arg != func->arg_end(); arg++) {
+			if(!arg->hasName())
+				arg->setName("a" + std::to_string(idx++));
+		}
+
+		for(auto inst = func->begin()->begin(); inst != func->begin()->end(); inst++) {
+			if(!inst->hasName() && !inst->getType()->isVoidTy())
 				inst->setName("r" + std::to_string(idx++));
 		}
 
-		/* each instruction translates to an assert */
-		for(auto inst = block->begin(); inst != block->end(); inst++) {
-			switch(inst->getOpcode()) {
-			/* and instruction */
-			case llvm::Instruction::And:
-				fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-				fprintf(file, "(assert (= %s (bvand %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-				break;
-
-			/* or instruction */
-			case llvm::Instruction::Or:
-				fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-				fprintf(file, "(assert (= %s (bvor %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-				break;
-
-			/* xor instruction */
-			case llvm::Instruction::Xor:
-				fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-				fprintf(file, "(assert (= %s (bvxor %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-				break;
-
-			/* add instruction */
-			case llvm::Instruction::FAdd:
-				fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-				fprintf(file, "(assert (= %s (fp.add RNE %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-				break;
-
-			/* return instruction */
-			case llvm::Instruction::Select:
-				fprintf(file, "(declare-const %s Int32)\n", getstr(&*inst));
-				fprintf(file, "(assert (= %s (ite %s %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)), getstr(inst->getOperand(2)));
-				break;
-
-			/* bitcast instruction */
-			case llvm::Instruction::BitCast:
-				{
-					llvm::BitCastInst *cast = llvm::cast<llvm::BitCastInst>(inst);
-
-					fprintf(file, "(declare-const %s Int32)\n", getstr(&*inst));
-					if(cast->getSrcTy()->isIntegerTy(32) && cast->getDestTy()->isFloatTy())
-						fprintf(file, "(assert (= %s ((_ to_fp 8 24) %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)));
-					else if(cast->getSrcTy()->isFloatTy() && cast->getDestTy()->isIntegerTy(32))
-						fprintf(file, "(assert (= %s (to_ieee_bv %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)));
-					else
-						fatal("Unhandled bitcast.");
-				}
-				//fprintf(file, "(declare-const %s Int32)\n", getstr(&*inst));
-				//fprintf(file, "(assert (= %s (ite %s %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)), getstr(inst->getOperand(2)));
-				break;
-
-			/* return instruction */
-			case llvm::Instruction::Ret:
-				fprintf(file, "(declare-const ret Float32)\n");
-				fprintf(file, "(assert (= ret %s))", inst->getOperand(0)->getName().str().c_str());
-				break;
-
-			/* float comparison */
-			case llvm::Instruction::FCmp:
-				{
-					const char *op;
-					llvm::FCmpInst *cmp = llvm::cast<llvm::FCmpInst>(inst);
-
-					switch(cmp->getPredicate()) {
-					case llvm::CmpInst::FCMP_OLT: op = "fp.lt"; break;
-					default: fatal("Unhandled conditional.\n");
-					}
-
-					fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-					fprintf(file, "(assert (= %s (%s %s %s)))\n", getstr(&*inst), op, getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-				}
-
-				break;
-
-			/* call instruction, depends on what we are calling */
-			case llvm::Instruction::Call:
-				{
-					llvm::CallInst *call = llvm::cast<llvm::CallInst>(inst);
-					std::string id = call->getCalledFunction()->getName().str();
-
-					/* absolute value */
-					if(id == "llvm.fabs.f32") {
-						fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-						fprintf(file, "(assert (= %s (fp.abs %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)));
-					}
-					/* copysign value */
-					else if(id == "llvm.copysign.f32") {
-						fprintf(file, "(declare-const %s Float32)\n", getstr(&*inst));
-						fprintf(file, "(assert (= %s (fp_copysign_f32 %s %s)))\n", getstr(&*inst), getstr(inst->getOperand(0)), getstr(inst->getOperand(1)));
-					}
-					else
-						fatal("Unhandled call '%s'.", id.c_str());
-
-					break;
-				}
-
-			default:
-				fatal("Unhandled instruction '%s'.", inst->getOpcodeName());
+		std::string ir;
+		llvm::raw_string_ostream os(ir);
+		func->print(os);
+		os.flush();
+
+		uint64_t hash = cache_hash(std::string(prover_version) + '\0' + ir + '\0' + job.pre + '\0' + job.post);
+
+		for(unsigned int lane = 0; lane < (job.uniform ? 1 : job.lanes); lane++) {
+			char key[48];
+			snprintf(key, sizeof(key), "%016lx.%u", hash, lane);
+
+			job.key = key;
+			job.lane = lane;
+			jobs.push_back(job);
+		}
+	}
+
+	/* the module and the context are only read from here on, so workers may share them */
+	std::atomic<size_t> next(0);
+	std::vector<std::thread> pool;
+
+	for(unsigned int i = 0; i < std::min<size_t>(nthreads, jobs.size()); i++) {
+		pool.push_back(std::thread([&jobs, &next]() {
+			z3_worker z3;
+			bool init = false;
+
+			for(size_t n = next++; n < jobs.size(); n = next++) {
+				if(cache_load(jobs[n]))
+					continue;
+
+				if(!init)
+					z3_init(z3), init = true;
+
+				jobs[n].res = z3_prove(z3, jobs[n]);
+				cache_save(jobs[n]);
 			}
+
+			if(init)
+				z3_done(z3);
+		}));
+	}
+
+	for(auto &thread : pool)
+		thread.join();
+
+	int code = 0;
+
+	for(size_t i = 0, n; i < jobs.size(); i += n) {
+		prover_job const& job = jobs[i];
+		bool cached = true;
+
+		/* a function is verified only if all of its lanes are */
+		const prover_job *fail = nullptr;
+
+		for(n = 0; (i + n < jobs.size()) && (jobs[i + n].func == job.func); n++) {
+			cached &= jobs[i + n].cached;
+
+			if((fail == nullptr) && (jobs[i + n].res != "verified"))
+				fail = &jobs[i + n];
 		}
 
-		fprintf(file, "(check-sat)\n(get-model)\n");
-		fclose(file);
+		std::string lanes;
+		if(job.lanes > 1)
+			lanes = " <" + std::to_string(job.lanes) + " lanes" + (job.uniform ? ", uniform>" : ">");
+
+		printf("fn: %s%s%s\n", job.name.c_str(), lanes.c_str(), cached ? " (cached)" : "");
 
-		gofile(path.c_str());
+		if(fail == nullptr)
+			printf("verified\n");
+		else if(job.lanes > 1)
+			printf("lane %u: %s\n", fail->lane, fail->res.c_str());
+		else
+			printf("%s\n", fail->res.c_str());
+
+		if(fail != nullptr)
+			code = 1;
 	}
 
-	return 0;
+	return code;
 }
 
-int old()
-{
-	setbuf(stdout, NULL);
-	setbuf(stderr, NULL);
-
-	std::unique_ptr<llvm::Module> mod = llvm_load("foo.ll");
 
+/**
+ * Create the context of a worker.
+ *   @z3: The worker.
+ */
+static void z3_init(z3_worker &z3)
+{
 	Z3_config cfg;
-	Z3_sort sort32, sort64;
 
 	cfg = Z3_mk_config();
-	z3 = Z3_mk_context(cfg);
+	z3.ctx = Z3_mk_context(cfg);
 	Z3_del_config(cfg);
 
-	solver = Z3_mk_solver_for_logic(z3, Z3_mk_string_symbol(z3, "QF_FPBV"));
+	Z3_set_error_handler(z3.ctx, NULL);
 
-	sort32 = Z3_mk_fpa_sort_32(z3);
-	sort64 = Z3_mk_fpa_sort_64(z3);
+	z3.solver = Z3_mk_solver_for_logic(z3.ctx, Z3_mk_string_symbol(z3.ctx, "QF_FPBV"));
+	Z3_solver_inc_ref(z3.ctx, z3.solver);
+
+	z3.f32 = Z3_mk_fpa_sort_32(z3.ctx);
+	z3.f64 = Z3_mk_fpa_sort_64(z3.ctx);
+	z3.i32 = Z3_mk_bv_sort(z3.ctx, 32);
+	z3.i64 = Z3_mk_bv_sort(z3.ctx, 64);
+	z3.rne = Z3_mk_fpa_rne(z3.ctx);
+}
+
+/**
+ * Release the context of a worker.
+ *   @z3: The worker.
+ */
+static void z3_done(z3_worker &z3)
+{
+	Z3_solver_dec_ref(z3.ctx, z3.solver);
+	Z3_del_context(z3.ctx);
+}
 
-	Z3_ast rnd = Z3_mk_fpa_rne(z3);
+/**
+ * Retrieve the number of lanes of an LLVM type.
+ *   @type: The type.
+ *   &returns: The number of lanes, one for scalars.
+ */
+static unsigned int llvm_lanes(llvm::Type *type)
+{
+	return type->isVectorTy() ? type->getVectorNumElements() : 1;
+}
 
-	if(solver|| rnd) {}
-	/*
-	Z3_ast a = Z3_mk_const(z3, Z3_mk_string_symbol(z3, "a"), sort32);
-	Z3_ast b = Z3_mk_const(z3, Z3_mk_string_symbol(z3, "b"), sort32);
-	Z3_ast c = Z3_mk_const(z3, Z3_mk_string_symbol(z3, "c"), sort32);
+/**
+ * Check if the lanes of a function are independent and identical, so that
+ * proving one lane proves all of them. Lanes are mixed by the element and
+ * shuffle instructions, and told apart by non-splat vector constants.
+ *   @func: The function.
+ *   &returns: True if uniform.
+ */
+static bool llvm_uniform(llvm::Function &func)
+{
+	for(auto &block : func) {
+		for(auto &inst : block) {
+			if(llvm::isa<llvm::ExtractElementInst>(inst) || llvm::isa<llvm::InsertElementInst>(inst) || llvm::isa<llvm::ShuffleVectorInst>(inst))
+				return false;
 
-	Z3_solver_assert(z3, solver, Z3_mk_fpa_eq(z3, a, Z3_mk_fpa_numeral_float(z3, 1.0f, sort32)));
-	Z3_solver_assert(z3, solver, Z3_mk_fpa_eq(z3, b, Z3_mk_fpa_numeral_float(z3, 2.0f, sort32)));
-	Z3_solver_assert(z3, solver, Z3_mk_fpa_eq(z3, c, Z3_mk_fpa_numeral_float(z3, 3.0f, sort32)));
-	Z3_solver_assert(z3, solver, Z3_mk_fpa_eq(z3, c, Z3_mk_fpa_add(z3, rnd, a, b)));
-	*/
+			for(unsigned int i = 0; i < inst.getNumOperands(); i++) {
+				llvm::Constant *c = llvm::dyn_cast<llvm::Constant>(inst.getOperand(i));
 
-	//Z3_lbool res = Z3_solver_check(z3, solver);
-	//printf("%d (%d %d %d)\n", res, Z3_L_FALSE, Z3_L_UNDEF, Z3_L_TRUE);
-	//Z3_mk_fpa_numeral_float(z3, 1.0f, sort32);
+				if((c != nullptr) && c->getType()->isVectorTy() && !llvm::isa<llvm::ConstantAggregateZero>(c) && (c->getSplatValue() == nullptr))
+					return false;
+			}
+		}
+	}
 
-	for(auto func = mod->begin(); func != mod->end(); func++) {
-		if(func->size() == 0)
-			continue;
+	return true;
+}
 
-		const char *fn = func->getName().str().c_str();
-		if(func->size() != 1)
-			fatal("Function '%s' has more than one basic block.", fn);
+/**
+ * Retrieve the lanes of the vector constants and shuffle masks used by a
+ * function into the element maps.
+ *   @func: The function.
+ */
+static void llvm_elements(llvm::Function &func)
+{
+	for(auto &block : func) {
+		for(auto &inst : block) {
+			if(llvm::isa<llvm::ShuffleVectorInst>(inst)) {
+				for(unsigned int lane = 0; lane < llvm_lanes(inst.getType()); lane++)
+					llvm_mask[{ &inst, lane }] = llvm::cast<llvm::ShuffleVectorInst>(inst).getMaskValue(lane);
+			}
 
-		std::map<llvm::Value *, Z3_ast> map;
+			for(unsigned int i = 0; i < inst.getNumOperands(); i++) {
+				llvm::Constant *c = llvm::dyn_cast<llvm::Constant>(inst.getOperand(i));
 
-		for(auto arg = func->arg_begin(); arg != func->arg_end(); arg++) {
-			const char *reg = arg->getName().str().c_str();
+				if((c == nullptr) || !c->getType()->isVectorTy())
+					continue;
 
-			map[&*arg] = Z3_mk_const(z3, Z3_mk_string_symbol(z3, reg), sort32);
+				for(unsigned int lane = 0; lane < llvm_lanes(c->getType()); lane++)
+					llvm_elem[{ c, lane }] = c->getAggregateElement(lane);
+			}
 		}
+	}
+}
 
-		printf("[%s]\n", fn);
-		auto block = func->begin();
+/**
+ * Retrieve the sort of the elements of an LLVM type.
+ *   @z3: The worker.
+ *   @type: The type.
+ *   &returns: The sort, null if unsupported.
+ */
+static Z3_sort z3_sort(z3_worker &z3, llvm::Type *type)
+{
+	type = type->getScalarType();
+
+	if(type->isFloatTy())
+		return z3.f32;
+	else if(type->isDoubleTy())
+		return z3.f64;
+	else if(type->isIntegerTy(32))
+		return z3.i32;
+	else if(type->isIntegerTy(64))
+		return z3.i64;
+	else if(type->isIntegerTy(1))
+		return Z3_mk_bool_sort(z3.ctx);
+	else
+		return NULL;
+}
 
-		int idx = 1;
-		for(auto inst = block->begin(); inst != block->end(); inst++) {
-			if(!inst->hasName())
-				inst->setName("r" + std::to_string(idx++));
+/**
+ * Translate a lane of a value into a term. Lanes are translated on demand,
+ * so an obligation only holds the lanes it depends on. Scalars have a
+ * single lane, shared by every lane of the vectors they are used with.
+ *   @z3: The worker.
+ *   @map: The terms of the lanes translated so far.
+ *   @value: The value.
+ *   @lane: The lane.
+ *   @err: Output. The error message on failure.
+ *   &returns: The term, null on failure.
+ */
+static Z3_ast z3_lane(z3_worker &z3, z3_map &map, llvm::Value *value, unsigned int lane, std::string &err)
+{
+	Z3_context ctx = z3.ctx;
+
+	if(!value->getType()->isVectorTy())
+		lane = 0;
+
+	auto find = map.find({ value, lane });
+	if(find != map.end())
+		return find->second;
+
+	Z3_sort sort = z3_sort(z3, value->getType());
+	Z3_ast res = NULL;
+
+	if(sort == NULL) {
+		err = "Unhandled type of '" + llvm_str(value) + "'.";
+		return NULL;
+	}
+
+	if(llvm::isa<llvm::Argument>(value)) {
+		std::string name = value->getName().str();
+
+		if(value->getType()->isVectorTy())
+			name += "." + std::to_string(lane);
+
+		return map[{ value, lane }] = Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, name.c_str()), sort);
+	}
+	else if(llvm::isa<llvm::Constant>(value)) {
+		llvm::Constant *c = llvm::cast<llvm::Constant>(value);
+
+		if(value->getType()->isVectorTy()) {
+			auto elem = llvm_elem.find({ c, lane });
+			c = (elem != llvm_elem.end()) ? elem->second : nullptr;
+		}
+
+		if(c == nullptr) {
+			err = "Unhandled lane " + std::to_string(lane) + " of constant '" + llvm_str(value) + "'.";
+			return NULL;
+		}
+
+		if(llvm::isa<llvm::ConstantInt>(c) && c->getType()->isIntegerTy(1))
+			res = llvm::cast<llvm::ConstantInt>(c)->isZero() ? Z3_mk_false(ctx) : Z3_mk_true(ctx);
+		else if(llvm::isa<llvm::ConstantInt>(c))
+			res = Z3_mk_unsigned_int64(ctx, llvm::cast<llvm::ConstantInt>(c)->getZExtValue(), sort);
+		else if(llvm::isa<llvm::ConstantFP>(c) && c->getType()->isFloatTy())
+			res = Z3_mk_fpa_numeral_float(ctx, llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToFloat(), sort);
+		else if(llvm::isa<llvm::ConstantFP>(c) && c->getType()->isDoubleTy())
+			res = Z3_mk_fpa_numeral_double(ctx, llvm::cast<llvm::ConstantFP>(c)->getValueAPF().convertToDouble(), sort);
+		else {
+			err = "Unhandled constant '" + llvm_str(value) + "'.";
+			return NULL;
+		}
+
+		return map[{ value, lane }] = res;
+	}
+
+	llvm::Instruction *inst = llvm::dyn_cast<llvm::Instruction>(value);
+	if(inst == nullptr) {
+		err = "Unhandled value '" + llvm_str(value) + "'.";
+		return NULL;
+	}
+
+	/* the lane-wise operands, the callee excluded */
+	std::vector<Z3_ast> ops;
+
+	if(!llvm::isa<llvm::ExtractElementInst>(inst) && !llvm::isa<llvm::InsertElementInst>(inst) && !llvm::isa<llvm::ShuffleVectorInst>(inst)) {
+		for(unsigned int i = 0; i < inst->getNumOperands(); i++) {
+			if(llvm::isa<llvm::Function>(inst->getOperand(i)))
+				continue;
+
+			ops.push_back(z3_lane(z3, map, inst->getOperand(i), lane, err));
+			if(ops.back() == NULL)
+				return NULL;
+		}
+	}
+
+	switch(inst->getOpcode()) {
+	/* bitwise instructions */
+	case llvm::Instruction::And: res = Z3_mk_bvand(ctx, ops[0], ops[1]); break;
+	case llvm::Instruction::Or: res = Z3_mk_bvor(ctx, ops[0], ops[1]); break;
+	case llvm::Instruction::Xor: res = Z3_mk_bvxor(ctx, ops[0], ops[1]); break;
+
+	/* arithmetic instructions */
+	case llvm::Instruction::FAdd: res = Z3_mk_fpa_add(ctx, z3.rne, ops[0], ops[1]); break;
+	case llvm::Instruction::FSub: res = Z3_mk_fpa_sub(ctx, z3.rne, ops[0], ops[1]); break;
+	case llvm::Instruction::FMul: res = Z3_mk_fpa_mul(ctx, z3.rne, ops[0], ops[1]); break;
+	case llvm::Instruction::FDiv: res = Z3_mk_fpa_div(ctx, z3.rne, ops[0], ops[1]); break;
+
+	/* select instruction */
+	case llvm::Instruction::Select:
+		res = Z3_mk_ite(ctx, ops[0], ops[1], ops[2]);
+		break;
+
+	/* bitcast instruction, lane by lane */
+	case llvm::Instruction::BitCast:
+		{
+			llvm::BitCastInst *cast = llvm::cast<llvm::BitCastInst>(inst);
+			llvm::Type *src = cast->getSrcTy(), *dst = cast->getDestTy();
+
+			if(llvm_lanes(src) != llvm_lanes(dst)) {
+				err = "Unhandled bitcast across lanes.";
+				return NULL;
+			}
+
+			if(src->isIntOrIntVectorTy() && dst->isFPOrFPVectorTy())
+				res = Z3_mk_fpa_to_fp_bv(ctx, ops[0], sort);
+			else if(src->isFPOrFPVectorTy() && dst->isIntOrIntVectorTy())
+				res = Z3_mk_fpa_to_ieee_bv(ctx, ops[0]);
+			else
+				res = ops[0];
+		}
+		break;
+
+	/* float comparison */
+	case llvm::Instruction::FCmp:
+		switch(llvm::cast<llvm::FCmpInst>(inst)->getPredicate()) {
+		case llvm::CmpInst::FCMP_OLT: res = Z3_mk_fpa_lt(ctx, ops[0], ops[1]); break;
+		case llvm::CmpInst::FCMP_OGT: res = Z3_mk_fpa_gt(ctx, ops[0], ops[1]); break;
+		case llvm::CmpInst::FCMP_OLE: res = Z3_mk_fpa_leq(ctx, ops[0], ops[1]); break;
+		case llvm::CmpInst::FCMP_OGE: res = Z3_mk_fpa_geq(ctx, ops[0], ops[1]); break;
+		case llvm::CmpInst::FCMP_OEQ: res = Z3_mk_fpa_eq(ctx, ops[0], ops[1]); break;
+		default:
+			err = "Unhandled conditional.";
+			return NULL;
+		}
+
+		break;
+
+	/* element instructions, with constant indices */
+	case llvm::Instruction::ExtractElement:
+	case llvm::Instruction::InsertElement:
+		{
+			unsigned int pos = llvm::isa<llvm::ExtractElementInst>(inst) ? 1 : 2;
+			llvm::ConstantInt *idx = llvm::dyn_cast<llvm::ConstantInt>(inst->getOperand(pos));
+
+			if(idx == nullptr) {
+				err = "Unhandled variable element index.";
+				return NULL;
+			}
+
+			if(pos == 1)
+				res = z3_lane(z3, map, inst->getOperand(0), idx->getZExtValue(), err);
+			else if(idx->getZExtValue() == lane)
+				res = z3_lane(z3, map, inst->getOperand(1), 0, err);
+			else
+				res = z3_lane(z3, map, inst->getOperand(0), lane, err);
+
+			if(res == NULL)
+				return NULL;
 		}
+		break;
+
+	/* shuffle instruction, with a constant mask */
+	case llvm::Instruction::ShuffleVector:
+		{
+			auto mask = llvm_mask.find({ inst, lane });
+			int elem = (mask != llvm_mask.end()) ? mask->second : -1;
+			unsigned int width = llvm_lanes(inst->getOperand(0)->getType());
+
+			if(elem < 0) {
+				err = "Unhandled undefined shuffle lane.";
+				return NULL;
+			}
 
-		for(auto inst = block->begin(); inst != block->end(); inst++) {
-			Z3_ast var;
-			const char *reg = inst->getName().str().c_str();
-			if(reg[0] != '\0')
-				map[&*inst] = var = Z3_mk_const(z3, Z3_mk_string_symbol(z3, reg), sort32);
-
-			bool iscall = (inst->getOpcode() == llvm::Instruction::Call);
-			std::vector<Z3_ast> param(inst->getNumOperands());
-			for(int i = 0; i < inst->getNumOperands() - (iscall ? 1 : 0); i++) {
-				param[i] = map[inst->getOperand(i)];
-				assert(param[i] != nullptr);
+			res = z3_lane(z3, map, inst->getOperand(((unsigned int)elem < width) ? 0 : 1), elem % width, err);
+			if(res == NULL)
+				return NULL;
+		}
+		break;
+
+	/* call instruction, depends on what we are calling */
+	case llvm::Instruction::Call:
+		{
+			llvm::Function *callee = llvm::cast<llvm::CallInst>(inst)->getCalledFunction();
+			std::string id = (callee != nullptr) ? callee->getName().str() : "";
+
+			/* absolute value */
+			if(id.compare(0, 10, "llvm.fabs.") == 0)
+				res = Z3_mk_fpa_abs(ctx, ops[0]);
+			/* copysign value */
+			else if(id.compare(0, 14, "llvm.copysign.") == 0) {
+				unsigned int bits = inst->getType()->getScalarSizeInBits();
+				Z3_sort bv = Z3_mk_bv_sort(ctx, bits);
+				uint64_t top = (uint64_t)1 << (bits - 1);
+
+				Z3_ast mag = Z3_mk_bvand(ctx, Z3_mk_fpa_to_ieee_bv(ctx, ops[0]), Z3_mk_unsigned_int64(ctx, top - 1, bv));
+				Z3_ast sign = Z3_mk_bvand(ctx, Z3_mk_fpa_to_ieee_bv(ctx, ops[1]), Z3_mk_unsigned_int64(ctx, top, bv));
+
+				res = Z3_mk_fpa_to_fp_bv(ctx, Z3_mk_bvor(ctx, mag, sign), sort);
 			}
+			else {
+				err = "Unhandled call '" + id + "'.";
+				return NULL;
+			}
+		}
+		break;
+
+	default:
+		err = std::string("Unhandled instruction '") + inst->getOpcodeName() + "'.";
+		return NULL;
+	}
+
+	if(Z3_get_error_code(ctx) != Z3_OK) {
+		err = std::string("Ill-typed instruction '") + inst->getOpcodeName() + "': " + Z3_get_error_msg(ctx, Z3_get_error_code(ctx));
+		return NULL;
+	}
+
+	return map[{ value, lane }] = res;
+}
+
+/**
+ * Assert a contract of a function. The contract is an SMT-LIB boolean term
+ * over the arguments and `ret`, and may use the sorts `Float32`, `Float64`,
+ * `Int32` and `Int64`. For a vector function, the names stand for the
+ * given lane. An empty contract asserts nothing.
+ *   @z3: The worker.
+ *   @map: The terms of the lanes.
+ *   @func: The function.
+ *   @lane: The lane.
+ *   @ret: The returned term, null if none.
+ *   @str: The contract.
+ *   @neg: Assert the negation of the contract.
+ *   @err: Output. The error message on failure.
+ *   &returns: True on success.
+ */
+static bool z3_contract(z3_worker &z3, z3_map &map, llvm::Function &func, unsigned int lane, Z3_ast ret, std::string const& str, bool neg, std::string &err)
+{
+	Z3_context ctx = z3.ctx;
+
+	if(str.empty())
+		return true;
+
+	std::vector<Z3_symbol> names;
+	std::vector<Z3_func_decl> decls;
+
+	for(auto arg = func.arg_begin(); arg != func.arg_end(); arg++) {
+		Z3_ast var = z3_lane(z3, map, &*arg, lane, err);
+		if(var == NULL)
+			return false;
+
+		names.push_back(Z3_mk_string_symbol(ctx, arg->getName().str().c_str()));
+		decls.push_back(Z3_get_app_decl(ctx, Z3_to_app(ctx, var)));
+	}
+
+	if(ret != NULL) {
+		Z3_ast var = Z3_mk_const(ctx, Z3_mk_string_symbol(ctx, "ret"), Z3_get_sort(ctx, ret));
+
+		Z3_solver_assert(ctx, z3.solver, Z3_mk_eq(ctx, var, ret));
+		names.push_back(Z3_mk_string_symbol(ctx, "ret"));
+		decls.push_back(Z3_get_app_decl(ctx, Z3_to_app(ctx, var)));
+	}
+
+	Z3_symbol sort_names[4] = { Z3_mk_string_symbol(ctx, "Float32"), Z3_mk_string_symbol(ctx, "Float64"), Z3_mk_string_symbol(ctx, "Int32"), Z3_mk_string_symbol(ctx, "Int64") };
+	Z3_sort sorts[4] = { z3.f32, z3.f64, z3.i32, z3.i64 };
+
+	std::string cmd = "(assert " + str + ")";
+	Z3_ast_vector vec = Z3_parse_smtlib2_string(ctx, cmd.c_str(), 4, sort_names, sorts, decls.size(), names.data(), decls.data());
+	if(Z3_get_error_code(ctx) != Z3_OK) {
+		err = std::string("Invalid contract '") + str + "': " + Z3_get_error_msg(ctx, Z3_get_error_code(ctx));
+		return false;
+	}
 
-			switch(inst->getOpcode()) {
-			case llvm::Instruction::Call:
-				{
-					llvm::CallInst *call = llvm::cast<llvm::CallInst>(inst);
-					const char *id = call->getCalledFunction()->getName().str().c_str();
-					printf("call: %s\n", id);
-					if(strcmp(id, "llvm.fabs.f32") == 0) {
-						z3_eq(var, Z3_mk_fpa_abs(z3, param[0]));
-					}
-					else
-						fatal("Unhandled called function '%s'.", id);
-				}
-				break;
-
-			case llvm::Instruction::FAdd:
-				z3_eq(var, Z3_mk_fpa_add(z3, rnd, param[0], param[1]));
-				break;
-
-			case llvm::Instruction::Ret:
-				break;
-
-			default:
-				fatal("Unhandled instruction '%s'.", inst->getOpcodeName());
+	Z3_ast_vector_inc_ref(ctx, vec);
+
+	std::vector<Z3_ast> conj;
+	for(unsigned int i = 0; i < Z3_ast_vector_size(ctx, vec); i++)
+		conj.push_back(Z3_ast_vector_get(ctx, vec, i));
+
+	Z3_ast all = conj.empty() ? Z3_mk_true(ctx) : Z3_mk_and(ctx, conj.size(), conj.data());
+	Z3_solver_assert(ctx, z3.solver, neg ? Z3_mk_not(ctx, all) : all);
+	Z3_ast_vector_dec_ref(ctx, vec);
+
+	return true;
+}
+
+/**
+ * Prove a lane of a function. The precondition and the negated
+ * postcondition are asserted on top of the translated lane, so `unsat`
+ * means verified.
+ *   @z3: The worker.
+ *   @job: The job.
+ *   &returns: The result text.
+ */
+static std::string z3_prove(z3_worker &z3, prover_job const& job)
+{
+	Z3_context ctx = z3.ctx;
+	z3_map map;
+	std::string err, res;
+	Z3_ast ret = NULL;
+
+	Z3_solver_push(ctx, z3.solver);
+
+	/* only the returned lane is translated, along with what it depends on */
+	llvm::ReturnInst *inst = llvm::dyn_cast<llvm::ReturnInst>(job.func->begin()->getTerminator());
+	if((inst != nullptr) && (inst->getReturnValue() != nullptr))
+		ret = z3_lane(z3, map, inst->getReturnValue(), job.lane, err);
+
+	if(err.empty() && z3_contract(z3, map, *job.func, job.lane, ret, job.pre, false, err) && z3_contract(z3, map, *job.func, job.lane, ret, job.post, true, err)) {
+		switch(Z3_solver_check(ctx, z3.solver)) {
+		case Z3_L_FALSE:
+			res = "verified";
+			break;
+
+		case Z3_L_TRUE:
+			{
+				Z3_model model = Z3_solver_get_model(ctx, z3.solver);
+
+				Z3_model_inc_ref(ctx, model);
+				res = std::string("sat\n") + Z3_model_to_string(ctx, model);
+				Z3_model_dec_ref(ctx, model);
 			}
+			break;
 
+		default:
+			res = std::string("error\n") + Z3_solver_get_reason_unknown(ctx, z3.solver);
+			break;
 		}
-		//for(auto block = func->
 	}
+	else
+		res = "error\n" + err;
+
+	Z3_solver_pop(ctx, z3.solver, 1);
+
+	return res;
+}
+
+
+/**
+ * Hash a string with 64-bit FNV-1a.
+ *   @str: The string.
+ *   &returns: The hash.
+ */
+static uint64_t cache_hash(std::string const& str)
+{
+	uint64_t hash = 0xcbf29ce484222325;
+
+	for(unsigned char ch : str)
+		hash = (hash ^ ch) * 0x100000001b3;
+
+	return hash;
+}
+
+/**
+ * Retrieve the cache file of a job.
+ *   @job: The job.
+ *   &returns: The path.
+ */
+static std::string cache_path(prover_job const& job)
+{
+	return prover_cache + "/" + job.key;
+}
+
+/**
+ * Load the cached result of a job.
+ *   @job: The job.
+ *   &returns: True if found.
+ */
+static bool cache_load(prover_job &job)
+{
+	FILE *file = fopen(cache_path(job).c_str(), "r");
+	if(file == NULL)
+		return false;
+
+	char buf[4096];
+	size_t len;
+
+	job.res.clear();
+	while((len = fread(buf, 1, sizeof(buf), file)) > 0)
+		job.res.append(buf, len);
 
-	return 0;
+	fclose(file);
+	job.cached = true;
+
+	return true;
+}
+
+/**
+ * Store the result of a job. Errors are not cached, and the file is
+ * written under a temporary name and renamed, so concurrent provers never
+ * read a partial result.
+ *   @job: The job.
+ */
+static void cache_save(prover_job const& job)
+{
+	if(job.res.compare(0, 5, "error") == 0)
+		return;
+
+	mkdir(prover_cache.c_str(), 0755);
+
+	std::string path = cache_path(job), tmp = path + "." + std::to_string(getpid()) + ".tmp";
+	FILE *file = fopen(tmp.c_str(), "w");
+	if(file == NULL)
+		return;
+
+	bool okay = (fwrite(job.res.data(), 1, job.res.size(), file) == job.res.size());
+	okay &= (fclose(file) == 0);
+
+	if(!okay || (rename(tmp.c_str(), path.c_str()) < 0))
+		unlink(tmp.c_str());
 }
 
 
+/**
+ * Convert a value into a string.
+ *   @value: The value.
+ *   &returns: The string.
+ */
+static std::string llvm_str(llvm::Value *value)
+{
+	if(llvm::isa<llvm::ConstantInt>(value)) {
+		llvm::ConstantInt *ival = llvm::cast<llvm::ConstantInt>(value);
+		uint64_t bits = ival->getZExtValue();
+
+		char buf[32];
+		sprintf(buf, (ival->getBitWidth() > 32) ? "#x%016lx" : "#x%08lx", bits);
+
+		return std::string(buf);
+	}
+	else if(llvm::isa<llvm::ConstantFP>(value)) {
+		llvm::ConstantFP *fp = llvm::cast<llvm::ConstantFP>(value);
+		uint64_t bits = fp->getValueAPF().bitcastToAPInt().getZExtValue();
+
+		char buf[32];
+		sprintf(buf, fp->getType()->isDoubleTy() ? "#x%016lx" : "#x%08lx", bits);
+
+		return std::string(buf);
+	}
+	else
+		return value->getName().str();
+}
+
 /**
  * Load a module from a path.
  *   @fmt: The format string.
@@ -2,11 +2,15 @@
 
 #include <float.h>
 #include <cmath>
+#include <map>
 #include <set>
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
 
+#include "../fast/ival/taint.hpp"
+#include "../fast/src/pack.hpp"
+
 
 using namespace llvm;
 
@@ -80,6 +84,154 @@ unsigned int getwidth(Type *type)
 }
 
 
+/*
+ * The CTFP bitcode, loaded lazily into the context of the module being
+ * transformed, and the copies of its globals made so far. Both are
+ * released when the pass is done with the module.
+ */
+static std::unique_ptr<Module> kernsrc;
+static std::map<const GlobalValue *, GlobalValue *> kerncopies;
+
+/**
+ * Retrieve the CTFP bitcode from `$CTFP_DIR/ctfp.bc`. Only the symbol table
+ * is read up front; the body of a function is read when a kernel first
+ * needs it.
+ *   @ctx: The context.
+ *   &returns: The kernel module.
+ */
+Module *getsource(LLVMContext &ctx)
+{
+	if(kernsrc != nullptr)
+		return kernsrc.get();
+
+	SMDiagnostic err;
+	if(getenv("CTFP_DIR") == nullptr)
+		fprintf(stderr, "Missing 'CTFP_DIR' variable.\n"), abort();
+
+	std::string path = std::string(getenv("CTFP_DIR")) + std::string("/ctfp.bc");
+	kernsrc = getLazyIRFileModule(path, err, ctx);
+	if(kernsrc == nullptr)
+		fprintf(stderr, "Failed to load CTFP bitcode (%s).\n", path.c_str()), abort();
+
+	return kernsrc.get();
+}
+
+/**
+ * Collect the global values transitively referenced by a value, reading
+ * the bodies of the functions on the way.
+ *   @value: The value.
+ *   @need: The set of needed global values.
+ */
+void getrefs(Value *value, std::set<GlobalValue *> &need)
+{
+	if(isa<GlobalValue>(value)) {
+		if(!need.insert(cast<GlobalValue>(value)).second)
+			return;
+
+		if(Error err = cast<GlobalValue>(value)->materialize())
+			fprintf(stderr, "Failed to read '%s'. %s\n", value->getName().str().c_str(), toString(std::move(err)).c_str()), abort();
+
+		if(isa<Function>(value)) {
+			for(BasicBlock &block : *cast<Function>(value)) {
+				for(Instruction &inst : block) {
+					for(Value *op : inst.operands())
+						getrefs(op, need);
+				}
+			}
+		}
+		else if(isa<GlobalVariable>(value) && cast<GlobalVariable>(value)->hasInitializer())
+			getrefs(cast<GlobalVariable>(value)->getInitializer(), need);
+	}
+	else if(isa<Constant>(value)) {
+		for(Value *op : cast<Constant>(value)->operands())
+			getrefs(op, need);
+	}
+}
+
+/**
+ * Materialize a CTFP kernel in a module. The kernel and the globals it
+ * references are first declared in the module, reusing the ones copied
+ * before, and the bodies and initializers are then copied over.
+ *   @mod: The module.
+ *   @id: The kernel name.
+ *   &returns: The kernel function or null if it does not exist.
+ */
+Function *getkernel(Module &mod, const char *id)
+{
+	Function *func = mod.getFunction(id);
+	if((func != nullptr) && !func->isDeclaration())
+		return func;
+
+	Module *src = getsource(mod.getContext());
+	Function *kern = src->getFunction(id);
+	if(kern == nullptr)
+		return nullptr;
+
+	std::set<GlobalValue *> need;
+	getrefs(kern, need);
+
+	ValueToValueMapTy vmap;
+	std::vector<GlobalValue *> copy;
+
+	/* in module order, so that the output does not depend on addresses */
+	for(GlobalValue &global : src->global_values()) {
+		if(need.count(&global) == 0)
+			continue;
+
+		auto find = kerncopies.find(&global);
+		if(find != kerncopies.end()) {
+			vmap[&global] = find->second;
+			continue;
+		}
+
+		GlobalValue *dst = global.hasLocalLinkage() ? nullptr : mod.getNamedValue(global.getName());
+
+		if(dst != nullptr) {
+			if(dst->getType() != global.getType())
+				fprintf(stderr, "Mismatched type of '%s'.\n", global.getName().str().c_str()), abort();
+		}
+		else if(isa<Function>(global))
+			dst = Function::Create(cast<Function>(global).getFunctionType(), global.getLinkage(), global.getName(), &mod);
+		else if(isa<GlobalVariable>(global)) {
+			GlobalVariable &var = cast<GlobalVariable>(global);
+
+			dst = new GlobalVariable(mod, var.getValueType(), var.isConstant(), var.getLinkage(), nullptr, var.getName(), nullptr, var.getThreadLocalMode(), var.getType()->getAddressSpace());
+		}
+		else
+			fprintf(stderr, "Unhandled global '%s'.\n", global.getName().str().c_str()), abort();
+
+		if(dst->isDeclaration() && !global.isDeclaration()) {
+			if(isa<Function>(global))
+				cast<Function>(dst)->copyAttributesFrom(&cast<Function>(global));
+			else
+				cast<GlobalVariable>(dst)->copyAttributesFrom(&cast<GlobalVariable>(global));
+
+			copy.push_back(&global);
+		}
+
+		vmap[&global] = kerncopies[&global] = dst;
+	}
+
+	for(GlobalValue *global : copy) {
+		if(isa<Function>(global)) {
+			Function *from = cast<Function>(global), *to = cast<Function>(vmap[global]);
+			SmallVector<ReturnInst *, 4> rets;
+			auto arg = to->arg_begin();
+
+			for(Argument &param : from->args()) {
+				arg->setName(param.getName());
+				vmap[&param] = &*arg++;
+			}
+
+			CloneFunctionInto(to, from, vmap, true, rets);
+		}
+		else
+			cast<GlobalVariable>(vmap[global])->setInitializer(MapValue(cast<GlobalVariable>(global)->getInitializer(), vmap));
+	}
+
+	return cast<Function>(vmap[kern]);
+}
+
 #if 0
 
 class Range {
@@ -520,6 +672,8 @@ struct CTFP : public FunctionPass {
 	CTFP() : FunctionPass(ID) {
 		repl = 0;
 		skip = 0;
+		tainted = (getenv("CTFP_TAINT") != nullptr);
+		taintmod = nullptr;
 	}
 
 	~CTFP() {
@@ -547,15 +701,20 @@ struct CTFP : public FunctionPass {
 	/**
 	 * Member variables.
 	 *   @repl, skip: The number of replacements and skips.
+	 *   @tainted: Only harden operations on secret data (`CTFP_TAINT`).
+	 *   @taint, taintmod: The taint analysis and the module it was run on.
 	 */
 	unsigned int repl, skip;
+	bool tainted;
+	Taint taint;
+	Module *taintmod;
 
 
 	void insert(Instruction *inst, const char *id) {
 		Module *mod = inst->getParent()->getParent()->getParent();
 		LLVMContext &ctx = mod->getContext();
 
-		Function *func = mod->getFunction(id);
+		Function *func = getkernel(*mod, id);
 		if(func == NULL)
 			fprintf(stderr, "Missing CTFP function '%s'.\n", id), abort();
 
@@ -643,6 +802,13 @@ struct CTFP : public FunctionPass {
 		assert(suc == true);
 	}
 
+	virtual bool doFinalization(Module &mod) {
+		kerncopies.clear();
+		kernsrc.reset();
+
+		return false;
+	}
+
 	virtual bool runOnFunction(Function &func) {
 		if(func.getName().str().find("ctfp_add") == 0)
 			return false;
@@ -654,23 +820,24 @@ struct CTFP : public FunctionPass {
 			return false;
 		else if(func.getName().str().find("ctfp_sqrt") == 0)
 			return false;
-		LLVMContext &ctx = func.getContext();
 
 		Module *mod = func.getParent();
-		if(mod->getFunction("ctfp_add1_f1") == nullptr) {
-			SMDiagnostic err;
-			if(getenv("CTFP_DIR") == nullptr)
-				fprintf(stderr, "Missing 'CTFP_DIR' variable.\n"), abort();
-
-			std::string path = std::string(getenv("CTFP_DIR")) + std::string("/ctfp.bc");
-			std::unique_ptr<Module> parse = parseIRFile(path, err, ctx);
-			if(parse == nullptr)
-				fprintf(stderr, "Failed to load CTFP bitcode (%s).\n", path.c_str()), abort();
-
-			if(Linker::linkModules(*mod, std::move(parse)))
-				fprintf(stderr, "Link failed.\n"), abort();
+		if(tainted && (taintmod != mod)) {
+			taint = Taint();
+			taint.Run(*mod);
+			taintmod = mod;
 		}
 
+		std::function<bool(Instruction const&)> secret;
+		if(tainted)
+			secret = [this](Instruction const& inst) { return taint.Secret(inst); };
+
+		for(auto block = func.begin(); block != func.end(); block++)
+			ctfp_pack(*block, secret);
+
+		if(tainted)
+			taint.Func(func);
+
 		for(auto block = func.begin(); block != func.end(); block++) {
 			auto iter = block->begin();
 			while(iter != block->end()) {
@@ -678,6 +845,9 @@ struct CTFP : public FunctionPass {
 				std::string name = "";
 				Instruction *inst = &*iter++;
 
+				if(tainted && !taint.Secret(*inst))
+					continue;
+
 				if(inst->getOpcode() == Instruction::FAdd)
 					name = "add";
 				else if(inst->getOpcode() == Instruction::FSub)
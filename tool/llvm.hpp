@@ -13,5 +13,6 @@
 #include <llvm/Linker/Linker.h>
 #include <llvm/IR/DiagnosticInfo.h>
 #include <llvm/IR/CFG.h>
+#include <llvm/Analysis/ValueTracking.h>
 
 #endif